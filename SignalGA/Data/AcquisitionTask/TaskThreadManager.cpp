@@ -6,8 +6,14 @@
 #include <QByteArray>
 
 #include "../DataSaver/DataSaver.h"
+#include "../DataSaver/CsvFormat.h"
 #include "../../Drivers/ForceSensor/ForceSensor.h"
 
+namespace {
+const int kDrainChunk = 4096; // 单次从环形缓冲区取出的最大样本数
+const int kBinaryColumns = 5; // 二进制记录：ts_us, channel, raw, absoluteForce, relativeForce
+}
+
 TaskThreadManager::TaskThreadManager(QObject* parent)
     : QObject(parent) {
 }
@@ -20,59 +26,124 @@ TaskThreadManager::~TaskThreadManager() {
 void TaskThreadManager::start() {
     if (m_running) return;
 
-    // 创建 ForceSensor 所在线程
-    if (!m_sensorThread) m_sensorThread = new QThread();
+    // 创建 ForceSensor 所在线程（使用反应器时串口由反应器线程服务，不需要）
+    if (!m_sensorThread && !m_reactor) m_sensorThread = new QThread();
     if (!m_forceSensor) {
         m_forceSensor = new ForceSensor(m_portName, m_sensCH1, m_sensCH2);
+        // 样本经无锁环形缓冲区交给存储侧，不再经过 Qt 事件队列
+        m_sampleRing.reset(new TCM::SpscRing<ForceSample>(static_cast<std::size_t>(m_ringCapacity), m_overflowPolicy));
+        m_forceSensor->setSampleRing(m_sampleRing.get());
+    }
+    if (m_sensorThread && m_forceSensor->thread() != m_sensorThread) {
         m_forceSensor->moveToThread(m_sensorThread);
-        // 在线程启动后连接串口
-        connect(m_sensorThread, &QThread::started, this, [this]() {
-            if (m_forceSensor) m_forceSensor->connect();
+        // 在线程启动后连接串口（以传感器为上下文，确保在传感器线程中执行，串口与批量定时器归属该线程）
+        connect(m_sensorThread, &QThread::started, m_forceSensor, [this]() {
+            if (!m_forceSensor) return;
+            if (m_forceSensor->connect() && !m_rawCapturePath.isEmpty()) {
+                m_forceSensor->startRawCapture(m_rawCapturePath);
+            }
         });
         // 线程结束时自动断开
-        connect(m_sensorThread, &QThread::finished, this, [this]() {
+        connect(m_sensorThread, &QThread::finished, m_forceSensor, [this]() {
             if (m_forceSensor) m_forceSensor->disConnect();
         });
-        connect(m_forceSensor, &ForceSensor::forceDataReady,
-                this, &TaskThreadManager::onForceData);
     }
+    // 读取方式与通道配置须在串口打开（传感器线程启动）之前设定
+    if (m_forceSensor && !m_forceSensor->isOpen()) {
+        if (!m_channelIds.isEmpty() && !m_forceSensor->setChannelIds(m_channelIds)) {
+            emit errorOccurred(QStringLiteral("力传感器通道标识无效：%1").arg(QString::fromLatin1(m_channelIds)));
+        }
+        for (int i = 0; i < m_sensitivities.size() && i < m_forceSensor->channelCount(); ++i) {
+            m_forceSensor->setSensitivity(m_sensitivities.at(i), i + 1);
+        }
+        if (m_reactor) {
+            m_forceSensor->setReactor(m_reactor);
+        } else {
+            m_forceSensor->setReadMode(m_lowLatencyRead ? SerialCommon::ReadMode::Direct : SerialCommon::ReadMode::EventLoop);
+        }
+    }
+    if (m_sampleRing) m_sampleRing->reopen();
+
+    // 存储侧定时批量取出样本
+    if (!m_drainTimer) {
+        m_drainTimer = new QTimer(this);
+        m_drainTimer->setInterval(m_drainIntervalMs);
+        connect(m_drainTimer, &QTimer::timeout, this, &TaskThreadManager::drainSampleRing);
+    }
+    if (!m_drainBuffer) m_drainBuffer.reset(new ForceSample[kDrainChunk]);
 
     // 配置并准备 DataSaver
     if (!m_saver) m_saver = new DataSaver(this);
     m_saver->setBaseDir(m_baseDir);
+    m_saveStreams.clear();
     if (m_saveEnabled) {
-        // 力传感字段表头（如果后续也写入 raw，则可另设一个 group）
-        m_saver->ensureCsv(m_kind, m_group, {"ts_us", "channel", "absoluteForce", "relativeForce"});
+        // 力传感字段表头
+        m_saver->setDecimation(m_saveDecimation ? QVector<int>{ 16, 256, 4096 } : QVector<int>(), QStringLiteral("channel"));
+        if (m_binarySave) {
+            // 样本时间戳为传感器单调时钟，文件头记录其零点对应的墙钟时间
+            m_saver->setFormat(DataSaver::Format::Binary);
+            m_saver->setTimestampEpochUs(QDateTime::currentMSecsSinceEpoch() * 1000 - m_forceSensor->currentTimestampUs());
+            // 每个通道一个文件，raw 列记录原始计数并带该通道的灵敏度，可按原始计数重新换算
+            const QByteArray channelIds = m_channelIds.isEmpty() ? QByteArray("bd") : m_channelIds;
+            for (int ch = 1; ch <= m_forceSensor->channelCount(); ++ch) {
+                double sensitivity = 0.0;
+                m_forceSensor->getSensitivity(sensitivity, ch);
+                const QVector<BinaryFormat::Column> columns {
+                    { QStringLiteral("ts_us"), BinaryFormat::ColumnType::Int64, 0.0 },
+                    { QStringLiteral("channel"), BinaryFormat::ColumnType::Int32, 0.0 },
+                    { QStringLiteral("raw"), BinaryFormat::ColumnType::Int32, sensitivity },
+                    { QStringLiteral("absoluteForce"), BinaryFormat::ColumnType::Float64, 0.0 },
+                    { QStringLiteral("relativeForce"), BinaryFormat::ColumnType::Float64, 0.0 }
+                };
+                const QVector<QPair<QString, QString>> metadata {
+                    { QStringLiteral("port"), m_portName },
+                    { QStringLiteral("channelId"), QString::fromLatin1(channelIds.mid(ch - 1, 1)) }
+                };
+                m_saveStreams.append(m_saver->openBinaryStream(m_kind, m_group + QStringLiteral("CH%1").arg(ch), columns, metadata));
+            }
+        } else {
+            m_saver->setFormat(DataSaver::Format::Csv);
+            m_saveStreams.append(m_saver->openStream(m_kind, m_group, {"ts_us", "channel", "absoluteForce", "relativeForce"}));
+        }
         m_saver->setAutoFlush(false);
         m_saver->setBufferLimitBytes(256 * 1024);
-    }
-
-    // 创建并连接 ForceSensor（内部管理）
-    if (!m_forceSensor) {
-        m_forceSensor = new ForceSensor(m_portName, m_sensCH1, m_sensCH2);
-        // 尝试连接，使用缺省 921600/8N1 参数
-        m_forceSensor->connect();
-        connect(m_forceSensor, &ForceSensor::forceDataReady,
-                this, &TaskThreadManager::onForceData);
+        if (m_saver->isAsyncWrite() != m_asyncSave) m_saver->setAsyncWrite(m_asyncSave);
+        m_saver->setDurability(m_saveMaxLossMs);
     }
 
     m_running = true;
-    m_sensorThread->start();
+    m_drainTimer->start();
+    if (m_sensorThread) {
+        m_sensorThread->start();
+    } else if (m_forceSensor->connect() && !m_rawCapturePath.isEmpty()) {
+        // 反应器模式：在本线程打开串口，之后的读取与解析都在反应器线程中进行
+        m_forceSensor->startRawCapture(m_rawCapturePath);
+    }
     emit started();
 }
 
 void TaskThreadManager::stop() {
     if (!m_running) return;
     m_running = false;
-    // 停止传感器线程
+    // Block 策略下生产者可能正等待空位，而取出样本的定时器就在本线程：
+    // 先关闭环形缓冲区使生产者不再等待（满时改为丢弃最旧记录），再停止生产者
+    if (m_sampleRing) m_sampleRing->close();
+    // 停止传感器线程，等待期间继续取出样本，尽量不因关闭而丢弃
     if (m_sensorThread) {
         m_sensorThread->quit();
-        m_sensorThread->wait();
+        while (!m_sensorThread->wait(static_cast<unsigned long>(m_drainIntervalMs))) {
+            drainSampleRing();
+        }
+    } else if (m_forceSensor) {
+        m_forceSensor->disConnect(); // 退出反应器后不再产生样本
     }
+    // 生产者已停止：取完环形缓冲区中剩余的样本
+    if (m_drainTimer) m_drainTimer->stop();
+    drainSampleRing();
 
     // 刷新/关闭保存
     if (m_saver && m_saveEnabled) {
-        m_saver->flush(m_kind, m_group);
+        for (int id : m_saveStreams) m_saver->flush(id);
         // 不立即 closeAll，让 teardown 统一处理
     }
 }
@@ -85,8 +156,11 @@ void TaskThreadManager::teardown() {
 
     if (m_saver) {
         if (m_saveEnabled) {
-            m_saver->flush(m_kind, m_group);
-            m_saver->close(m_kind, m_group);
+            for (int id : m_saveStreams) {
+                m_saver->flush(id);
+                m_saver->close(id);
+            }
+            m_saveStreams.clear();
         }
         // m_saver 自身作为 this 子对象，无需手动 delete
     }
@@ -97,13 +171,74 @@ void TaskThreadManager::teardown() {
     }
 }
 
-void TaskThreadManager::onForceData(int channel, double absoluteForce, double relativeForce, long long timestampUs) {
+quint64 TaskThreadManager::droppedSampleCount() const {
+    return m_sampleRing ? m_sampleRing->droppedCount() : 0;
+}
+
+void TaskThreadManager::drainSampleRing() {
+    if (!m_sampleRing) return;
+    // 一次取完当前积压的样本，按块写入
+    for (;;) {
+        const int n = static_cast<int>(m_sampleRing->popBatch(m_drainBuffer.get(), kDrainChunk));
+        if (n == 0) break;
+        writeSamples(m_drainBuffer.get(), n);
+        if (n < kDrainChunk) break;
+    }
+
+    const quint64 dropped = m_sampleRing->droppedCount();
+    if (dropped != m_reportedDrops) {
+        emit errorOccurred(QStringLiteral("样本环形缓冲区溢出，累计丢弃 %1 个样本").arg(dropped));
+        m_reportedDrops = dropped;
+    }
+}
+
+void TaskThreadManager::writeSamples(const ForceSample* samples, int count) {
     if (!m_saveEnabled) return;
-    if (!m_saver) return;
-    // 高速写入：避免 QStringList 临时对象过多，直接拼接
-    QString ts = QString::number(timestampUs);
-    QString ch = QString::number(channel);
-    QString abs = QString::number(absoluteForce, 'f', 6);
-    QString rel = QString::number(relativeForce, 'f', 6);
-    m_saver->writeRow(m_kind, m_group, {ts, ch, abs, rel});
+    if (!m_saver || m_saveStreams.isEmpty()) return;
+    if (m_binarySave) {
+        // 定长记录直接编码，无文本格式化；按通道稳定分段（计数排序），每个通道的行连续存放后一次写入其文件
+        const int channels = m_saveStreams.size();
+        m_channelRows.fill(0, channels + 1);
+        for (int i = 0; i < count; ++i) {
+            const int ch = samples[i].channel;
+            if (ch >= 1 && ch <= channels) ++m_channelRows[ch];
+        }
+        for (int ch = 1; ch <= channels; ++ch) m_channelRows[ch] += m_channelRows[ch - 1];
+        // 此时 m_channelRows[ch - 1] 为通道 ch 的起始行，填充后变为其结束行
+        m_recordBuffer.resize(m_channelRows[channels] * kBinaryColumns);
+        double* records = m_recordBuffer.data();
+        for (int i = 0; i < count; ++i) {
+            const ForceSample& s = samples[i];
+            if (s.channel < 1 || s.channel > channels) continue;
+            double* row = records + m_channelRows[s.channel - 1]++ * kBinaryColumns;
+            row[0] = static_cast<double>(s.timestampUs);
+            row[1] = s.channel;
+            row[2] = s.raw;
+            row[3] = s.absoluteForce;
+            row[4] = s.relativeForce;
+        }
+        int begin = 0;
+        for (int ch = 1; ch <= channels; ++ch) {
+            const int end = m_channelRows[ch - 1];
+            if (end > begin) {
+                m_saver->writeDoubleRows(m_saveStreams.at(ch - 1), records + begin * kBinaryColumns, end - begin, kBinaryColumns);
+            }
+            begin = end;
+        }
+        return;
+    }
+    // 整块拼接为一个文本块，一次写入
+    m_rowBuffer.resize(0);
+    for (int i = 0; i < count; ++i) {
+        const ForceSample& s = samples[i];
+        CsvFormat::appendInt(m_rowBuffer, s.timestampUs);
+        m_rowBuffer.append(',');
+        CsvFormat::appendInt(m_rowBuffer, s.channel);
+        m_rowBuffer.append(',');
+        CsvFormat::appendDouble(m_rowBuffer, s.absoluteForce, 6);
+        m_rowBuffer.append(',');
+        CsvFormat::appendDouble(m_rowBuffer, s.relativeForce, 6);
+        m_rowBuffer.append('\n');
+    }
+    m_saver->writeRawBlock(m_saveStreams.at(0), m_rowBuffer);
 }
@@ -6,7 +6,11 @@
 #include <QTimer>
 #include <QByteArray>
 #include <QString>
+#include <QVector>
 #include <atomic>
+#include <memory>
+
+#include "SpscRing.h"
 
 // 前向声明，避免头文件依赖过重
 class DataSaver;
@@ -14,6 +18,8 @@ class DataSaver;
 // 前向声明，按需与 Drivers 模块交互
 class Scanner;
 class ForceSensor;
+class SerialReactor;
+struct ForceSample;
 
 // 任务线程管理：提供启动/停止、状态、与 UI/控制层对接
 class TaskThreadManager : public QObject {
@@ -26,9 +32,37 @@ public:
     void setDataSaveEnabled(bool enabled) { m_saveEnabled = enabled; }
     void setDataSaverBaseDir(const QString& dir) { m_baseDir = dir; }
     void setCsvKindGroup(const QString& kind, const QString& group) { m_kind = kind; m_group = group; }
+    // 异步写盘（默认开启）：由 DataSaver 后台线程执行写操作，存储侧不阻塞在磁盘 IO 上
+    void setAsyncSaveEnabled(bool enabled) { m_asyncSave = enabled; }
+    // 二进制保存（默认关闭）：每个通道按定长记录写一个 <group>CH<n> 文件，体积与格式化开销均远小于 CSV，
+    // 文件头中 raw 列的灵敏度即该通道的灵敏度；可用 tools/BinToCsv 离线转换为 CSV
+    void setBinarySaveEnabled(bool enabled) { m_binarySave = enabled; }
+    // 断电最多丢失的数据时长（毫秒，0 为不主动同步，默认）：按此周期对保存文件做 fdatasync 并写检查点
+    void setSaveMaxLossMs(int ms) { m_saveMaxLossMs = ms; }
+    // 同时保存按通道分别统计的 1:16 / 1:256 / 1:4096 min/max/mean 降采样文件（默认关闭），供长时间概览
+    void setSaveDecimationEnabled(bool enabled) { m_saveDecimation = enabled; }
     // ForceSensor 配置（由本类内部创建，不外部注入）
     void setForceSensorPort(const QString& port) { m_portName = port; }
     void setForceSensorSensitivity(double ch1, double ch2) { m_sensCH1 = ch1; m_sensCH2 = ch2; }
+    // 多通道放大器（start 前设置）：通道标识每个字符一个通道（空为默认 "bd"），
+    // sensitivities[i] 为通道 i + 1 的灵敏度（覆盖 setForceSensorSensitivity，未给出的通道为 1.0）
+    void setForceSensorChannels(const QByteArray& ids, const QVector<double>& sensitivities = QVector<double>()) {
+        m_channelIds = ids;
+        m_sensitivities = sensitivities;
+    }
+    // 原始字节流抓取文件路径（空为不抓取，默认）：连接后把串口收到的原始数据连同时间戳写入该文件，
+    // 可用 RawCaptureReader + ForceSensor::replayCapture 离线重新解析
+    void setRawCapturePath(const QString& path) { m_rawCapturePath = path; }
+    // 低延迟读取（仅 Linux，默认关闭）：串口由专用读线程阻塞等待并直接解析，不经过传感器线程的事件循环
+    void setLowLatencyReadEnabled(bool enabled) { m_lowLatencyRead = enabled; }
+    // 共用的串口反应器（仅 Linux，首次 start 前设置，reactor 须已启动且由调用方管理）：
+    // 设置后不再创建传感器线程，串口加入反应器，多台设备的多个 TaskThreadManager 共用同一个读线程
+    void setSerialReactor(SerialReactor* reactor) { m_reactor = reactor; }
+    // 采集 -> 存储样本环形缓冲区配置（start 前设置）：容量（条）与满时策略
+    void setSampleRingCapacity(int samples) { m_ringCapacity = samples; }
+    void setSampleOverflowPolicy(TCM::RingOverflowPolicy policy) { m_overflowPolicy = policy; }
+    // 因缓冲区满而丢弃的样本总数（可在任意线程读取）
+    quint64 droppedSampleCount() const;
 
 public slots:
     void start();
@@ -41,7 +75,9 @@ signals:
 
 private:
     void teardown();
-    Q_SLOT void onForceData(int channel, double absoluteForce, double relativeForce, long long timestampUs);
+    // 存储侧：从环形缓冲区批量取出样本并写入 DataSaver
+    Q_SLOT void drainSampleRing();
+    void writeSamples(const ForceSample* samples, int count);
 
 private:
     bool m_running { false };
@@ -50,14 +86,38 @@ private:
     // DataSaver 集成
     DataSaver* m_saver { nullptr };
     bool m_saveEnabled { true };
+    bool m_asyncSave { true };
+    bool m_binarySave { false };
+    int m_saveMaxLossMs { 0 };
+    bool m_saveDecimation { false };
     QString m_baseDir { QStringLiteral("Data/Output") };
     QString m_kind { QStringLiteral("Acquisition") };
     QString m_group { QStringLiteral("Raw") };
+    QVector<int> m_saveStreams; // DataSaver::StreamId，start() 中打开；二进制模式下第 i 个为通道 i + 1 的文件
 
     // ForceSensor 管理
     ForceSensor* m_forceSensor { nullptr };
     QString m_portName { QStringLiteral("COM1") }; // 默认口名，可通过 setForceSensorPort 配置
     double m_sensCH1 { 1.0 };
     double m_sensCH2 { 1.0 };
+    QByteArray m_channelIds;
+    QVector<double> m_sensitivities;
+    QString m_rawCapturePath;
+    bool m_lowLatencyRead { false };
+    SerialReactor* m_reactor { nullptr };
+
+    // 采集 -> 存储样本环形缓冲区
+    std::unique_ptr<TCM::SpscRing<ForceSample>> m_sampleRing;
+    int m_ringCapacity { 1 << 16 };
+    TCM::RingOverflowPolicy m_overflowPolicy { TCM::RingOverflowPolicy::DropOldest };
+    QTimer* m_drainTimer { nullptr };
+    int m_drainIntervalMs { 5 };
+    std::unique_ptr<ForceSample[]> m_drainBuffer; // 单次取出的样本暂存区
+    quint64 m_reportedDrops { 0 };                // 已上报的丢弃数
+
+    // 批量写入时复用的行文本缓冲（UTF-8），避免每批重新分配
+    QByteArray m_rowBuffer;
+    QVector<double> m_recordBuffer; // 二进制模式下复用的记录矩阵（行主序，按通道分段）
+    QVector<int> m_channelRows;     // 按通道分段时各通道的起止行
 };
 
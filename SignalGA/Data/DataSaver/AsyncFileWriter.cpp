@@ -0,0 +1,193 @@
+#include "AsyncFileWriter.h"
+
+#include "BlockCompression.h"
+#include "WriteBatch.h"
+
+#include <QMutexLocker>
+
+AsyncFileWriter::AsyncFileWriter(int maxInflightBuffers, QObject* parent)
+    : QThread(parent)
+    , m_maxInflight(maxInflightBuffers < 1 ? 1 : maxInflightBuffers) {
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    shutdown();
+}
+
+void AsyncFileWriter::setWriteBatch(WriteBatch* batch) {
+    m_batch.reset(batch);
+}
+
+void AsyncFileWriter::submit(QFile* file, QByteArray& data,
+                             BlockCompression::BlockCompressor* compressor, bool endBlock) {
+    if (data.isEmpty() && !(compressor && endBlock)) return;
+    QMutexLocker locker(&m_mutex);
+    // 背压：在途缓冲区已满时等待写盘线程腾出位置
+    while (m_inflight >= m_maxInflight && !m_stopping) {
+        m_slotFree.wait(&m_mutex);
+    }
+
+    Job job;
+    job.file = file;
+    job.compressor = compressor;
+    job.endBlock = endBlock;
+    job.data.swap(data);
+    if (!m_freeBuffers.isEmpty()) {
+        data.swap(m_freeBuffers.last());
+        m_freeBuffers.removeLast();
+    } else {
+        data.reserve(job.data.capacity()); // 首轮：按同样容量新建一块，之后循环复用
+    }
+    m_jobs.push_back(std::move(job));
+    ++m_inflight;
+    m_jobReady.wakeOne();
+}
+
+void AsyncFileWriter::submitSync(const QVector<Durability::SyncTarget>& targets) {
+    if (targets.isEmpty()) return;
+    QMutexLocker locker(&m_mutex);
+    while (m_inflight >= m_maxInflight && !m_stopping) {
+        m_slotFree.wait(&m_mutex);
+    }
+    Job job;
+    job.sync = targets;
+    m_jobs.push_back(std::move(job));
+    ++m_inflight;
+    m_jobReady.wakeOne();
+}
+
+quint64 AsyncFileWriter::submitTask(std::function<QString()> task) {
+    QMutexLocker locker(&m_mutex);
+    while (m_inflight >= m_maxInflight && !m_stopping) {
+        m_slotFree.wait(&m_mutex);
+    }
+    Job job;
+    job.task = std::move(task);
+    m_jobs.push_back(std::move(job));
+    ++m_inflight;
+    m_jobReady.wakeOne();
+    return ++m_tasksSubmitted;
+}
+
+void AsyncFileWriter::waitTask(quint64 ticket) {
+    QMutexLocker locker(&m_mutex);
+    while (m_tasksDone < ticket) {
+        m_taskDone.wait(&m_mutex);
+    }
+}
+
+void AsyncFileWriter::waitIdle() {
+    QMutexLocker locker(&m_mutex);
+    while (m_inflight > 0) {
+        m_idle.wait(&m_mutex);
+    }
+}
+
+void AsyncFileWriter::shutdown() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_jobReady.wakeAll();
+        m_slotFree.wakeAll();
+    }
+    wait();
+}
+
+void AsyncFileWriter::run() {
+    std::deque<Job> jobs;
+    for (;;) {
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_jobs.empty() && !m_stopping) {
+                m_jobReady.wait(&m_mutex);
+            }
+            if (m_jobs.empty()) {
+                break; // 已请求退出且无剩余任务
+            }
+            if (m_batch) {
+                // 批量后端：取出全部排队的任务，各文件的数据合并后一次提交
+                jobs.swap(m_jobs);
+            } else {
+                jobs.push_back(std::move(m_jobs.front()));
+                m_jobs.pop_front();
+            }
+        }
+
+        // 锁外压缩与写盘
+        for (Job& job : jobs) {
+            if (m_batch && job.sync.isEmpty() && !job.task && !job.compressor) {
+                m_batch->add(job.file, job.data);
+                continue;
+            }
+            // 组提交、任务与压缩文件不经批量后端：先写完已排队的数据并交还文件，
+            // 保证同一文件的顺序、检查点覆盖全部数据，任务可以直接关闭文件
+            if (m_batch) submitBatch(true);
+            execute(job);
+            if (job.task) {
+                QMutexLocker locker(&m_mutex);
+                ++m_tasksDone;
+                m_taskDone.wakeAll();
+            }
+        }
+        if (m_batch) {
+            bool idle;
+            {
+                QMutexLocker locker(&m_mutex);
+                idle = m_jobs.empty();
+            }
+            // 空闲时交还文件：waitIdle 返回后调用方可能直接写入或关闭文件
+            submitBatch(idle);
+        }
+
+        QMutexLocker locker(&m_mutex);
+        for (Job& job : jobs) {
+            if (job.sync.isEmpty() && !job.task) {
+                // 清空但保留容量，放回空闲池
+                job.data.resize(0);
+                m_freeBuffers.append(std::move(job.data));
+            }
+        }
+        m_inflight -= static_cast<int>(jobs.size());
+        jobs.clear();
+        m_slotFree.wakeAll();
+        if (m_inflight == 0) {
+            m_idle.wakeAll();
+        }
+    }
+}
+
+void AsyncFileWriter::execute(Job& job) {
+    if (job.task) {
+        const QString error = job.task();
+        if (!error.isEmpty()) {
+            emit writeFailed(error);
+        }
+        return;
+    }
+    if (!job.sync.isEmpty()) {
+        // 组提交：队列按顺序执行，此前提交的数据均已写出
+        QString error;
+        if (!Durability::commitGroup(job.sync, &error)) {
+            emit writeFailed(error);
+        }
+        return;
+    }
+    const bool ok = job.compressor
+        ? job.compressor->write(*job.file, job.data, job.endBlock)
+        : job.file->write(job.data) == job.data.size();
+    if (!ok) {
+        emit writeFailed(QStringLiteral("写入失败: %1 (%2)").arg(job.file->fileName(), job.file->errorString()));
+    }
+    job.file->flush();
+}
+
+void AsyncFileWriter::submitBatch(bool finish) {
+    QString error;
+    if (!m_batch->submit(&error)) {
+        emit writeFailed(error);
+    }
+    error.clear();
+    if (finish && !m_batch->finish(&error)) {
+        emit writeFailed(error);
+    }
+}
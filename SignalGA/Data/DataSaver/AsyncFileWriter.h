@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "Durability.h"
+
+namespace BlockCompression { class BlockCompressor; }
+class WriteBatch;
+
+// AsyncFileWriter: DataSaver 的后台写盘线程
+// 生产者把填满的缓冲区整块交换（不拷贝）给本线程，由本线程执行全部 write 调用；
+// 写完的缓冲区清空后保留容量放回空闲池，下次提交时交换回生产者继续填充。
+// 在途缓冲区数量有上限：磁盘跟不上时，submit 会阻塞生产者（背压），内存不会无限增长。
+// 设置批量写后端（WriteBatch）后，每轮取出全部排队的任务，未压缩的数据按文件合并后一次提交。
+class AsyncFileWriter : public QThread {
+    Q_OBJECT
+public:
+    explicit AsyncFileWriter(int maxInflightBuffers = 8, QObject* parent = nullptr);
+    ~AsyncFileWriter() override;
+
+    // 提交 file 的一块数据。data 与空闲池中的缓冲区交换：返回时 data 为空但保留容量，可直接继续填充。
+    // 同一文件的数据按提交顺序写出。file 在其数据写完（waitIdle 返回）之前必须保持打开。
+    // compressor 非空时数据经其分块压缩后写出（压缩在本线程执行）；endBlock 要求把未满一块的数据也写出，
+    // 此时 data 可以为空。
+    void submit(QFile* file, QByteArray& data,
+                BlockCompression::BlockCompressor* compressor = nullptr, bool endBlock = false);
+
+    // 提交一次组提交：在此之前提交的数据全部写完后，同步 targets 中的文件并写检查点（见 Durability.h）。
+    // 生产者不等待同步完成；文件在 waitIdle 返回之前必须保持打开。
+    void submitSync(const QVector<Durability::SyncTarget>& targets);
+
+    // 提交一个在本线程执行的任务（例如文件收尾与关闭）：此前提交的数据全部写出（含批量后端）后执行，
+    // 返回非空字符串时经 writeFailed 报告。返回任务序号，可用 waitTask 只等待到该任务完成
+    quint64 submitTask(std::function<QString()> task);
+    void waitTask(quint64 ticket);
+
+    // 阻塞直到所有已提交的数据写完
+    void waitIdle();
+
+    // 处理完剩余任务后结束线程
+    void shutdown();
+
+    int maxInflightBuffers() const { return m_maxInflight; }
+
+    // 批量写后端（接管所有权），须在 start() 之前设置；为空时逐块 QFile::write
+    void setWriteBatch(WriteBatch* batch);
+    const WriteBatch* writeBatch() const { return m_batch.get(); }
+
+signals:
+    void writeFailed(const QString& message);
+
+protected:
+    void run() override;
+
+private:
+    struct Job {
+        QFile* file { nullptr };
+        QByteArray data;
+        BlockCompression::BlockCompressor* compressor { nullptr };
+        bool endBlock { false };
+        QVector<Durability::SyncTarget> sync; // 非空即为组提交任务，不携带数据
+        std::function<QString()> task;        // 非空即为 submitTask 提交的任务，不携带数据
+    };
+
+    // 执行单个任务：组提交、压缩写入或 QFile::write
+    void execute(Job& job);
+    // 提交已排队的批量写；finish 为 true 时同时写完 direct 模式的尾部并交还文件位置
+    void submitBatch(bool finish);
+
+    const int m_maxInflight;
+    std::unique_ptr<WriteBatch> m_batch;
+    QMutex m_mutex;
+    QWaitCondition m_jobReady;   // 有新任务或需要退出
+    QWaitCondition m_slotFree;   // 在途缓冲区数下降
+    QWaitCondition m_idle;       // 全部任务写完
+    QWaitCondition m_taskDone;   // 有 submitTask 任务执行完
+    std::deque<Job> m_jobs;
+    QVector<QByteArray> m_freeBuffers; // 回收的缓冲区（保留容量）
+    int m_inflight { 0 };              // 已提交但未写完的缓冲区数（含正在写的）
+    quint64 m_tasksSubmitted { 0 };
+    quint64 m_tasksDone { 0 };         // 任务按提交顺序执行，序号不大于此值的均已完成
+    bool m_stopping { false };
+};
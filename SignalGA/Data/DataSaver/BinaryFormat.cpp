@@ -0,0 +1,234 @@
+#include "BinaryFormat.h"
+
+#include <QFile>
+
+namespace BinaryFormat {
+
+namespace {
+
+void appendU8(QByteArray& out, quint8 v) {
+    out.append(static_cast<char>(v));
+}
+
+void appendU16(QByteArray& out, quint16 v) {
+    char b[2];
+    qToLittleEndian<quint16>(v, b);
+    out.append(b, 2);
+}
+
+void appendU32(QByteArray& out, quint32 v) {
+    char b[4];
+    qToLittleEndian<quint32>(v, b);
+    out.append(b, 4);
+}
+
+void appendI64(QByteArray& out, qint64 v) {
+    char b[8];
+    qToLittleEndian<qint64>(v, b);
+    out.append(b, 8);
+}
+
+void appendF64(QByteArray& out, double v) {
+    char b[8];
+    putDouble(b, ColumnType::Float64, v);
+    out.append(b, 8);
+}
+
+bool fail(QString* error, const QString& message) {
+    if (error) *error = message;
+    return false;
+}
+
+// 读取 n 个字节，不足则失败
+bool readExact(QIODevice& device, char* dst, qint64 n) {
+    return device.read(dst, n) == n;
+}
+
+// 整型列、浮点列分别格式化为 CSV 字段
+void appendField(QByteArray& out, const char* src, ColumnType type, int precision) {
+    if (type == ColumnType::Float64) {
+        out.append(QByteArray::number(getDouble(src, type), 'f', precision));
+    } else {
+        out.append(QByteArray::number(getInt(src, type)));
+    }
+}
+
+} // namespace
+
+const char* typeName(ColumnType type) {
+    switch (type) {
+    case ColumnType::Int32: return "int32";
+    case ColumnType::Int64: return "int64";
+    case ColumnType::Float64: return "float64";
+    }
+    return "(unknown)";
+}
+
+int Header::recordSize() const {
+    int size = 0;
+    for (const Column& c : columns) size += columnWidth(c.type);
+    return size;
+}
+
+QByteArray encodeHeader(const Header& header) {
+    QByteArray out;
+    out.append(MAGIC, sizeof(MAGIC));
+    appendU32(out, 0); // headerSize，末尾回填
+    appendU16(out, VERSION);
+    appendU16(out, static_cast<quint16>(header.columns.size()));
+    appendU32(out, static_cast<quint32>(header.recordSize()));
+    appendI64(out, header.epochUs);
+    appendU32(out, static_cast<quint32>(header.metadata.size()));
+    for (const Column& c : header.columns) {
+        const QByteArray name = c.name.toUtf8();
+        appendU8(out, static_cast<quint8>(c.type));
+        appendU8(out, 0);
+        appendU16(out, static_cast<quint16>(name.size()));
+        appendF64(out, c.sensitivity);
+        out.append(name);
+    }
+    for (const auto& kv : header.metadata) {
+        const QByteArray key = kv.first.toUtf8();
+        const QByteArray value = kv.second.toUtf8();
+        appendU16(out, static_cast<quint16>(key.size()));
+        appendU16(out, static_cast<quint16>(value.size()));
+        out.append(key);
+        out.append(value);
+    }
+    while (out.size() % 8 != 0) out.append('\0');
+    qToLittleEndian<quint32>(static_cast<quint32>(out.size()), out.data() + sizeof(MAGIC));
+    return out;
+}
+
+bool readHeader(QIODevice& device, Header& header, QString* error) {
+    // 定长部分：magic(8) + headerSize(4) + version(2) + columnCount(2) + recordSize(4) + epochUs(8) + metadataCount(4)
+    char fixed[32];
+    if (!readExact(device, fixed, sizeof(fixed))) {
+        return fail(error, QStringLiteral("文件头不完整"));
+    }
+    if (std::memcmp(fixed, MAGIC, sizeof(MAGIC)) != 0) {
+        return fail(error, QStringLiteral("不是 SignalGA 二进制记录文件"));
+    }
+    const quint32 headerSize = qFromLittleEndian<quint32>(fixed + 8);
+    const quint16 version = qFromLittleEndian<quint16>(fixed + 12);
+    const quint16 columnCount = qFromLittleEndian<quint16>(fixed + 14);
+    const quint32 recordSize = qFromLittleEndian<quint32>(fixed + 16);
+    if (version != VERSION) {
+        return fail(error, QStringLiteral("不支持的版本: %1").arg(version));
+    }
+    if (headerSize < sizeof(fixed) || headerSize > (1u << 24)) {
+        return fail(error, QStringLiteral("文件头长度无效: %1").arg(headerSize));
+    }
+
+    QByteArray rest(static_cast<int>(headerSize - sizeof(fixed)), Qt::Uninitialized);
+    if (!readExact(device, rest.data(), rest.size())) {
+        return fail(error, QStringLiteral("文件头不完整"));
+    }
+
+    Header h;
+    h.epochUs = qFromLittleEndian<qint64>(fixed + 20);
+    const quint32 metadataCount = qFromLittleEndian<quint32>(fixed + 28);
+    const char* p = rest.constData();
+    const char* end = p + rest.size();
+    for (int i = 0; i < columnCount; ++i) {
+        if (end - p < 12) return fail(error, QStringLiteral("列描述不完整"));
+        Column c;
+        const quint8 type = static_cast<quint8>(p[0]);
+        if (type < static_cast<quint8>(ColumnType::Int32) || type > static_cast<quint8>(ColumnType::Float64)) {
+            return fail(error, QStringLiteral("未知列类型: %1").arg(type));
+        }
+        c.type = static_cast<ColumnType>(type);
+        const quint16 nameLen = qFromLittleEndian<quint16>(p + 2);
+        c.sensitivity = getDouble(p + 4, ColumnType::Float64);
+        p += 12;
+        if (end - p < nameLen) return fail(error, QStringLiteral("列名不完整"));
+        c.name = QString::fromUtf8(p, nameLen);
+        p += nameLen;
+        h.columns.append(c);
+    }
+    for (quint32 i = 0; i < metadataCount; ++i) {
+        if (end - p < 4) return fail(error, QStringLiteral("元数据不完整"));
+        const quint16 keyLen = qFromLittleEndian<quint16>(p);
+        const quint16 valueLen = qFromLittleEndian<quint16>(p + 2);
+        p += 4;
+        if (end - p < keyLen + valueLen) return fail(error, QStringLiteral("元数据不完整"));
+        h.metadata.append(qMakePair(QString::fromUtf8(p, keyLen), QString::fromUtf8(p + keyLen, valueLen)));
+        p += keyLen + valueLen;
+    }
+    if (h.recordSize() != static_cast<int>(recordSize)) {
+        return fail(error, QStringLiteral("记录长度与列描述不一致"));
+    }
+    header = h;
+    return true;
+}
+
+bool convertToCsv(const QString& binPath, const QString& csvPath, int precision, QString* error) {
+    QFile in(binPath);
+    if (!in.open(QIODevice::ReadOnly)) {
+        return fail(error, QStringLiteral("无法打开文件: %1").arg(binPath));
+    }
+    Header header;
+    if (!readHeader(in, header, error)) {
+        return false;
+    }
+    QFile out(csvPath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return fail(error, QStringLiteral("无法打开文件: %1").arg(csvPath));
+    }
+
+    QByteArray text;
+    for (int i = 0; i < header.columns.size(); ++i) {
+        if (i) text.append(',');
+        text.append(header.columns[i].name.toUtf8());
+    }
+    text.append('\n');
+
+    // 逐块读取：每块 4096 条记录，内存占用与文件大小无关；不足一条的尾部字节留到下一块
+    const int recordSize = header.recordSize();
+    if (recordSize <= 0) {
+        return fail(error, QStringLiteral("文件未定义任何列"));
+    }
+    const int chunkRecords = 4096;
+    QByteArray chunk(recordSize * chunkRecords, Qt::Uninitialized);
+    qint64 filled = 0;
+    for (;;) {
+        const qint64 got = in.read(chunk.data() + filled, chunk.size() - filled);
+        if (got < 0) {
+            return fail(error, QStringLiteral("读取失败: %1").arg(binPath));
+        }
+        filled += got;
+        const int records = static_cast<int>(filled / recordSize);
+        for (int r = 0; r < records; ++r) {
+            const char* rec = chunk.constData() + r * recordSize;
+            int offset = 0;
+            for (int c = 0; c < header.columns.size(); ++c) {
+                if (c) text.append(',');
+                appendField(text, rec + offset, header.columns[c].type, precision);
+                offset += columnWidth(header.columns[c].type);
+            }
+            text.append('\n');
+        }
+        if (out.write(text) != text.size()) {
+            return fail(error, QStringLiteral("写入失败: %1").arg(csvPath));
+        }
+        text.resize(0);
+
+        const qint64 consumed = static_cast<qint64>(records) * recordSize;
+        const qint64 remain = filled - consumed;
+        if (got == 0) {
+            if (remain != 0) {
+                // 例如异常断电造成的撕裂尾部：已转换完整记录，报告残余字节
+                return fail(error, QStringLiteral("文件末尾存在不完整记录（%1 字节），已忽略").arg(remain));
+            }
+            break;
+        }
+        std::memmove(chunk.data(), chunk.constData() + consumed, static_cast<size_t>(remain));
+        filled = remain;
+    }
+    if (!text.isEmpty() && out.write(text) != text.size()) {
+        return fail(error, QStringLiteral("写入失败: %1").arg(csvPath));
+    }
+    return true;
+}
+
+} // namespace BinaryFormat
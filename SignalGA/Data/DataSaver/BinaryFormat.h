@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+
+// BinaryFormat: DataSaver 二进制记录文件（<kind>/<group>.bin）的格式定义与编解码
+//
+// 文件 = 自描述文件头 + 定长记录序列，所有数值均为小端序。
+// 文件头：
+//   char[8]  magic          "SGABIN01"
+//   u32      headerSize     文件头总字节数（含 magic 与对齐填充），记录从此偏移开始
+//   u16      version        当前为 1
+//   u16      columnCount
+//   u32      recordSize     每条记录的字节数（各列宽度之和）
+//   i64      epochUs        时间戳零点对应的墙钟时间（Unix 纪元微秒，0 表示未知）
+//   u32      metadataCount
+//   列描述 × columnCount：u8 type, u8 reserved, u16 nameLen, f64 sensitivity, name[nameLen] (UTF-8)
+//   元数据 × metadataCount：u16 keyLen, u16 valueLen, key, value (UTF-8)
+//   填充到 8 字节对齐
+// 记录：按列顺序紧密排列，Int32 占 4 字节，Int64/Float64 占 8 字节。
+namespace BinaryFormat {
+
+const char MAGIC[8] = { 'S', 'G', 'A', 'B', 'I', 'N', '0', '1' };
+const quint16 VERSION = 1;
+const char FILE_SUFFIX[] = "bin";
+
+enum class ColumnType : quint8 {
+    Int32 = 1,
+    Int64 = 2,
+    Float64 = 3
+};
+
+inline int columnWidth(ColumnType type) {
+    return type == ColumnType::Int32 ? 4 : 8;
+}
+
+const char* typeName(ColumnType type);
+
+struct Column {
+    QString name;
+    ColumnType type { ColumnType::Float64 };
+    double sensitivity { 0.0 }; // 原始计数到物理量的系数，0 表示不适用
+};
+
+struct Header {
+    qint64 epochUs { 0 };
+    QVector<Column> columns;
+    QVector<QPair<QString, QString>> metadata;
+
+    int recordSize() const;
+};
+
+// 序列化文件头（含对齐填充）
+QByteArray encodeHeader(const Header& header);
+
+// 从设备当前位置解析文件头；成功后设备位于第一条记录处
+bool readHeader(QIODevice& device, Header& header, QString* error = nullptr);
+
+// 按列类型写入/读取单个字段（dst/src 指向记录内该列的起始字节）
+inline void putInt(char* dst, ColumnType type, qint64 v) {
+    switch (type) {
+    case ColumnType::Int32: qToLittleEndian<qint32>(static_cast<qint32>(v), dst); break;
+    case ColumnType::Int64: qToLittleEndian<qint64>(v, dst); break;
+    case ColumnType::Float64: {
+        const double d = static_cast<double>(v);
+        quint64 bits;
+        std::memcpy(&bits, &d, sizeof bits);
+        qToLittleEndian<quint64>(bits, dst);
+        break;
+    }
+    }
+}
+
+inline void putDouble(char* dst, ColumnType type, double v) {
+    switch (type) {
+    case ColumnType::Int32: qToLittleEndian<qint32>(static_cast<qint32>(qRound64(v)), dst); break;
+    case ColumnType::Int64: qToLittleEndian<qint64>(qRound64(v), dst); break;
+    case ColumnType::Float64: {
+        quint64 bits;
+        std::memcpy(&bits, &v, sizeof bits);
+        qToLittleEndian<quint64>(bits, dst);
+        break;
+    }
+    }
+}
+
+inline qint64 getInt(const char* src, ColumnType type) {
+    switch (type) {
+    case ColumnType::Int32: return qFromLittleEndian<qint32>(src);
+    case ColumnType::Int64: return qFromLittleEndian<qint64>(src);
+    case ColumnType::Float64: break;
+    }
+    const quint64 bits = qFromLittleEndian<quint64>(src);
+    double d;
+    std::memcpy(&d, &bits, sizeof d);
+    return qRound64(d);
+}
+
+inline double getDouble(const char* src, ColumnType type) {
+    if (type != ColumnType::Float64) return static_cast<double>(getInt(src, type));
+    const quint64 bits = qFromLittleEndian<quint64>(src);
+    double d;
+    std::memcpy(&d, &bits, sizeof d);
+    return d;
+}
+
+// 流式转换为 CSV：逐块读取记录并写出文本（整型列原样输出，浮点列按 precision 位小数）
+bool convertToCsv(const QString& binPath, const QString& csvPath, int precision = 6, QString* error = nullptr);
+
+} // namespace BinaryFormat
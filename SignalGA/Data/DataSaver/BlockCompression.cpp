@@ -0,0 +1,387 @@
+#include "BlockCompression.h"
+
+#include <QtEndian>
+#include <cstring>
+
+#include "CsvFormat.h"
+#include "IntegerCodec.h"
+
+namespace BlockCompression {
+
+namespace {
+
+bool fail(QString* error, const QString& message) {
+    if (error) *error = message;
+    return false;
+}
+
+// 旁路索引：逐行解析并校验块之间首尾相接、最后一块恰好结束在文件末尾
+bool loadSidecar(const QString& path, qint64 fileSize, QVector<BlockInfo>& blocks) {
+    QFile idx(indexPath(path));
+    if (!idx.open(QIODevice::ReadOnly)) return false;
+    const QList<QByteArray> lines = idx.readAll().split('\n');
+    QVector<BlockInfo> parsed;
+    qint64 expectOffset = FILE_HEADER_SIZE;
+    qint64 expectRaw = 0;
+    for (int i = 1; i < lines.size(); ++i) { // 第一行为表头
+        if (lines[i].isEmpty()) continue;
+        const QList<QByteArray> f = lines[i].split(',');
+        if (f.size() != 5) return false;
+        BlockInfo b;
+        b.offset = f[1].toLongLong();
+        b.rawOffset = f[2].toLongLong();
+        b.rawSize = f[3].toInt();
+        b.compressedSize = f[4].toInt();
+        if (b.offset != expectOffset || b.rawOffset != expectRaw) return false;
+        expectOffset += BLOCK_HEADER_SIZE + b.compressedSize;
+        expectRaw += b.rawSize;
+        parsed.append(b);
+    }
+    if (expectOffset != fileSize) return false;
+    blocks = parsed;
+    return true;
+}
+
+int recordSizeOf(const QVector<BinaryFormat::ColumnType>& types) {
+    int size = 0;
+    for (BinaryFormat::ColumnType t : types) size += BinaryFormat::columnWidth(t);
+    return size;
+}
+
+template <typename T>
+bool readLe(const char*& p, const char* end, T& v) {
+    if (end - p < static_cast<qint64>(sizeof(T))) return false;
+    v = qFromLittleEndian<T>(p);
+    p += sizeof(T);
+    return true;
+}
+
+// 按列打包块的逆变换，格式见 BlockCompression.h
+bool unpackRecords(const QByteArray& packed, int rawSize, QByteArray& raw) {
+    const char* p = packed.constData();
+    const char* end = p + packed.size();
+    quint32 prefix = 0;
+    quint32 records = 0;
+    quint16 columnCount = 0;
+    if (!readLe(p, end, prefix) || !readLe(p, end, records) || !readLe(p, end, columnCount)) return false;
+    if (end - p < columnCount) return false;
+    QVector<BinaryFormat::ColumnType> types;
+    for (int c = 0; c < columnCount; ++c) {
+        const quint8 t = static_cast<quint8>(*p++);
+        if (t < 1 || t > 3) return false;
+        types.append(static_cast<BinaryFormat::ColumnType>(t));
+    }
+    const qint64 recordSize = recordSizeOf(types);
+    const qint64 recordBytes = recordSize * records;
+    if (recordSize == 0 || qint64(prefix) + recordBytes > rawSize) return false;
+
+    raw.resize(rawSize);
+    char* rec = raw.data() + prefix;
+    QVector<qint64> values;
+    int offset = 0;
+    for (BinaryFormat::ColumnType t : types) {
+        quint8 encoding = 0;
+        quint32 bytes = 0;
+        if (!readLe(p, end, encoding) || !readLe(p, end, bytes) || quint64(end - p) < bytes) return false;
+        if (encoding == 0) {
+            const int width = BinaryFormat::columnWidth(t);
+            if (bytes != quint64(records) * width) return false;
+            for (int b = 0; b < width; ++b) {
+                for (quint32 r = 0; r < records; ++r) rec[r * recordSize + offset + b] = *p++;
+            }
+        } else {
+            values.resize(static_cast<int>(records));
+            if (IntegerCodec::decode(p, static_cast<int>(bytes), static_cast<int>(records),
+                                     static_cast<IntegerCodec::Mode>(encoding), values.data()) != static_cast<int>(bytes)) {
+                return false;
+            }
+            for (quint32 r = 0; r < records; ++r) BinaryFormat::putInt(rec + r * recordSize + offset, t, values[r]);
+            p += bytes;
+        }
+        offset += BinaryFormat::columnWidth(t);
+    }
+    // 剩余为块开头与末尾不足一条记录的原始字节
+    if (end - p != rawSize - recordBytes) return false;
+    std::memcpy(raw.data(), p, prefix);
+    p += prefix;
+    std::memcpy(rec + recordBytes, p, static_cast<size_t>(end - p));
+    return true;
+}
+
+} // namespace
+
+QString indexPath(const QString& path) {
+    return path + QStringLiteral(".idx");
+}
+
+bool loadIndex(const QString& path, QVector<BlockInfo>& blocks, qint64* validEnd, QString* error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(error, QStringLiteral("无法打开文件: %1").arg(path));
+    }
+    char header[FILE_HEADER_SIZE];
+    if (file.read(header, FILE_HEADER_SIZE) != FILE_HEADER_SIZE || std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0) {
+        return fail(error, QStringLiteral("不是 SignalGA 压缩文件: %1").arg(path));
+    }
+
+    const qint64 size = file.size();
+    blocks.clear();
+    if (loadSidecar(path, size, blocks)) {
+        if (validEnd) *validEnd = size;
+        return true;
+    }
+
+    const qint64 end = scanBlocks(file, FILE_HEADER_SIZE, size, &blocks);
+    if (validEnd) *validEnd = end;
+    return true;
+}
+
+qint64 scanBlocks(QFile& file, qint64 start, qint64 size, QVector<BlockInfo>* blocks) {
+    qint64 pos = start;
+    qint64 raw = 0;
+    while (pos + BLOCK_HEADER_SIZE <= size) {
+        char h[BLOCK_HEADER_SIZE];
+        if (!file.seek(pos) || file.read(h, BLOCK_HEADER_SIZE) != BLOCK_HEADER_SIZE) break;
+        BlockInfo b;
+        b.offset = pos;
+        b.rawOffset = raw;
+        b.rawSize = static_cast<int>(qFromLittleEndian<quint32>(h));
+        b.compressedSize = static_cast<int>(qFromLittleEndian<quint32>(h + 4) & ~PACKED_BLOCK_FLAG);
+        if (b.rawSize < 0 || b.compressedSize < 0 || pos + BLOCK_HEADER_SIZE + b.compressedSize > size) break;
+        if (blocks) blocks->append(b);
+        pos += BLOCK_HEADER_SIZE + b.compressedSize;
+        raw += b.rawSize;
+    }
+    return pos;
+}
+
+bool readBlock(QFile& file, const BlockInfo& block, QByteArray& raw, QString* error) {
+    // 连同块头一起读取：打包标志只记录在块头中
+    QByteArray data(BLOCK_HEADER_SIZE + block.compressedSize, Qt::Uninitialized);
+    if (!file.seek(block.offset) || file.read(data.data(), data.size()) != data.size()) {
+        return fail(error, QStringLiteral("读取失败: %1").arg(file.fileName()));
+    }
+    const quint32 payloadField = qFromLittleEndian<quint32>(data.constData() + 4);
+    const bool packed = (payloadField & PACKED_BLOCK_FLAG) != 0;
+    bool ok = qFromLittleEndian<quint32>(data.constData()) == static_cast<quint32>(block.rawSize)
+        && (payloadField & ~PACKED_BLOCK_FLAG) == static_cast<quint32>(block.compressedSize);
+    if (ok) {
+        const QByteArray payload = qUncompress(reinterpret_cast<const uchar*>(data.constData()) + BLOCK_HEADER_SIZE,
+                                               block.compressedSize);
+        if (packed) {
+            ok = unpackRecords(payload, block.rawSize, raw);
+        } else {
+            raw = payload;
+            ok = raw.size() == block.rawSize;
+        }
+    }
+    if (!ok) {
+        return fail(error, QStringLiteral("块数据损坏: %1 @ %2").arg(file.fileName()).arg(block.offset));
+    }
+    return true;
+}
+
+bool decompressFile(const QString& path, const QString& outPath, QString* error) {
+    QVector<BlockInfo> blocks;
+    qint64 validEnd = 0;
+    if (!loadIndex(path, blocks, &validEnd, error)) return false;
+
+    QFile in(path);
+    if (!in.open(QIODevice::ReadOnly)) {
+        return fail(error, QStringLiteral("无法打开文件: %1").arg(path));
+    }
+    QFile out(outPath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return fail(error, QStringLiteral("无法打开文件: %1").arg(outPath));
+    }
+    QByteArray raw;
+    for (const BlockInfo& b : blocks) {
+        if (!readBlock(in, b, raw, error)) return false;
+        if (out.write(raw) != raw.size()) {
+            return fail(error, QStringLiteral("写入失败: %1").arg(outPath));
+        }
+    }
+    if (validEnd != in.size()) {
+        return fail(error, QStringLiteral("文件末尾存在不完整块（%1 字节），已忽略").arg(in.size() - validEnd));
+    }
+    return true;
+}
+
+BlockCompressor::BlockCompressor(int blockBytes, int level)
+    : m_blockBytes(blockBytes < 4096 ? 4096 : blockBytes)
+    , m_level(level) {
+    m_pending.reserve(m_blockBytes);
+}
+
+bool BlockCompressor::begin(QFile& file, QString* error) {
+    m_blocks.clear();
+    m_pending.resize(0);
+    m_rawOffset = 0;
+
+    const qint64 size = file.size();
+    if (size == 0) {
+        QByteArray header(MAGIC, sizeof(MAGIC));
+        char b[8];
+        qToLittleEndian<quint32>(static_cast<quint32>(m_blockBytes), b);
+        qToLittleEndian<quint32>(0, b + 4);
+        header.append(b, 8);
+        if (file.write(header) != header.size()) {
+            return fail(error, QStringLiteral("写入失败: %1").arg(file.fileName()));
+        }
+        m_fileOffset = FILE_HEADER_SIZE;
+        return true;
+    }
+
+    // 追加到已有文件：续接块索引
+    qint64 validEnd = 0;
+    if (!loadIndex(file.fileName(), m_blocks, &validEnd, error)) return false;
+    if (validEnd != size) {
+        file.resize(validEnd);
+    }
+    m_fileOffset = validEnd;
+    if (!m_blocks.isEmpty()) {
+        m_rawOffset = m_blocks.last().rawOffset + m_blocks.last().rawSize;
+    }
+    return true;
+}
+
+void BlockCompressor::setRecordLayout(int headerSize, const QVector<BinaryFormat::ColumnType>& types) {
+    m_headerSize = headerSize;
+    m_types = types;
+    m_recordSize = recordSizeOf(types);
+}
+
+bool BlockCompressor::write(QFile& file, const QByteArray& data, bool endBlock) {
+    const char* p = data.constData();
+    int n = data.size();
+
+    // 先补满上次剩下的半块
+    if (!m_pending.isEmpty() && n > 0) {
+        const int take = qMin(n, m_blockBytes - m_pending.size());
+        m_pending.append(p, take);
+        p += take;
+        n -= take;
+        if (m_pending.size() == m_blockBytes) {
+            if (!writeBlock(file, m_pending.constData(), m_pending.size())) return false;
+            m_pending.resize(0);
+        }
+    }
+    // 整块直接从输入压缩，不经过中间拷贝
+    while (n >= m_blockBytes) {
+        if (!writeBlock(file, p, m_blockBytes)) return false;
+        p += m_blockBytes;
+        n -= m_blockBytes;
+    }
+    if (n > 0) m_pending.append(p, n);
+
+    if (endBlock && !m_pending.isEmpty()) {
+        if (!writeBlock(file, m_pending.constData(), m_pending.size())) return false;
+        m_pending.resize(0);
+    }
+    return true;
+}
+
+bool BlockCompressor::packRecords(const char* data, int size) {
+    if (m_recordSize == 0) return false;
+    // 块开头的文件头或上一块剩下的半条记录原样保存
+    qint64 prefix = 0;
+    if (m_rawOffset < m_headerSize) {
+        prefix = m_headerSize - m_rawOffset;
+    } else {
+        const qint64 r = (m_rawOffset - m_headerSize) % m_recordSize;
+        prefix = r == 0 ? 0 : m_recordSize - r;
+    }
+    if (prefix >= size) return false;
+    const int records = static_cast<int>((size - prefix) / m_recordSize);
+    if (records < 2) return false;
+
+    const char* rec = data + prefix;
+    char buf[4];
+    m_packed.resize(0);
+    qToLittleEndian<quint32>(static_cast<quint32>(prefix), buf);
+    m_packed.append(buf, 4);
+    qToLittleEndian<quint32>(static_cast<quint32>(records), buf);
+    m_packed.append(buf, 4);
+    qToLittleEndian<quint16>(static_cast<quint16>(m_types.size()), buf);
+    m_packed.append(buf, 2);
+    for (BinaryFormat::ColumnType t : m_types) m_packed.append(static_cast<char>(t));
+
+    int offset = 0;
+    for (BinaryFormat::ColumnType t : m_types) {
+        const int at = m_packed.size();
+        m_packed.append(5, '\0');
+        int bytes = 0;
+        if (t == BinaryFormat::ColumnType::Float64) {
+            // 浮点数的符号、指数与高位尾数变化缓慢，按字节平面排列后 zlib 才能发现重复
+            bytes = records * 8;
+            m_packed.resize(at + 5 + bytes);
+            char* dst = m_packed.data() + at + 5;
+            for (int b = 0; b < 8; ++b) {
+                for (int r = 0; r < records; ++r) *dst++ = rec[qint64(r) * m_recordSize + offset + b];
+            }
+        } else if (t == BinaryFormat::ColumnType::Int64) {
+            m_packed[at] = static_cast<char>(IntegerCodec::Mode::DeltaOfDeltaBitPacked);
+            m_int64.resize(records);
+            for (int r = 0; r < records; ++r) m_int64[r] = qFromLittleEndian<qint64>(rec + qint64(r) * m_recordSize + offset);
+            bytes = IntegerCodec::encode(m_int64.constData(), records, IntegerCodec::Mode::DeltaOfDeltaBitPacked, m_packed);
+        } else {
+            m_packed[at] = static_cast<char>(IntegerCodec::Mode::DeltaBitPacked);
+            m_int32.resize(records);
+            for (int r = 0; r < records; ++r) m_int32[r] = qFromLittleEndian<qint32>(rec + qint64(r) * m_recordSize + offset);
+            bytes = IntegerCodec::encode(m_int32.constData(), records, IntegerCodec::Mode::DeltaBitPacked, m_packed);
+        }
+        if (bytes < 0) return false;
+        qToLittleEndian<quint32>(static_cast<quint32>(bytes), m_packed.data() + at + 1);
+        offset += BinaryFormat::columnWidth(t);
+    }
+    m_packed.append(data, static_cast<int>(prefix));
+    const qint64 tail = prefix + qint64(records) * m_recordSize;
+    m_packed.append(data + tail, static_cast<int>(size - tail));
+    return true;
+}
+
+bool BlockCompressor::writeBlock(QFile& file, const char* data, int size) {
+    const bool packed = packRecords(data, size);
+    const QByteArray payload = packed
+        ? qCompress(reinterpret_cast<const uchar*>(m_packed.constData()), m_packed.size(), m_level)
+        : qCompress(reinterpret_cast<const uchar*>(data), size, m_level);
+    char h[BLOCK_HEADER_SIZE];
+    qToLittleEndian<quint32>(static_cast<quint32>(size), h);
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()) | (packed ? PACKED_BLOCK_FLAG : 0u), h + 4);
+    m_block.resize(0);
+    m_block.append(h, BLOCK_HEADER_SIZE);
+    m_block.append(payload);
+    if (file.write(m_block) != m_block.size()) return false;
+
+    BlockInfo b;
+    b.offset = m_fileOffset;
+    b.rawOffset = m_rawOffset;
+    b.rawSize = size;
+    b.compressedSize = payload.size();
+    m_blocks.append(b);
+    m_fileOffset += m_block.size();
+    m_rawOffset += size;
+    return true;
+}
+
+bool BlockCompressor::writeIndex(const QString& path) const {
+    QFile idx(indexPath(path));
+    if (!idx.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    QByteArray text("block,offset,raw_offset,raw_size,compressed_size\n");
+    for (int i = 0; i < m_blocks.size(); ++i) {
+        const BlockInfo& b = m_blocks[i];
+        CsvFormat::appendInt(text, i);
+        text.append(',');
+        CsvFormat::appendInt(text, b.offset);
+        text.append(',');
+        CsvFormat::appendInt(text, b.rawOffset);
+        text.append(',');
+        CsvFormat::appendInt(text, b.rawSize);
+        text.append(',');
+        CsvFormat::appendInt(text, b.compressedSize);
+        text.append('\n');
+    }
+    return idx.write(text) == text.size();
+}
+
+} // namespace BlockCompression
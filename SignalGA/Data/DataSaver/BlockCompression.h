@@ -0,0 +1,94 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+#include "BinaryFormat.h"
+
+// BlockCompression: DataSaver 压缩输出（<文件名>.sgz）的分块格式
+//
+// 原始数据按固定大小（blockBytes，刷新/关闭时的最后一块可能更小）切块，每块独立用 zlib 压缩，
+// 读取方可只解压需要的块。所有整数均为小端序。
+//   文件头：char[8] magic "SGAZBLK1"，u32 blockBytes，u32 reserved
+//   块：    u32 rawSize，u32 payloadSize，payload[payloadSize]（qCompress 输出）
+// payloadSize 最高位（PACKED_BLOCK_FLAG）为 1 表示二进制记录块在压缩前按列打包（见 BlockCompressor::setRecordLayout），
+// 解压后的内容为：
+//   u32 prefixBytes，u32 recordCount，u16 columnCount，u8 type × columnCount（BinaryFormat::ColumnType）
+//   列 × columnCount：u8 encoding，u32 bytes，data[bytes]
+//     encoding 0：字节平面（Float64，先存所有记录的第 0 字节，再第 1 字节……）
+//     其他：IntegerCodec::Mode（Int32 原始计数用 DeltaBitPacked，Int64 时间戳用 DeltaOfDeltaBitPacked）
+//   prefix[prefixBytes]（块开头不足一条记录的部分，含文件头），其后为块末尾不足一条记录的部分
+// readBlock 还原为原始字节，读取方无需区分。
+// 块索引写在旁路文件 <文件名>.sgz.idx（CSV：block,offset,raw_offset,raw_size,compressed_size），
+// 在文件关闭时生成；索引缺失或与文件不一致时（例如异常退出）读取方顺序扫描块头重建索引。
+namespace BlockCompression {
+
+const char MAGIC[8] = { 'S', 'G', 'A', 'Z', 'B', 'L', 'K', '1' };
+const int FILE_HEADER_SIZE = 16;
+const int BLOCK_HEADER_SIZE = 8;
+const char FILE_SUFFIX[] = "sgz";
+const quint32 PACKED_BLOCK_FLAG = 0x80000000u;
+
+struct BlockInfo {
+    qint64 offset { 0 };        // 块头在文件中的偏移
+    qint64 rawOffset { 0 };     // 块内数据在原始数据流中的偏移
+    int rawSize { 0 };
+    int compressedSize { 0 };   // payload 字节数（不含块头与打包标志位）
+};
+
+QString indexPath(const QString& path);
+
+// 读取块索引：优先使用旁路索引，无效时扫描文件。scan 结束位置之后的不完整块被忽略，
+// validEnd 返回最后一个完整块的结束偏移。
+bool loadIndex(const QString& path, QVector<BlockInfo>& blocks, qint64* validEnd = nullptr, QString* error = nullptr);
+
+// 从 start（块边界）起顺序扫描块头直到 size，完整的块追加到 blocks（可为空，rawOffset 从 0 起算），
+// 返回最后一个完整块的结束偏移。块头中的打包标志位不计入长度
+qint64 scanBlocks(QFile& file, qint64 start, qint64 size, QVector<BlockInfo>* blocks = nullptr);
+
+// 解压单个块（按列打包的块同时还原为原始记录）
+bool readBlock(QFile& file, const BlockInfo& block, QByteArray& raw, QString* error = nullptr);
+
+// 整个文件解压到 outPath
+bool decompressFile(const QString& path, const QString& outPath, QString* error = nullptr);
+
+// 写入侧：在写盘线程中累积原始数据，满一块即压缩写出。
+// 同一时刻只能被一个线程使用（DataSaver 保证：写盘线程空闲后才在调用线程上 begin/writeIndex）。
+class BlockCompressor {
+public:
+    BlockCompressor(int blockBytes, int level);
+
+    // file 已以追加方式打开。新文件写文件头；已有文件读取块索引，并截掉异常中断留下的不完整块
+    bool begin(QFile& file, QString* error = nullptr);
+    // 二进制记录流：之后写出的块按列打包再压缩。headerSize 为原始数据流开头的文件头字节数，
+    // 用于确定块内记录边界（边界不符时仍能无损还原，只是压缩率下降）。与 write 在同一线程或写盘线程空闲时调用
+    void setRecordLayout(int headerSize, const QVector<BinaryFormat::ColumnType>& types);
+    // 追加原始数据；endBlock 为 true 时把不足一块的剩余数据也压缩写出（刷新/关闭时使用）
+    bool write(QFile& file, const QByteArray& data, bool endBlock);
+    // 把块索引写到旁路文件
+    bool writeIndex(const QString& path) const;
+
+    qint64 rawBytes() const { return m_rawOffset + m_pending.size(); }
+
+private:
+    bool writeBlock(QFile& file, const char* data, int size);
+    bool packRecords(const char* data, int size);
+
+    const int m_blockBytes;
+    const int m_level;
+    QByteArray m_pending;           // 未满一块的原始数据
+    QByteArray m_block;             // 块头 + 压缩数据，复用
+    QByteArray m_packed;            // 按列打包后的块，复用
+    QVector<qint64> m_int64;        // 打包时取出的单列数据，复用
+    QVector<qint32> m_int32;
+    QVector<BinaryFormat::ColumnType> m_types; // 为空时不打包
+    int m_headerSize { 0 };
+    int m_recordSize { 0 };
+    QVector<BlockInfo> m_blocks;
+    qint64 m_fileOffset { 0 };
+    qint64 m_rawOffset { 0 };
+};
+
+} // namespace BlockCompression
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <charconv>
+#include <cstdio>
+
+// CsvFormat: 直接向字节缓冲区追加 CSV 字段，不经过 QString 临时对象与 UTF-16→UTF-8 转换。
+// 数值字段不含逗号、引号与换行，无需转义。
+namespace CsvFormat {
+
+// 十进制整数
+inline void appendInt(QByteArray& out, qint64 v) {
+    char buf[24];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, static_cast<int>(r.ptr - buf));
+}
+
+// 浮点数：precision >= 0 为定点 precision 位小数（同 QString::number(v, 'f', precision)）；
+// precision < 0 为能精确还原该值的最短表示
+inline void appendDouble(QByteArray& out, double v, int precision) {
+    char buf[512];
+    if (precision > 100) precision = 100;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    const auto r = precision < 0
+        ? std::to_chars(buf, buf + sizeof(buf), v)
+        : std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::fixed, precision);
+    if (r.ec == std::errc()) {
+        out.append(buf, static_cast<int>(r.ptr - buf));
+        return;
+    }
+#endif
+    // 标准库未提供浮点 to_chars 时退回 snprintf
+    const int n = precision < 0
+        ? std::snprintf(buf, sizeof(buf), "%.17g", v)
+        : std::snprintf(buf, sizeof(buf), "%.*f", precision, v);
+    if (n > 0) out.append(buf, n < static_cast<int>(sizeof(buf)) ? n : static_cast<int>(sizeof(buf)) - 1);
+}
+
+// 文本字段（RFC4180）：仅当包含逗号、引号或换行时用双引号包裹，并将内部引号翻倍
+inline void appendField(QByteArray& out, const QByteArray& field) {
+    const char* p = field.constData();
+    const int n = field.size();
+    int i = 0;
+    while (i < n && p[i] != ',' && p[i] != '"' && p[i] != '\n' && p[i] != '\r') ++i;
+    if (i == n) {
+        out.append(field);
+        return;
+    }
+    out.append('"');
+    out.append(p, i);
+    for (; i < n; ++i) {
+        if (p[i] == '"') out.append('"');
+        out.append(p[i]);
+    }
+    out.append('"');
+}
+
+inline void appendField(QByteArray& out, const QString& field) {
+    appendField(out, field.toUtf8());
+}
+
+} // namespace CsvFormat
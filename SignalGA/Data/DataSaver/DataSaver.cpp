@@ -1,6 +1,26 @@
 #include "DataSaver.h"
+#include "AsyncFileWriter.h"
+#include "CsvFormat.h"
+#include "WriteBatch.h"
+
+#include <QBuffer>
 
 #include <QFileInfo>
+#include <QDebug>
+#include <QDateTime>
+#include <QTimer>
+#include <QVarLengthArray>
+#include <type_traits>
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#elif defined(Q_OS_WIN)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h>
+#include <windows.h>
+#endif
 
 static QString makeKey(const QString& kind, const QString& group) {
     return kind + "|" + group;
@@ -13,159 +33,947 @@ DataSaver::DataSaver(QObject* parent)
 
 DataSaver::~DataSaver() {
     closeAll();
+    if (m_writer) {
+        m_writer->shutdown();
+    }
+}
+
+void DataSaver::setAsyncWrite(bool enabled, int maxInflightBuffers) {
+    // 切换前把已有数据全部写出，保证顺序
+    flushAll();
+    if (m_writer) {
+        m_writer->shutdown();
+        delete m_writer;
+        m_writer = nullptr;
+    }
+    // 收尾任务均已完成，序号随写盘线程作废
+    for (OutputFile* out : m_streams) {
+        if (out) out->closeTask = 0;
+    }
+    if (enabled) {
+        m_writer = new AsyncFileWriter(maxInflightBuffers, this);
+        connect(m_writer, &AsyncFileWriter::writeFailed, this, &DataSaver::errorOccurred);
+        if (m_ioBackend != IoBackend::QFile) {
+            m_writer->setWriteBatch(new WriteBatch(m_ioBackend == IoBackend::Uring, m_directIo));
+        }
+        m_writer->start();
+    }
+}
+
+bool DataSaver::isAsyncWrite() const {
+    return m_writer != nullptr;
+}
+
+void DataSaver::setIoBackend(IoBackend backend, bool direct) {
+    m_ioBackend = backend;
+    m_directIo = direct;
+    // 后端属于写盘线程，重建写盘线程使其生效
+    if (m_writer || backend != IoBackend::QFile) {
+        setAsyncWrite(true, m_writer ? m_writer->maxInflightBuffers() : 8);
+    }
+}
+
+DataSaver::IoBackend DataSaver::ioBackend() const {
+    const WriteBatch* batch = m_writer ? m_writer->writeBatch() : nullptr;
+    if (!batch) return IoBackend::QFile;
+    switch (batch->backend()) {
+    case WriteBatch::Backend::Uring: return IoBackend::Uring;
+    case WriteBatch::Backend::Pwrite: return IoBackend::Pwrite;
+    case WriteBatch::Backend::QFile: break;
+    }
+    return IoBackend::QFile;
+}
+
+void DataSaver::appendLine(OutputFile* out, const QString& line) {
+    out->buffer.append(line.toUtf8());
+    out->buffer.append('\n');
+    maybeCommit(out);
+}
+
+void DataSaver::maybeCommit(OutputFile* out) {
+    if (m_autoFlush || out->buffer.size() >= m_bufferLimitBytes) {
+        commit(out);
+    }
+}
+
+char* DataSaver::appendRecords(OutputFile* out, int columnCount, int count, BinaryFormat::ColumnType inferredType) {
+    if (out->schema.columns.isEmpty()) {
+        // 未声明列：按第一次写入推断，列名为 c0, c1, ...
+        for (int i = 0; i < columnCount; ++i) {
+            BinaryFormat::Column c;
+            c.name = QStringLiteral("c%1").arg(i);
+            c.type = inferredType;
+            out->schema.columns.append(c);
+        }
+        out->recordSize = out->schema.recordSize();
+        applyRecordLayout(out); // 该流此前没有写出过数据，写盘线程不会同时使用压缩器
+    }
+    if (columnCount != out->schema.columns.size()) {
+        emit errorOccurred(QStringLiteral("列数不匹配: %1 (期望 %2，实际 %3)")
+                               .arg(out->file->fileName())
+                               .arg(out->schema.columns.size())
+                               .arg(columnCount));
+        return nullptr;
+    }
+    if (!out->wroteHeader) {
+        out->buffer.append(BinaryFormat::encodeHeader(out->schema));
+        out->wroteHeader = true;
+    }
+    const int offset = out->buffer.size();
+    out->buffer.resize(offset + out->recordSize * count);
+    return out->buffer.data() + offset;
+}
+
+bool DataSaver::appendTextRecord(OutputFile* out, const QStringList& fields) {
+    char* rec = appendRecords(out, fields.size(), 1, BinaryFormat::ColumnType::Float64);
+    if (!rec) return false;
+    for (int i = 0; i < fields.size(); ++i) {
+        const BinaryFormat::ColumnType type = out->schema.columns[i].type;
+        if (type == BinaryFormat::ColumnType::Float64) {
+            BinaryFormat::putDouble(rec, type, fields[i].trimmed().toDouble());
+        } else {
+            BinaryFormat::putInt(rec, type, fields[i].trimmed().toLongLong());
+        }
+        rec += BinaryFormat::columnWidth(type);
+    }
+    return true;
+}
+
+void DataSaver::commit(OutputFile* out, bool endBlock) {
+    if (out->buffer.isEmpty()) {
+        // 压缩文件刷新时仍需把未满一块的数据写出
+        if (out->compressor && endBlock) writeOut(out, out->buffer, true);
+        return;
+    }
+    // 分段：当前段已满时先切换到新段，本次数据写入新段开头（总在整行边界上）
+    if (out->segment >= 0 && segmentFull(out)) {
+        rotateSegment(out);
+    }
+    out->segmentBytes += out->buffer.size();
+    writeOut(out, out->buffer, endBlock);
+    // 写入线程没有事件循环时定时器不会触发，在这里补做到期的组提交
+    if (m_maxLossMs > 0 && m_sinceSync.elapsed() >= m_maxLossMs / 2) {
+        syncAll();
+    }
+}
+
+void DataSaver::writeOut(OutputFile* out, QByteArray& data, bool endBlock) {
+    out->dirty = true;
+    if (m_writer) {
+        // 异步：整块交换给写盘线程（压缩也在该线程），本地换回一块空缓冲继续填充
+        m_writer->submit(out->file.get(), data, out->compressor.get(), endBlock);
+        return;
+    }
+    const bool ok = out->compressor
+        ? out->compressor->write(*out->file, data, endBlock)
+        : out->file->write(data) == data.size();
+    if (!ok) {
+        emit errorOccurred(QStringLiteral("写入失败: %1 (%2)").arg(out->file->fileName(), out->file->errorString()));
+    }
+    out->file->flush();
+    data.resize(0); // 保留容量
+}
+
+void DataSaver::setCompression(bool enabled, int level, int blockBytes) {
+    m_compression = enabled;
+    m_compressionLevel = level < 0 ? -1 : (level > 9 ? 9 : level);
+    m_compressionBlockBytes = blockBytes;
+    // 压缩放在写盘线程，生产者只做内存拷贝
+    if (enabled && !m_writer) setAsyncWrite(true);
+}
+
+void DataSaver::setDurability(int maxLossMs, bool checkpoints) {
+    m_maxLossMs = maxLossMs > 0 ? maxLossMs : 0;
+    m_checkpoints = checkpoints;
+    if (!m_syncTimer) {
+        m_syncTimer = new QTimer(this);
+        connect(m_syncTimer, &QTimer::timeout, this, &DataSaver::syncAll);
+    }
+    if (m_maxLossMs > 0) {
+        // 每半个窗口提交一次：数据在缓冲区最多停留半个窗口，另一半留给写出与同步
+        m_syncTimer->start(qMax(1, m_maxLossMs / 2));
+        m_sinceSync.start();
+    } else {
+        m_syncTimer->stop();
+    }
+}
+
+void DataSaver::syncAll() {
+    m_sinceSync.restart();
+    QVector<Durability::SyncTarget> targets;
+    for (auto it = m_files.begin(); it != m_files.end(); ++it) {
+        OutputFile* out = it.value();
+        if (!out || !out->file->isOpen()) continue;
+        commit(out, true);
+        if (!out->dirty) continue;
+        out->dirty = false;
+        targets.append(syncTarget(out));
+    }
+    if (targets.isEmpty()) return;
+    if (m_writer) {
+        // 排在已提交的数据之后，由写盘线程同步，写入方不阻塞
+        m_writer->submitSync(targets);
+        return;
+    }
+    QString error;
+    if (!Durability::commitGroup(targets, &error)) {
+        emit errorOccurred(error);
+    }
+}
+
+Durability::SyncTarget DataSaver::syncTarget(OutputFile* out) {
+    Durability::SyncTarget target;
+    target.file = out->file.get();
+    if (!m_checkpoints) return target;
+    if (!out->checkpoint->isOpen()) {
+        out->checkpoint->setFileName(Durability::checkpointPath(out->file->fileName()));
+        if (!out->checkpoint->open(QIODevice::WriteOnly | QIODevice::Append)) {
+            emit errorOccurred(QStringLiteral("无法打开文件: %1").arg(out->checkpoint->fileName()));
+            return target;
+        }
+    }
+    target.checkpoint = out->checkpoint.get();
+    return target;
+}
+
+void DataSaver::setDecimation(const QVector<int>& factors, const QString& partitionColumn) {
+    if (!factors.isEmpty() && !Decimation::validFactors(factors)) {
+        emit errorOccurred(QStringLiteral("降采样倍数无效（须递增且每级为上一级的整数倍）"));
+        return;
+    }
+    m_decimationFactors = factors;
+    m_decimationPartition = partitionColumn;
+}
+
+void DataSaver::decimate(OutputFile* out, const double* row, int columnCount) {
+    if (out->decimationFactors.isEmpty()) return;
+    if (!out->decimation) {
+        // 列数在第一次写入时才确定；列名取表头/列定义，缺失时为 c0, c1, ...
+        QStringList names = out->columnNames;
+        if (out->binary) {
+            names.clear();
+            for (const BinaryFormat::Column& c : out->schema.columns) names.append(c.name);
+        }
+        if (names.size() != columnCount) {
+            names.clear();
+            for (int i = 0; i < columnCount; ++i) names.append(QStringLiteral("c%1").arg(i));
+        }
+        const QString base = QString("%1/%2/%3").arg(m_baseDir, out->kind, out->group);
+        const QString source = QFileInfo(filePath(out->kind, out->group, out->suffix)).fileName();
+        out->decimation.reset(new Decimation::Writer(base, source, out->decimationFactors, names, out->decimationPartition));
+    }
+    if (columnCount != out->decimation->columnCount()) return; // 列数不符的行不计入
+    if (!out->decimation->add(row)) {
+        // Writer 记住失败的分区并跳过其后的行，每个分区只报告一次
+        emit errorOccurred(out->decimation->errorString());
+    }
+}
+
+template <typename T>
+void DataSaver::decimate(OutputFile* out, const T* row, int columnCount) {
+    if (out->decimationFactors.isEmpty()) return;
+    QVarLengthArray<double, 16> values(columnCount);
+    for (int i = 0; i < columnCount; ++i) values[i] = static_cast<double>(row[i]);
+    decimate(out, values.constData(), columnCount);
+}
+
+void DataSaver::decimateText(OutputFile* out, const char* p, const char* end) {
+    if (out->decimationFactors.isEmpty()) return;
+    QVarLengthArray<double, 16> values;
+    while (p < end) {
+        values.clear();
+        bool ok = true;
+        for (;;) {
+            const char* field = p;
+            while (p < end && *p != ',' && *p != '\n') ++p;
+            bool fieldOk = false;
+            const double v = QByteArray::fromRawData(field, static_cast<int>(p - field)).toDouble(&fieldOk);
+            ok = ok && fieldOk;
+            values.append(v);
+            if (p >= end || *p == '\n') break;
+            ++p; // ','
+        }
+        if (p < end) ++p; // '\n'
+        if (ok) decimate(out, values.constData(), values.size());
+    }
+}
+
+void DataSaver::closeDecimation(OutputFile* out) {
+    if (out->decimation && !out->decimation->close()) {
+        emit errorOccurred(out->decimation->errorString());
+    }
+    out->decimation.reset();
+}
+
+void DataSaver::setSegmentLimits(qint64 maxBytes, int maxSeconds) {
+    m_segmentMaxBytes = maxBytes > 0 ? maxBytes : 0;
+    m_segmentMaxSeconds = maxSeconds > 0 ? maxSeconds : 0;
+}
+
+void DataSaver::setSegmentPreallocateBytes(qint64 bytes) {
+    m_preallocateBytes = bytes > 0 ? bytes : 0;
+}
+
+bool DataSaver::segmentationEnabled() const {
+    return m_segmentMaxBytes > 0 || m_segmentMaxSeconds > 0;
+}
+
+QString DataSaver::segmentPath(const QString& kind, const QString& group, int segment, const QString& suffix) const {
+    return QString("%1/%2/%3.%4.%5").arg(m_baseDir, kind, group, QString::number(segment).rightJustified(6, '0'), suffix);
+}
+
+QString DataSaver::segmentIndexPath(const QString& kind, const QString& group) const {
+    return QString("%1/%2/%3.segments.csv").arg(m_baseDir, kind, group);
+}
+
+int DataSaver::nextSegment(const QString& kind, const QString& group, const QString& suffix) const {
+    // 从已有分段之后继续编号，不覆盖也不追加到旧分段
+    const QDir dir(QString("%1/%2").arg(m_baseDir, kind));
+    const QStringList names = dir.entryList(QStringList() << QString("%1.*.%2").arg(group, suffix), QDir::Files);
+    int next = 0;
+    for (const QString& name : names) {
+        const QString middle = name.mid(group.size() + 1, name.size() - group.size() - suffix.size() - 2);
+        bool ok = false;
+        const int n = middle.toInt(&ok);
+        if (ok && n >= next) next = n + 1;
+    }
+    return next;
+}
+
+bool DataSaver::segmentFull(const OutputFile* out) const {
+    if (out->segmentBytes == 0) return false;
+    if (m_segmentMaxBytes > 0 && out->segmentBytes >= m_segmentMaxBytes) return true;
+    return m_segmentMaxSeconds > 0
+        && QDateTime::currentMSecsSinceEpoch() * 1000 - out->segmentStartUs >= qint64(m_segmentMaxSeconds) * 1000000;
+}
+
+void DataSaver::beginSegment(OutputFile* out) {
+    out->segmentBytes = 0;
+    out->segmentStartUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    out->preallocated = out->segment >= 0 && m_preallocateBytes > 0 && preallocate(*out->file, m_preallocateBytes);
+    if (out->compressed) {
+        // 每个文件独立的块序列与索引；文件头在此直接写入（写盘线程此时没有该文件的任务）
+        out->compressor.reset(new BlockCompression::BlockCompressor(m_compressionBlockBytes, m_compressionLevel));
+        QString error;
+        if (!out->compressor->begin(*out->file, &error)) {
+            emit errorOccurred(QStringLiteral("无法写入压缩文件: %1 (%2)").arg(out->file->fileName(), error));
+        }
+        applyRecordLayout(out);
+    }
+}
+
+void DataSaver::applyRecordLayout(OutputFile* out) {
+    if (!out->compressor || !out->binary || out->schema.columns.isEmpty()) return;
+    QVector<BinaryFormat::ColumnType> types;
+    for (const BinaryFormat::Column& c : out->schema.columns) types.append(c.type);
+    out->compressor->setRecordLayout(BinaryFormat::encodeHeader(out->schema).size(), types);
+}
+
+struct DataSaver::RetiredFile {
+    std::unique_ptr<QFile> file;
+    std::unique_ptr<QFile> checkpoint;
+    std::unique_ptr<BlockCompression::BlockCompressor> compressor;
+    bool preallocated { false };
+    Durability::SyncTarget sync;    // file 非空时收尾前最后同步一次
+    // 分段索引的一行，segment < 0 时不写
+    int segment { -1 };
+    qint64 segmentStartUs { 0 };
+    qint64 segmentEndUs { 0 };
+    QString indexPath;
+};
+
+QString DataSaver::finishRetired(RetiredFile& r) {
+    QStringList errors;
+    if (r.compressor && !r.compressor->writeIndex(r.file->fileName())) {
+        errors.append(QStringLiteral("无法写入块索引: %1").arg(BlockCompression::indexPath(r.file->fileName())));
+    }
+    // 在途数据已写完；预分配的多余空间截掉，文件长度即实际数据长度
+    const qint64 size = r.file->size();
+    if (r.preallocated) r.file->resize(size);
+
+    if (r.segment >= 0) {
+        QFile index(r.indexPath);
+        const bool isNew = !index.exists() || index.size() == 0;
+        if (index.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            QByteArray line;
+            if (isNew) line.append("segment,file,start_us,end_us,bytes\n");
+            CsvFormat::appendInt(line, r.segment);
+            line.append(',');
+            CsvFormat::appendField(line, QFileInfo(r.file->fileName()).fileName());
+            line.append(',');
+            CsvFormat::appendInt(line, r.segmentStartUs);
+            line.append(',');
+            CsvFormat::appendInt(line, r.segmentEndUs);
+            line.append(',');
+            CsvFormat::appendInt(line, size);
+            line.append('\n');
+            index.write(line);
+        } else {
+            errors.append(QStringLiteral("无法打开文件: %1").arg(index.fileName()));
+        }
+    }
+
+    if (r.sync.file) {
+        // 关闭前最后同步一次，检查点覆盖文件全部内容
+        QString error;
+        if (!Durability::commitGroup(QVector<Durability::SyncTarget>() << r.sync, &error)) {
+            errors.append(error);
+        }
+    }
+    r.checkpoint->close();
+    r.file->close();
+    return errors.join(QStringLiteral("; "));
+}
+
+std::shared_ptr<DataSaver::RetiredFile> DataSaver::retireFile(OutputFile* out, bool endSegment) {
+    std::shared_ptr<RetiredFile> retired(new RetiredFile);
+    if (m_maxLossMs > 0 && out->file->isOpen() && (out->dirty || endSegment)) {
+        retired->sync = syncTarget(out);
+    }
+    out->dirty = false;
+    if (endSegment && out->segment >= 0) {
+        retired->segment = out->segment;
+        retired->segmentStartUs = out->segmentStartUs;
+        retired->segmentEndUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+        retired->indexPath = segmentIndexPath(out->kind, out->group);
+    }
+    retired->preallocated = out->preallocated;
+    out->preallocated = false;
+    retired->compressor = std::move(out->compressor);
+    retired->checkpoint = std::move(out->checkpoint);
+    out->checkpoint.reset(new QFile());
+    retired->file = std::move(out->file);
+    out->file.reset(new QFile(retired->file->fileName()));
+    return retired;
+}
+
+void DataSaver::finishFile(OutputFile* out) {
+    const QString error = finishRetired(*retireFile(out, true));
+    if (!error.isEmpty()) {
+        emit errorOccurred(error);
+    }
+}
+
+quint64 DataSaver::finishInBackground(const std::shared_ptr<RetiredFile>& retired) {
+    if (m_writer) {
+        return m_writer->submitTask([retired]() { return finishRetired(*retired); });
+    }
+    const QString error = finishRetired(*retired);
+    if (!error.isEmpty()) {
+        emit errorOccurred(error);
+    }
+    return 0;
+}
+
+void DataSaver::rotateSegment(OutputFile* out) {
+    if (out->compressor) {
+        // 旧段的剩余数据先压缩写完
+        QByteArray none;
+        writeOut(out, none, true);
+    }
+    // 旧段的收尾与关闭交给写盘线程，排在其已提交的数据之后；本线程不等待，直接打开新段继续写入
+    const QString oldPath = out->file->fileName();
+    finishInBackground(retireFile(out, true));
+    emit fileClosed(oldPath);
+
+    ++out->segment;
+    const QString path = segmentPath(out->kind, out->group, out->segment, out->suffix);
+    out->file->setFileName(path);
+    if (!out->file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        emit errorOccurred(QStringLiteral("无法打开文件: %1").arg(path));
+        return;
+    }
+    beginSegment(out);
+    emit fileOpened(path);
+
+    // 每段都是完整文件：重复表头
+    if (out->binary) {
+        out->buffer.prepend(BinaryFormat::encodeHeader(out->schema));
+    } else if (!out->header.isEmpty()) {
+        out->buffer.prepend(out->header);
+    }
+}
+
+bool DataSaver::preallocate(QFile& file, qint64 bytes) {
+    // 只分配磁盘空间、不改变文件长度，追加写仍从实际末尾开始
+#if defined(Q_OS_LINUX)
+    return ::fallocate(file.handle(), FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(bytes)) == 0;
+#elif defined(Q_OS_WIN)
+    FILE_ALLOCATION_INFO info;
+    info.AllocationSize.QuadPart = bytes;
+    const HANDLE h = reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()));
+    return h != INVALID_HANDLE_VALUE && SetFileInformationByHandle(h, FileAllocationInfo, &info, sizeof(info));
+#else
+    Q_UNUSED(file);
+    Q_UNUSED(bytes);
+    return false;
+#endif
 }
 
 void DataSaver::setBaseDir(const QString& baseDir) {
     m_baseDir = baseDir;
 }
 
-QString DataSaver::csvPath(const QString& kind, const QString& group) const {
-    return QString("%1/%2/%3.csv").arg(m_baseDir, kind, group);
+void DataSaver::setFormat(Format format) {
+    m_format = format;
+}
+
+void DataSaver::setTimestampEpochUs(qint64 epochUs) {
+    m_epochUs = epochUs;
+}
+
+QString DataSaver::filePath(const QString& kind, const QString& group, const QString& suffix) const {
+    return QString("%1/%2/%3.%4").arg(m_baseDir, kind, group, suffix);
+}
+
+QString DataSaver::fileSuffix(const QString& base) const {
+    return m_compression ? base + '.' + QString::fromLatin1(BlockCompression::FILE_SUFFIX) : base;
 }
 
 bool DataSaver::ensureCsv(const QString& kind, const QString& group, const QStringList& header) {
+    return openStream(kind, group, header) != InvalidStream;
+}
+
+DataSaver::StreamId DataSaver::openStream(const QString& kind, const QString& group, const QStringList& header) {
     const QString key = makeKey(kind, group);
-    if (m_files.contains(key)) {
-        return true;
+    if (OutputFile* opened = m_files.value(key, nullptr)) {
+        return opened->id;
+    }
+    if (m_format == Format::Binary) {
+        QVector<BinaryFormat::Column> columns;
+        columns.reserve(header.size());
+        for (const auto& h : header) {
+            BinaryFormat::Column c;
+            c.name = h;
+            columns.append(c);
+        }
+        return openBinaryStream(kind, group, columns);
     }
 
-    const QString path = csvPath(kind, group);
+    const QString suffix = fileSuffix(QStringLiteral("csv"));
+    const int segment = segmentationEnabled() ? nextSegment(kind, group, suffix) : -1;
+    const QString path = segment >= 0 ? segmentPath(kind, group, segment, suffix) : filePath(kind, group, suffix);
     QFileInfo info(path);
     QDir dir = info.dir();
     if (!dir.exists() && !dir.mkpath(".")) {
         emit errorOccurred(QStringLiteral("无法创建目录: %1").arg(dir.absolutePath()));
-        return false;
+        return InvalidStream;
     }
 
-    CsvFile* csv = new CsvFile();
-    csv->file.setFileName(path);
+    OutputFile* out = new OutputFile();
+    out->file->setFileName(path);
+    out->kind = kind;
+    out->group = group;
+    out->suffix = suffix;
+    out->segment = segment;
+    out->compressed = m_compression;
+    out->decimationFactors = m_decimationFactors;
+    out->decimationPartition = m_decimationPartition;
     const bool isNew = !info.exists() || info.size() == 0;
-    if (!csv->file.open(QIODevice::WriteOnly | QIODevice::Append)) {
-        delete csv;
+    reserveOpenSlot();
+    if (!out->file->open(QIODevice::WriteOnly | QIODevice::Append)) {
+        delete out;
         emit errorOccurred(QStringLiteral("无法打开文件: %1").arg(path));
-        return false;
+        return InvalidStream;
     }
 
-    m_files.insert(key, csv);
+    const StreamId id = addStream(key, out);
+    beginSegment(out);
     emit fileOpened(path);
 
+    if (!header.isEmpty()) {
+        // 表头另存一份，分段时在每个新文件开头重复
+        out->columnNames = header;
+        for (int i = 0; i < header.size(); ++i) {
+            if (i) out->header.append(',');
+            CsvFormat::appendField(out->header, header[i]);
+        }
+        out->header.append('\n');
+    }
     if (isNew && !header.isEmpty()) {
-        // 写表头
-        QStringList escaped;
-        escaped.reserve(header.size());
-        for (const auto& h : header) escaped << escapeCsv(h);
-    csv->stream << escaped.join(',') << '\n';
-    // 不立即 flush，减少 IO 次数
-    csv->pendingBytes += escaped.join(',').size() + 1; // 估计字节数（UTF-16->UTF-8 差异忽略，对阈值控制足够）
-        csv->wroteHeader = true;
+        // 写表头（不立即写出，减少 IO 次数）
+        out->buffer.append(out->header);
+        out->wroteHeader = true;
+    }
+
+    return id;
+}
+
+bool DataSaver::ensureBinary(const QString& kind, const QString& group,
+                             const QVector<BinaryFormat::Column>& columns,
+                             const QVector<QPair<QString, QString>>& metadata) {
+    return openBinaryStream(kind, group, columns, metadata) != InvalidStream;
+}
+
+DataSaver::StreamId DataSaver::openBinaryStream(const QString& kind, const QString& group,
+                                               const QVector<BinaryFormat::Column>& columns,
+                                               const QVector<QPair<QString, QString>>& metadata) {
+    const QString key = makeKey(kind, group);
+    if (OutputFile* opened = m_files.value(key, nullptr)) {
+        return opened->id;
+    }
+
+    const QString suffix = fileSuffix(QString::fromLatin1(BinaryFormat::FILE_SUFFIX));
+    const int segment = segmentationEnabled() ? nextSegment(kind, group, suffix) : -1;
+    const QString path = segment >= 0 ? segmentPath(kind, group, segment, suffix) : filePath(kind, group, suffix);
+    QFileInfo info(path);
+    QDir dir = info.dir();
+    if (!dir.exists() && !dir.mkpath(".")) {
+        emit errorOccurred(QStringLiteral("无法创建目录: %1").arg(dir.absolutePath()));
+        return InvalidStream;
+    }
+
+    OutputFile* out = new OutputFile();
+    out->binary = true;
+    out->file->setFileName(path);
+    out->kind = kind;
+    out->group = group;
+    out->suffix = suffix;
+    out->segment = segment;
+    out->compressed = m_compression;
+    out->decimationFactors = m_decimationFactors;
+    out->decimationPartition = m_decimationPartition;
+
+    if (info.exists() && info.size() > 0) {
+        // 追加到已有文件：沿用其文件头，并校验列定义
+        QFile existing(path);
+        QString error;
+        bool ok = existing.open(QIODevice::ReadOnly);
+        if (ok && out->compressed) {
+            // 压缩文件：文件头位于第一块原始数据的开头
+            QVector<BlockCompression::BlockInfo> blocks;
+            QByteArray first;
+            ok = BlockCompression::loadIndex(path, blocks, nullptr, &error) && !blocks.isEmpty()
+                && BlockCompression::readBlock(existing, blocks.first(), first, &error);
+            QBuffer raw(&first);
+            ok = ok && raw.open(QIODevice::ReadOnly) && BinaryFormat::readHeader(raw, out->schema, &error);
+        } else if (ok) {
+            ok = BinaryFormat::readHeader(existing, out->schema, &error);
+        }
+        if (!ok) {
+            delete out;
+            emit errorOccurred(QStringLiteral("无法追加到二进制文件: %1 (%2)").arg(path, error));
+            return InvalidStream;
+        }
+        bool same = columns.isEmpty() || columns.size() == out->schema.columns.size();
+        for (int i = 0; same && i < columns.size(); ++i) {
+            same = columns[i].name == out->schema.columns[i].name && columns[i].type == out->schema.columns[i].type;
+        }
+        if (!same) {
+            delete out;
+            emit errorOccurred(QStringLiteral("列定义与已有文件不一致: %1").arg(path));
+            return InvalidStream;
+        }
+        // 截掉异常中断留下的不完整记录，保证后续记录对齐（压缩文件按块截断，见 BlockCompressor::begin）
+        const qint64 headerSize = existing.pos();
+        const int recordSize = out->schema.recordSize();
+        const qint64 torn = recordSize > 0 && !out->compressed ? (info.size() - headerSize) % recordSize : 0;
+        existing.close();
+        if (torn != 0) {
+            qWarning() << "二进制文件末尾存在不完整记录，已截断" << torn << "字节:" << path;
+            QFile::resize(path, info.size() - torn);
+        }
+        out->wroteHeader = true;
+    } else {
+        out->schema.epochUs = m_epochUs;
+        out->schema.columns = columns;
+        out->schema.metadata = metadata;
+    }
+    out->recordSize = out->schema.recordSize();
+
+    reserveOpenSlot();
+    if (!out->file->open(QIODevice::WriteOnly | QIODevice::Append)) {
+        delete out;
+        emit errorOccurred(QStringLiteral("无法打开文件: %1").arg(path));
+        return InvalidStream;
     }
 
+    const StreamId id = addStream(key, out);
+    beginSegment(out);
+    emit fileOpened(path);
+
+    if (!out->wroteHeader && !out->schema.columns.isEmpty()) {
+        // 列已确定，文件头随第一块数据一起写出
+        out->buffer.append(BinaryFormat::encodeHeader(out->schema));
+        out->wroteHeader = true;
+    }
+    return id;
+}
+
+DataSaver::StreamId DataSaver::addStream(const QString& key, OutputFile* out) {
+    // 句柄不复用：关闭后旧句柄失效，不会误写到之后打开的文件
+    out->key = key;
+    out->id = m_streams.size();
+    m_streams.append(out);
+    m_files.insert(key, out);
+    lruInsert(out);
+    acquireBuffer(out);
+    return out->id;
+}
+
+DataSaver::OutputFile* DataSaver::stream(StreamId id) {
+    OutputFile* out = (id >= 0 && id < m_streams.size()) ? m_streams[id] : nullptr;
+    if (out && out->suspended && !resume(out)) return nullptr;
+    if (!out || !out->file->isOpen()) {
+        emit errorOccurred(QStringLiteral("流未打开: %1").arg(id));
+        return nullptr;
+    }
+    if (m_lruHead != out) {
+        lruRemove(out);
+        lruInsert(out);
+    }
+    return out;
+}
+
+void DataSaver::setMaxOpenFiles(int count) {
+    m_maxOpenFiles = count > 0 ? count : 0;
+    while (m_maxOpenFiles > 0 && m_openCount > m_maxOpenFiles && m_lruTail) {
+        suspend(m_lruTail);
+    }
+}
+
+void DataSaver::reserveOpenSlot() {
+    while (m_maxOpenFiles > 0 && m_openCount >= m_maxOpenFiles && m_lruTail) {
+        suspend(m_lruTail);
+    }
+}
+
+void DataSaver::lruInsert(OutputFile* out) {
+    if (out->inLru) return;
+    out->lruPrev = nullptr;
+    out->lruNext = m_lruHead;
+    if (m_lruHead) m_lruHead->lruPrev = out;
+    m_lruHead = out;
+    if (!m_lruTail) m_lruTail = out;
+    out->inLru = true;
+    ++m_openCount;
+}
+
+void DataSaver::lruRemove(OutputFile* out) {
+    if (!out->inLru) return;
+    if (out->lruPrev) out->lruPrev->lruNext = out->lruNext;
+    else m_lruHead = out->lruNext;
+    if (out->lruNext) out->lruNext->lruPrev = out->lruPrev;
+    else m_lruTail = out->lruPrev;
+    out->lruPrev = out->lruNext = nullptr;
+    out->inLru = false;
+    --m_openCount;
+}
+
+void DataSaver::suspend(OutputFile* out) {
+    lruRemove(out);
+    commit(out, true);
+    // 与关闭文件相同的收尾，但不结束分段：写块索引、截掉预分配空间、按落盘策略同步。
+    // 交给写盘线程排在该文件已提交的数据之后执行，写入方不等待队列写完
+    out->closeTask = finishInBackground(retireFile(out, false));
+    releaseBuffer(out);
+    out->suspended = true;
+}
+
+bool DataSaver::resume(OutputFile* out) {
+    reserveOpenSlot();
+    if (out->compressed && out->closeTask && m_writer) {
+        // 续接前要读取挂起时写出的块索引；未压缩的文件直接追加，写盘线程按提交顺序先完成收尾
+        m_writer->waitTask(out->closeTask);
+    }
+    out->closeTask = 0;
+    if (!out->file->open(QIODevice::WriteOnly | QIODevice::Append)) {
+        emit errorOccurred(QStringLiteral("无法打开文件: %1").arg(out->file->fileName()));
+        return false;
+    }
+    out->suspended = false;
+    lruInsert(out);
+    acquireBuffer(out);
+    if (out->segment >= 0 && m_preallocateBytes > 0) {
+        out->preallocated = preallocate(*out->file, m_preallocateBytes);
+    }
+    if (out->compressed) {
+        // 从块索引续接，新数据从新块开始
+        out->compressor.reset(new BlockCompression::BlockCompressor(m_compressionBlockBytes, m_compressionLevel));
+        QString error;
+        if (!out->compressor->begin(*out->file, &error)) {
+            emit errorOccurred(QStringLiteral("无法写入压缩文件: %1 (%2)").arg(out->file->fileName(), error));
+        }
+        applyRecordLayout(out);
+    }
     return true;
 }
 
-QString DataSaver::escapeCsv(const QString& field) const {
-    // RFC4180：若包含逗号、引号或换行，用双引号包裹，并将内部引号翻倍。
-    bool needQuote = field.contains(',') || field.contains('"') || field.contains('\n') || field.contains('\r');
-    QString s = field;
-    if (s.contains('"')) s.replace("\"", "\"\"");
-    if (needQuote) {
-        s.prepend('"');
-        s.append('"');
+void DataSaver::acquireBuffer(OutputFile* out) {
+    if (!m_bufferPool.isEmpty()) {
+        out->buffer.swap(m_bufferPool.last());
+        m_bufferPool.removeLast();
+    } else {
+        out->buffer.reserve(m_bufferLimitBytes + 1024);
+    }
+}
+
+void DataSaver::releaseBuffer(OutputFile* out) {
+    // 池中保留少量空缓冲（保留容量），多余的直接释放
+    const int maxPooled = 16;
+    QByteArray buffer;
+    buffer.swap(out->buffer);
+    if (m_bufferPool.size() < maxPooled && buffer.capacity() > 0) {
+        buffer.resize(0);
+        m_bufferPool.append(buffer);
     }
-    return s;
 }
 
 bool DataSaver::writeRow(const QString& kind, const QString& group, const QStringList& columns) {
-    if (!ensureCsv(kind, group)) return false;
-    const QString key = makeKey(kind, group);
-    CsvFile* csv = m_files.value(key, nullptr);
-    if (!csv || !csv->file.isOpen()) {
-        emit errorOccurred(QStringLiteral("文件未打开: %1/%2").arg(kind, group));
-        return false;
+    const StreamId id = openStream(kind, group);
+    return id != InvalidStream && writeRow(id, columns);
+}
+
+bool DataSaver::writeRow(StreamId id, const QStringList& columns) {
+    OutputFile* out = stream(id);
+    if (!out) return false;
+
+    if (!out->decimationFactors.isEmpty()) {
+        QVarLengthArray<double, 16> values(columns.size());
+        bool ok = true;
+        for (int i = 0; ok && i < columns.size(); ++i) values[i] = columns[i].toDouble(&ok);
+        if (ok) decimate(out, values.constData(), values.size());
     }
 
-    QStringList escaped;
-    escaped.reserve(columns.size());
-    for (const auto& c : columns) escaped << escapeCsv(c);
+    if (out->binary) {
+        if (!appendTextRecord(out, columns)) return false;
+        maybeCommit(out);
+        return true;
+    }
 
-    const QString line = escaped.join(',');
-    csv->stream << line << '\n';
-    csv->pendingBytes += line.size() + 1;
-    if (m_autoFlush || csv->pendingBytes >= m_bufferLimitBytes) {
-        csv->stream.flush();
-        csv->pendingBytes = 0;
+    for (int i = 0; i < columns.size(); ++i) {
+        if (i) out->buffer.append(',');
+        CsvFormat::appendField(out->buffer, columns[i]);
     }
+    out->buffer.append('\n');
+    maybeCommit(out);
     return true;
 }
 
 bool DataSaver::writeRawLine(const QString& kind, const QString& group, const QString& rawLine) {
-    if (!ensureCsv(kind, group)) return false;
-    const QString key = makeKey(kind, group);
-    CsvFile* csv = m_files.value(key, nullptr);
-    if (!csv || !csv->file.isOpen()) {
-        emit errorOccurred(QStringLiteral("文件未打开: %1/%2").arg(kind, group));
-        return false;
+    const StreamId id = openStream(kind, group);
+    return id != InvalidStream && writeRawLine(id, rawLine);
+}
+
+bool DataSaver::writeRawLine(StreamId id, const QString& rawLine) {
+    OutputFile* out = stream(id);
+    if (!out) return false;
+
+    if (!out->decimationFactors.isEmpty()) {
+        const QByteArray utf8 = rawLine.toUtf8();
+        decimateText(out, utf8.constData(), utf8.constData() + utf8.size());
     }
 
-    csv->stream << rawLine << '\n';
-    csv->pendingBytes += rawLine.size() + 1;
-    if (m_autoFlush || csv->pendingBytes >= m_bufferLimitBytes) {
-        csv->stream.flush();
-        csv->pendingBytes = 0;
+    if (out->binary) {
+        if (!appendTextRecord(out, rawLine.split(','))) return false;
+        maybeCommit(out);
+        return true;
     }
+
+    appendLine(out, rawLine);
+    return true;
+}
+
+bool DataSaver::writeRawBlock(const QString& kind, const QString& group, const QString& block) {
+    if (block.isEmpty()) return true;
+    const StreamId id = openStream(kind, group);
+    return id != InvalidStream && writeRawBlock(id, block.toUtf8());
+}
+
+bool DataSaver::writeRawBlock(StreamId id, const QByteArray& block) {
+    if (block.isEmpty()) return true;
+    OutputFile* out = stream(id);
+    if (!out) return false;
+    decimateText(out, block.constData(), block.constData() + block.size());
+
+    if (out->binary) {
+        const QStringList lines = QString::fromUtf8(block).split('\n');
+        for (const auto& line : lines) {
+            if (line.isEmpty()) continue;
+            if (!appendTextRecord(out, line.split(','))) return false;
+        }
+        maybeCommit(out);
+        return true;
+    }
+
+    out->buffer.append(block);
+    maybeCommit(out);
     return true;
 }
 
 bool DataSaver::writeDoubles(const QString& kind, const QString& group, const QVector<double>& columns, int precision) {
-    if (!ensureCsv(kind, group)) return false;
-    const QString key = makeKey(kind, group);
-    CsvFile* csv = m_files.value(key, nullptr);
-    if (!csv || !csv->file.isOpen()) {
-        emit errorOccurred(QStringLiteral("文件未打开: %1/%2").arg(kind, group));
-        return false;
+    const StreamId id = openStream(kind, group);
+    return id != InvalidStream && writeDoubles(id, columns, precision);
+}
+
+bool DataSaver::writeDoubles(StreamId id, const QVector<double>& columns, int precision) {
+    OutputFile* out = stream(id);
+    if (!out) return false;
+
+    if (out->binary) {
+        char* rec = appendRecords(out, columns.size(), 1, BinaryFormat::ColumnType::Float64);
+        if (!rec) return false;
+        for (int i = 0; i < columns.size(); ++i) {
+            const BinaryFormat::ColumnType type = out->schema.columns[i].type;
+            BinaryFormat::putDouble(rec, type, columns[i]);
+            rec += BinaryFormat::columnWidth(type);
+        }
+        decimate(out, columns.constData(), columns.size());
+        maybeCommit(out);
+        return true;
     }
 
-    QString line;
-    line.reserve(columns.size() * (precision + 4));
+    // 直接格式化到写缓冲区
     for (int i = 0; i < columns.size(); ++i) {
-        if (i) line.append(',');
-        line.append(QString::number(columns[i], 'f', precision));
-    }
-    csv->stream << line << '\n';
-    csv->pendingBytes += line.size() + 1;
-    if (m_autoFlush || csv->pendingBytes >= m_bufferLimitBytes) {
-        csv->stream.flush();
-        csv->pendingBytes = 0;
+        if (i) out->buffer.append(',');
+        CsvFormat::appendDouble(out->buffer, columns[i], precision);
     }
+    out->buffer.append('\n');
+    decimate(out, columns.constData(), columns.size());
+    maybeCommit(out);
     return true;
 }
 
-
-
 void DataSaver::close(const QString& kind, const QString& group) {
-    const QString key = makeKey(kind, group);
-    CsvFile* csv = m_files.take(key);
-    if (!csv) return;
-    const QString p = csv->file.fileName();
-    if (csv->file.isOpen()) {
-        if (csv->pendingBytes > 0) csv->stream.flush();
-        csv->file.close();
-    }
-    delete csv;
+    const OutputFile* out = m_files.value(makeKey(kind, group), nullptr);
+    if (out) close(out->id);
+}
+
+void DataSaver::close(StreamId id) {
+    if (id < 0 || id >= m_streams.size() || !m_streams[id]) return;
+    OutputFile* out = m_streams[id];
+    m_streams[id] = nullptr;
+    m_files.remove(out->key);
+    const QString p = out->file->fileName();
+    closeDecimation(out);
+    lruRemove(out);
+    if (out->file->isOpen()) commit(out, true);
+    // 等待该文件的在途数据及挂起时的收尾任务完成再关闭
+    if (m_writer) m_writer->waitIdle();
+    if (out->file->isOpen() || out->suspended) {
+        finishFile(out);
+    }
+    releaseBuffer(out);
+    delete out;
     emit fileClosed(p);
 }
 
 void DataSaver::closeAll() {
+    // 先提交全部缓冲并等待写完，再逐个关闭
+    flushAll();
     const auto keys = m_files.keys();
     for (const auto& k : keys) {
-        CsvFile* csv = m_files.take(k);
-        if (!csv) continue;
-        const QString p = csv->file.fileName();
-        if (csv->file.isOpen()) {
-            if (csv->pendingBytes > 0) csv->stream.flush();
-            csv->file.close();
-        }
-        delete csv;
+        OutputFile* out = m_files.take(k);
+        if (!out) continue;
+        m_streams[out->id] = nullptr;
+        const QString p = out->file->fileName();
+        closeDecimation(out);
+        lruRemove(out);
+        if (out->file->isOpen() || out->suspended) {
+            finishFile(out);
+        }
+        releaseBuffer(out);
+        delete out;
         emit fileClosed(p);
     }
 }
@@ -180,44 +988,128 @@ void DataSaver::setBufferLimitBytes(int bytes) {
 }
 
 void DataSaver::flush(const QString& kind, const QString& group) {
-    const QString key = makeKey(kind, group);
-    CsvFile* csv = m_files.value(key, nullptr);
-    if (!csv) return;
-    csv->stream.flush();
-    csv->pendingBytes = 0;
+    const OutputFile* out = m_files.value(makeKey(kind, group), nullptr);
+    if (out) flush(out->id);
+}
+
+void DataSaver::flush(StreamId id) {
+    if (id < 0 || id >= m_streams.size() || !m_streams[id]) return;
+    if (m_streams[id]->decimation) m_streams[id]->decimation->flush();
+    commit(m_streams[id], true);
+    if (m_writer) m_writer->waitIdle();
 }
 
 void DataSaver::flushAll() {
     for (auto it = m_files.begin(); it != m_files.end(); ++it) {
-        CsvFile* csv = it.value();
-        if (!csv) continue;
-        csv->stream.flush();
-        csv->pendingBytes = 0;
+        OutputFile* out = it.value();
+        if (!out) continue;
+        if (out->decimation) out->decimation->flush();
+        commit(out, true);
     }
+    // 异步模式：等待所有在途缓冲区写完
+    if (m_writer) m_writer->waitIdle();
 }
 
 bool DataSaver::writeInts(const QString& kind, const QString& group, const QVector<int>& columns) {
-    if (!ensureCsv(kind, group)) return false;
-    const QString key = makeKey(kind, group);
-    CsvFile* csv = m_files.value(key, nullptr);
-    if (!csv || !csv->file.isOpen()) {
-        emit errorOccurred(QStringLiteral("文件未打开: %1/%2").arg(kind, group));
-        return false;
+    const StreamId id = openStream(kind, group);
+    return id != InvalidStream && writeInts(id, columns);
+}
+
+bool DataSaver::writeInts(StreamId id, const QVector<int>& columns) {
+    OutputFile* out = stream(id);
+    if (!out) return false;
+
+    if (out->binary) {
+        char* rec = appendRecords(out, columns.size(), 1, BinaryFormat::ColumnType::Int32);
+        if (!rec) return false;
+        for (int i = 0; i < columns.size(); ++i) {
+            const BinaryFormat::ColumnType type = out->schema.columns[i].type;
+            BinaryFormat::putInt(rec, type, columns[i]);
+            rec += BinaryFormat::columnWidth(type);
+        }
+        decimate(out, columns.constData(), columns.size());
+        maybeCommit(out);
+        return true;
     }
 
-    // 快速拼接，避免 QStringList 临时对象
-    QString line;
-    line.reserve(columns.size() * 6); // 粗略预估：每个 int 约 6~11 字符，按 6 起步
+    // 直接格式化到写缓冲区，避免 QString 临时对象与编码转换
     for (int i = 0; i < columns.size(); ++i) {
-        if (i) line.append(',');
-        line.append(QString::number(columns[i]));
+        if (i) out->buffer.append(',');
+        CsvFormat::appendInt(out->buffer, columns[i]);
     }
+    out->buffer.append('\n');
+    decimate(out, columns.constData(), columns.size());
+    maybeCommit(out);
+    return true;
+}
+
+template <typename Cell>
+bool DataSaver::writeCells(StreamId id, int rows, int columns, int precision, Cell cell) {
+    using Value = decltype(cell(0, 0));
+    OutputFile* out = stream(id);
+    if (!out) return false;
+    if (rows <= 0 || columns <= 0) return true;
 
-    csv->stream << line << '\n';
-    csv->pendingBytes += line.size() + 1;
-    if (m_autoFlush || csv->pendingBytes >= m_bufferLimitBytes) {
-        csv->stream.flush();
-        csv->pendingBytes = 0;
+    if (out->binary) {
+        const BinaryFormat::ColumnType inferred = std::is_integral<Value>::value
+            ? BinaryFormat::ColumnType::Int32 : BinaryFormat::ColumnType::Float64;
+        // 分块预留记录空间，每块只做一次扩容与一次写出判断
+        const int chunkRows = 1024;
+        for (int r0 = 0; r0 < rows; r0 += chunkRows) {
+            const int n = qMin(chunkRows, rows - r0);
+            char* rec = appendRecords(out, columns, n, inferred);
+            if (!rec) return false;
+            for (int r = r0; r < r0 + n; ++r) {
+                for (int c = 0; c < columns; ++c) {
+                    const BinaryFormat::ColumnType type = out->schema.columns[c].type;
+                    if constexpr (std::is_integral<Value>::value) {
+                        BinaryFormat::putInt(rec, type, static_cast<qint64>(cell(r, c)));
+                    } else {
+                        BinaryFormat::putDouble(rec, type, static_cast<double>(cell(r, c)));
+                    }
+                    rec += BinaryFormat::columnWidth(type);
+                }
+            }
+            if (out->buffer.size() >= m_bufferLimitBytes) commit(out);
+        }
+    } else {
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < columns; ++c) {
+                if (c) out->buffer.append(',');
+                if constexpr (std::is_integral<Value>::value) {
+                    CsvFormat::appendInt(out->buffer, static_cast<qint64>(cell(r, c)));
+                } else {
+                    CsvFormat::appendDouble(out->buffer, static_cast<double>(cell(r, c)), precision);
+                }
+            }
+            out->buffer.append('\n');
+            // 大块数据按阈值分段写出，缓冲区占用不随块大小增长
+            if (out->buffer.size() >= m_bufferLimitBytes) commit(out);
+        }
+    }
+    if (!out->decimationFactors.isEmpty()) {
+        QVarLengthArray<double, 16> values(columns);
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < columns; ++c) values[c] = static_cast<double>(cell(r, c));
+            decimate(out, values.constData(), columns);
+        }
     }
+    if (m_autoFlush) commit(out);
     return true;
 }
+
+bool DataSaver::writeIntRows(StreamId id, const int* data, int rows, int columns) {
+    return writeCells(id, rows, columns, 0, [=](int r, int c) { return data[static_cast<qint64>(r) * columns + c]; });
+}
+
+bool DataSaver::writeDoubleRows(StreamId id, const double* data, int rows, int columns, int precision) {
+    return writeCells(id, rows, columns, precision, [=](int r, int c) { return data[static_cast<qint64>(r) * columns + c]; });
+}
+
+bool DataSaver::writeIntColumns(StreamId id, const int* const* columns, int columnCount, int rows) {
+    return writeCells(id, rows, columnCount, 0, [=](int r, int c) { return columns[c][r]; });
+}
+
+bool DataSaver::writeDoubleColumns(StreamId id, const double* const* columns, int columnCount, int rows, int precision) {
+    return writeCells(id, rows, columnCount, precision, [=](int r, int c) { return columns[c][r]; });
+}
@@ -3,16 +3,27 @@
 #include <QObject>
 #include <QFile>
 #include <QHash>
-#include <QTextStream>
 #include <QByteArray>
 #include <QString>
 #include <QStringList>
 #include <QDir>
 #include <QVector>
+#include <QElapsedTimer>
+
+#include <memory>
+
+#include "BinaryFormat.h"
+#include "BlockCompression.h"
+#include "Decimation.h"
+#include "Durability.h"
+
+class AsyncFileWriter;
+class QTimer;
 
 // DataSaver: 将不同“种类(kind)”与“组(group)”的数据分别保存到对应的 CSV 文件
 // 文件命名：<baseDir>/<kind>/<group>.csv
 // 每种类一个目录，每组一个 csv。支持写入表头与按行追加。
+// 也可切换为二进制记录格式（<group>.bin，见 BinaryFormat.h），写入接口不变。
 class DataSaver : public QObject {
     Q_OBJECT
 public:
@@ -23,8 +34,87 @@ public:
     void setBaseDir(const QString& baseDir);
     QString baseDir() const { return m_baseDir; }
 
+    enum class Format {
+        Csv,    // 文本，每行一条记录
+        Binary  // 定长小端记录 + 自描述文件头
+    };
+    // 输出格式，只影响之后新打开的文件
+    void setFormat(Format format);
+    Format format() const { return m_format; }
+
+    // 压缩输出（只影响之后新打开的文件）：文件名追加 .sgz，原始数据按 blockBytes 分块、每块独立 zlib 压缩
+    // （level 0~9，-1 为 zlib 默认），格式与块索引见 BlockCompression.h。压缩在写盘线程执行，
+    // 开启时若尚未启用异步写盘会自动启用；之后若关闭异步写盘，压缩改在调用线程执行。
+    // 二进制文件的每块先按列打包（整型列差分后按位打包，浮点列按字节平面排列）再压缩，读取时自动还原。
+    void setCompression(bool enabled, int level = 6, int blockBytes = 256 * 1024);
+    bool isCompressionEnabled() const { return m_compression; }
+
+    // 文件分段（只影响之后新打开的文件）：单段达到 maxBytes 字节或持续 maxSeconds 秒后切换到新段，
+    // 0 表示不按该条件分段，两者均为 0 时不分段（默认）。分段文件名为 <group>.000123.csv（或 .bin），
+    // 每段开头重复表头；每段关闭时向 <group>.segments.csv 追加一行（段号、文件名、起止墙钟时间、字节数），
+    // 供下游按时间范围定位。分段判断在缓冲区写出时进行，单段可能超出上限至多一个缓冲区；
+    // 压缩输出时 maxBytes 按未压缩字节计。异步模式下旧段的收尾与关闭在写盘线程排队执行，换段时写入方不等待。
+    void setSegmentLimits(qint64 maxBytes, int maxSeconds = 0);
+    // 每段预先分配的磁盘空间（字节，0 为不预分配），减少长时间追加产生的碎片；关闭时截到实际长度
+    void setSegmentPreallocateBytes(qint64 bytes);
+
+    // 落盘策略：maxLossMs > 0 时定期做组提交——写出所有已打开文件的缓冲，统一同步到磁盘（fdatasync），
+    // checkpoints 为 true 时再给每个文件的 <文件名>.ckpt 追加检查点（见 Durability.h）。
+    // 断电时最多丢失约 maxLossMs 的数据；0 关闭（默认），此时只按缓冲阈值写出、不主动同步。
+    // 计时依赖本对象所在线程的事件循环；没有事件循环时在缓冲区写出时补做到期的组提交。
+    // 压缩文件每次组提交都会结束当前块，窗口很短时块变小、压缩率下降。
+    void setDurability(int maxLossMs, bool checkpoints = true);
+    int durabilityWindowMs() const { return m_maxLossMs; }
+    // 立即做一次组提交。异步模式下同步在写盘线程执行，本调用不等待其完成
+    Q_INVOKABLE void syncAll();
+
+    // 降采样金字塔（只影响之后新打开的文件）：factors 为各级倍数，如 {16, 256, 4096}，须递增且每级为上一级的
+    // 整数倍；为空时关闭（默认）。写入的每一行同时累积到各级 min/max/mean，每级写成一个小的二进制文件
+    // <group>.x<倍数>.bin（格式见 Decimation.h），概览与粗粒度查询无需读取原始数据。
+    // partitionColumn 非空时按该列的整数值分别统计（如按 channel 区分交替写入的通道）。
+    // 数值写入接口直接计入；文本写入接口按逗号解析数值，含非数值字段的行不计入。
+    // 金字塔文件不分段、不压缩、不参与组提交，关闭时写出不满一组的尾部。
+    void setDecimation(const QVector<int>& factors, const QString& partitionColumn = QString());
+
+    // 二进制文件头中记录的时间零点（Unix 纪元微秒），用于还原绝对时间
+    void setTimestampEpochUs(qint64 epochUs);
+
+    // 确保对应 kind/group 的二进制文件已打开，按给定列类型写文件头。
+    // columns 为空时，列在第一次写入时推断（writeInts→Int32，其余→Float64）。
+    // 追加到已有文件时校验列定义一致。
+    Q_INVOKABLE bool ensureBinary(const QString& kind, const QString& group,
+                                  const QVector<BinaryFormat::Column>& columns = {},
+                                  const QVector<QPair<QString, QString>>& metadata = {});
+
+    // 流句柄：打开一次后直接按句柄写入，省去每次写入时拼接 kind|group 与哈希查找。
+    // 句柄在 close/closeAll 后失效，不会被复用；以 kind/group 为参数的接口均是其包装。
+    using StreamId = int;
+    static constexpr StreamId InvalidStream = -1;
+    // 同 ensureCsv/ensureBinary，返回对应文件的句柄；已打开时直接返回原句柄，失败返回 InvalidStream
+    StreamId openStream(const QString& kind, const QString& group, const QStringList& header = {});
+    StreamId openBinaryStream(const QString& kind, const QString& group,
+                              const QVector<BinaryFormat::Column>& columns = {},
+                              const QVector<QPair<QString, QString>>& metadata = {});
+    bool writeRow(StreamId id, const QStringList& columns);
+    bool writeRawLine(StreamId id, const QString& rawLine);
+    // block 为已编码的 UTF-8 字节，原样追加
+    bool writeRawBlock(StreamId id, const QByteArray& block);
+    bool writeInts(StreamId id, const QVector<int>& columns);
+    bool writeDoubles(StreamId id, const QVector<double>& columns, int precision = 6);
+    void flush(StreamId id);
+    void close(StreamId id);
+
+    // 批量写入：一次调用写入整块数据，只做一次句柄检查，按缓冲阈值分段写出。
+    // 行主序矩阵：data[r * columns + c]
+    bool writeIntRows(StreamId id, const int* data, int rows, int columns);
+    bool writeDoubleRows(StreamId id, const double* data, int rows, int columns, int precision = 6);
+    // 列数组：columns[c][r]，各列长度均为 rows
+    bool writeIntColumns(StreamId id, const int* const* columns, int columnCount, int rows);
+    bool writeDoubleColumns(StreamId id, const double* const* columns, int columnCount, int rows, int precision = 6);
+
     // 确保对应 kind/group 的 CSV 已打开；若需要则创建目录和文件
     // header 非空时，且文件新建/为空时会写表头
+    // 二进制格式下转为 ensureBinary，表头各列按 Float64 处理
     Q_INVOKABLE bool ensureCsv(const QString& kind, const QString& group, const QStringList& header = {});
 
     // 写入一行（会自动转义逗号与引号）
@@ -33,9 +123,12 @@ public:
     // 写入原始文本行（调用者自行保证格式）
     Q_INVOKABLE bool writeRawLine(const QString& kind, const QString& group, const QString& rawLine);
 
+    // 写入预先格式化的多行文本块（每行以 '\n' 结尾），整块只做一次查找与一次刷新判断
+    Q_INVOKABLE bool writeRawBlock(const QString& kind, const QString& group, const QString& block);
+
     // 高速写入：整型列，适合 5kHz 采样（避免高开销格式化与逐行刷盘）
     Q_INVOKABLE bool writeInts(const QString& kind, const QString& group, const QVector<int>& columns);
-    // 高速写入：浮点列（double），可指定精度，默认 6 位
+    // 高速写入：浮点列（double），可指定精度，默认 6 位；精度为负数时输出可精确还原的最短表示
     Q_INVOKABLE bool writeDoubles(const QString& kind, const QString& group, const QVector<double>& columns, int precision = 6);
 
 
@@ -43,8 +136,33 @@ public:
     void setAutoFlush(bool enabled);        // 若开启，将在每次写入后 flush（不建议在高频下启用）
     void setBufferLimitBytes(int bytes);    // 达到阈值时自动 flush（默认 64KB）
     Q_INVOKABLE void flush(const QString& kind, const QString& group);
+    // 写出全部缓冲；异步模式下阻塞直到所有在途数据写完
     Q_INVOKABLE void flushAll();
 
+    // 异步写盘：开启后由后台线程执行全部写操作，写入方只填充缓冲区，不再阻塞在 write 上。
+    // maxInflightBuffers 为已提交但未写完的缓冲区上限，超出时写入方等待（背压）。
+    void setAsyncWrite(bool enabled, int maxInflightBuffers = 8);
+    bool isAsyncWrite() const;
+
+    // 写盘线程的写入方式，设置为 QFile 以外时自动启用异步写盘（见 WriteBatch.h）
+    enum class IoBackend {
+        QFile,  // 每个缓冲区一次 QFile::write（默认）
+        Uring,  // Linux io_uring：每轮把所有文件的待写数据合并，一次提交、一次等待完成；不可用时退回 Pwrite
+        Pwrite  // 每轮每个文件一次 pwritev
+    };
+    // direct 为 true 时以 O_DIRECT 写 4KB 对齐的整块、绕过页缓存（仅 Linux，文件系统不支持时自动改为普通写入）。
+    // 压缩文件、组提交不经批量后端
+    void setIoBackend(IoBackend backend, bool direct = false);
+    // 实际使用的后端：请求 Uring 而内核不支持时为 Pwrite，非 Linux 平台总是 QFile
+    IoBackend ioBackend() const;
+
+    // 同时打开的文件数上限（0 为不限，默认）。超出时最久未写入的流被挂起：缓冲写出、文件关闭、缓冲区归还共享池；
+    // 句柄保持有效，再次写入时自动重新打开并追加（分段、压缩、降采样状态均延续）。
+    // 每个打开的流占用一个描述符，开启落盘策略的检查点时再加一个。压缩文件挂起时结束当前块并写出块索引。
+    // 异步模式下挂起文件的收尾与关闭排在写盘线程执行，写入方不等待整个队列写完。
+    void setMaxOpenFiles(int count);
+    int openFileCount() const { return m_openCount; }
+
     // 关闭某个组或全部
     Q_INVOKABLE void close(const QString& kind, const QString& group);
     Q_INVOKABLE void closeAll();
@@ -55,22 +173,133 @@ signals:
     void fileClosed(const QString& path);
 
 private:
-    struct CsvFile {
-        QFile file;
-    QTextStream stream;
+    struct OutputFile {
+        std::unique_ptr<QFile> file { new QFile() };
+        QByteArray buffer;      // 待写出的 UTF-8 数据，达到阈值时整块写出
         bool wroteHeader { false };
-    qsizetype pendingBytes { 0 }; // 自上次 flush 以来已写入的字节数
-    CsvFile() : stream(&file) {}
+        QString key;
+        StreamId id { InvalidStream };
+        QString kind;
+        QString group;
+        QString suffix;         // 扩展名，分段时用于生成文件名
+        QByteArray header;      // CSV 表头（含换行），分段时在新段开头重复
+        QStringList columnNames; // CSV 表头列名（降采样文件的列名）
+        // 分段状态，segment < 0 表示不分段
+        int segment { -1 };
+        qint64 segmentBytes { 0 };
+        qint64 segmentStartUs { 0 };
+        bool preallocated { false };
+        // 落盘策略
+        bool dirty { false };   // 上次同步后有新数据写出
+        std::unique_ptr<QFile> checkpoint { new QFile() }; // <文件名>.ckpt，第一次同步时打开
+        // 降采样：打开时的设置，列数在第一次写入时确定后创建 decimation
+        QVector<int> decimationFactors;
+        QString decimationPartition;
+        std::unique_ptr<Decimation::Writer> decimation;
+        // 压缩输出
+        bool compressed { false };
+        std::unique_ptr<BlockCompression::BlockCompressor> compressor;
+        // 仅二进制格式使用
+        bool binary { false };
+        BinaryFormat::Header schema;
+        int recordSize { 0 };
+        // 打开文件的 LRU 链表（表头为最近写入）；未打开（挂起）时不在链表中
+        OutputFile* lruPrev { nullptr };
+        OutputFile* lruNext { nullptr };
+        bool inLru { false };
+        bool suspended { false };   // 因打开文件数上限被挂起，写入时重新打开
+        quint64 closeTask { 0 };    // 挂起时交给写盘线程的收尾任务序号，0 为没有
     };
+    // 挂起或换段时从 OutputFile 移出、等待收尾的文件（定义见 DataSaver.cpp）
+    struct RetiredFile;
 
-    QString csvPath(const QString& kind, const QString& group) const;
-    QString escapeCsv(const QString& field) const;
+    QString filePath(const QString& kind, const QString& group, const QString& suffix) const;
+    // 按当前压缩设置给扩展名追加 .sgz
+    QString fileSuffix(const QString& base) const;
+    StreamId addStream(const QString& key, OutputFile* out);
+    bool segmentationEnabled() const;
+    QString segmentPath(const QString& kind, const QString& group, int segment, const QString& suffix) const;
+    QString segmentIndexPath(const QString& kind, const QString& group) const;
+    // 已有分段之后的下一个段号
+    int nextSegment(const QString& kind, const QString& group, const QString& suffix) const;
+    bool segmentFull(const OutputFile* out) const;
+    void beginSegment(OutputFile* out);
+    // 压缩的二进制流：列已确定时让压缩器按列打包记录
+    void applyRecordLayout(OutputFile* out);
+    // 把当前文件连同检查点、压缩器移出，换上同名的未打开文件；endSegment 为 true 时收尾时写分段索引
+    std::shared_ptr<RetiredFile> retireFile(OutputFile* out, bool endSegment);
+    // 收尾并关闭：只访问移出的对象，可以在写盘线程执行。返回错误信息，成功时为空
+    static QString finishRetired(RetiredFile& retired);
+    // 在本线程收尾并关闭文件：写块索引、结束分段，并按落盘策略做最后一次同步（须在在途数据写完后调用）
+    void finishFile(OutputFile* out);
+    // 收尾交给写盘线程，排在该文件已提交的数据之后，返回任务序号；同步模式下直接执行，返回 0
+    quint64 finishInBackground(const std::shared_ptr<RetiredFile>& retired);
+    void rotateSegment(OutputFile* out);
+    // 组提交目标，按需打开检查点文件
+    Durability::SyncTarget syncTarget(OutputFile* out);
+    static bool preallocate(QFile& file, qint64 bytes);
+    // 按句柄取文件（挂起的自动重新打开）并标记为最近使用，无效时报错并返回空
+    OutputFile* stream(StreamId id);
+    // 打开文件数达到上限时挂起最久未使用的流，为新打开的文件腾出位置
+    void reserveOpenSlot();
+    void lruInsert(OutputFile* out);
+    void lruRemove(OutputFile* out);
+    void suspend(OutputFile* out);
+    bool resume(OutputFile* out);
+    // 写缓冲区从共享池取用/归还，挂起与关闭的流不占用缓冲内存
+    void acquireBuffer(OutputFile* out);
+    void releaseBuffer(OutputFile* out);
+    // 追加一行到缓冲区，按 autoFlush/阈值决定是否写出
+    void appendLine(OutputFile* out, const QString& line);
+    // 按 autoFlush/阈值决定是否写出
+    void maybeCommit(OutputFile* out);
+    // 在缓冲区末尾预留 count 条二进制记录并返回其起始地址；列数不符时报错返回空
+    char* appendRecords(OutputFile* out, int columnCount, int count, BinaryFormat::ColumnType inferredType);
+    // 批量写入的公共实现：cell(r, c) 给出第 r 行第 c 列的值（整型或浮点）
+    template <typename Cell>
+    bool writeCells(StreamId id, int rows, int columns, int precision, Cell cell);
+    // 二进制格式下把逗号分隔的文本行按列类型解析成一条记录
+    bool appendTextRecord(OutputFile* out, const QStringList& fields);
+    // 把一行数值计入降采样金字塔（未开启时直接返回）
+    void decimate(OutputFile* out, const double* row, int columnCount);
+    template <typename T>
+    void decimate(OutputFile* out, const T* row, int columnCount);
+    // 文本行（可多行）按逗号解析后计入
+    void decimateText(OutputFile* out, const char* p, const char* end);
+    void closeDecimation(OutputFile* out);
+    // 写出缓冲区：同步模式直接写文件，异步模式交给写盘线程。
+    // endBlock 用于刷新/关闭：压缩文件把未满一块的数据也写出
+    void commit(OutputFile* out, bool endBlock = false);
+    void writeOut(OutputFile* out, QByteArray& data, bool endBlock);
 
 private:
     QString m_baseDir;
     // key: kind + "|" + group
-    QHash<QString, CsvFile*> m_files;
+    QHash<QString, OutputFile*> m_files;
+    QVector<OutputFile*> m_streams; // 下标即句柄，关闭后置空
 
     bool m_autoFlush { false };
     int m_bufferLimitBytes { 64 * 1024 };
+    Format m_format { Format::Csv };
+    qint64 m_epochUs { 0 };
+    qint64 m_segmentMaxBytes { 0 };
+    int m_segmentMaxSeconds { 0 };
+    qint64 m_preallocateBytes { 0 };
+    bool m_compression { false };
+    int m_compressionLevel { 6 };
+    int m_compressionBlockBytes { 256 * 1024 };
+    QVector<int> m_decimationFactors;
+    QString m_decimationPartition;
+    int m_maxOpenFiles { 0 };
+    int m_openCount { 0 };
+    OutputFile* m_lruHead { nullptr };
+    OutputFile* m_lruTail { nullptr };
+    QVector<QByteArray> m_bufferPool;
+    int m_maxLossMs { 0 };
+    bool m_checkpoints { true };
+    QTimer* m_syncTimer { nullptr };
+    QElapsedTimer m_sinceSync;
+    IoBackend m_ioBackend { IoBackend::QFile };
+    bool m_directIo { false };
+    AsyncFileWriter* m_writer { nullptr }; // 非空即为异步写盘模式
 };
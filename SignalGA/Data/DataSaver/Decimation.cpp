@@ -0,0 +1,313 @@
+#include "Decimation.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <cmath>
+
+#include "BinaryFormat.h"
+#include "Durability.h"
+
+namespace Decimation {
+
+// 单个分区的金字塔：每级一个正在累积的桶与一个输出文件
+class Pyramid {
+public:
+    Pyramid(const QVector<int>& factors, int columnCount);
+    ~Pyramid();
+
+    bool open(const QString& basePath, const QStringList& columns,
+              const QVector<QPair<QString, QString>>& metadata, QString* error);
+    void add(const double* row);
+    bool flush(QString* error);
+    bool close(QString* error);
+
+private:
+    struct Level {
+        int factor { 0 };
+        int ratio { 0 };        // 满一桶需要的下一级输入数（第 0 级为原始行数）
+        int inputs { 0 };
+        qint64 count { 0 };     // 桶内原始行数
+        QVector<double> min;
+        QVector<double> max;
+        QVector<double> sum;
+        QString path;
+        QByteArray buffer;
+    };
+
+    void emitBucket(int level);
+    bool writeOut(Level& level, QString* error);
+
+    const int m_columnCount;
+    int m_recordSize { 0 };
+    QVector<Level*> m_levels;
+    QString m_writeError;   // 累积过程中写出失败，留到 flush/close 报告
+};
+
+namespace {
+
+const int BUFFER_BYTES = 64 * 1024;
+
+bool fail(QString* error, const QString& message) {
+    if (error) *error = message;
+    return false;
+}
+
+QString metadataValue(const BinaryFormat::Header& header, const QString& key) {
+    for (const QPair<QString, QString>& kv : header.metadata) {
+        if (kv.first == key) return kv.second;
+    }
+    return QString();
+}
+
+// 已有级别文件与当前设置是否一致：列名与类型逐列相同，且属于同一倍数与分区
+bool sameLayout(const BinaryFormat::Header& old, const BinaryFormat::Header& header) {
+    if (old.columns.size() != header.columns.size()) return false;
+    for (int i = 0; i < header.columns.size(); ++i) {
+        if (old.columns[i].name != header.columns[i].name || old.columns[i].type != header.columns[i].type) return false;
+    }
+    for (const QString& key : { QStringLiteral("factor"), QStringLiteral("partition") }) {
+        if (metadataValue(old, key) != metadataValue(header, key)) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+QString levelPath(const QString& basePath, int factor) {
+    return QStringLiteral("%1.x%2.%3").arg(basePath).arg(factor).arg(QString::fromLatin1(BinaryFormat::FILE_SUFFIX));
+}
+
+bool validFactors(const QVector<int>& factors) {
+    int previous = 1;
+    for (int f : factors) {
+        if (f <= previous || f % previous != 0) return false;
+        previous = f;
+    }
+    return !factors.isEmpty();
+}
+
+Pyramid::Pyramid(const QVector<int>& factors, int columnCount)
+    : m_columnCount(columnCount) {
+    int previous = 1;
+    for (int f : factors) {
+        Level* level = new Level();
+        level->factor = f;
+        level->ratio = f / previous;
+        level->min.resize(columnCount);
+        level->max.resize(columnCount);
+        level->sum.resize(columnCount);
+        m_levels.append(level);
+        previous = f;
+    }
+}
+
+Pyramid::~Pyramid() {
+    qDeleteAll(m_levels);
+}
+
+bool Pyramid::open(const QString& basePath, const QStringList& columns,
+                   const QVector<QPair<QString, QString>>& metadata, QString* error) {
+    BinaryFormat::Header header;
+    header.columns.append({ QStringLiteral("count"), BinaryFormat::ColumnType::Int32, 0.0 });
+    for (const QString& name : columns) {
+        header.columns.append({ name + QStringLiteral("_min"), BinaryFormat::ColumnType::Float64, 0.0 });
+        header.columns.append({ name + QStringLiteral("_max"), BinaryFormat::ColumnType::Float64, 0.0 });
+        header.columns.append({ name + QStringLiteral("_mean"), BinaryFormat::ColumnType::Float64, 0.0 });
+    }
+    m_recordSize = header.recordSize();
+
+    for (Level* level : m_levels) {
+        const QString path = levelPath(basePath, level->factor);
+        header.metadata = metadata;
+        header.metadata.append(qMakePair(QStringLiteral("factor"), QString::number(level->factor)));
+
+        const QFileInfo info(path);
+        if (info.exists() && info.size() > 0) {
+            // 追加：列定义、倍数与分区须一致，异常中断留下的不完整记录先截掉
+            QFile existing(path);
+            BinaryFormat::Header old;
+            QString headerError;
+            if (!existing.open(QIODevice::ReadOnly) || !BinaryFormat::readHeader(existing, old, &headerError)) {
+                return fail(error, QStringLiteral("无法追加到降采样文件: %1 %2").arg(path, headerError));
+            }
+            if (!sameLayout(old, header)) {
+                return fail(error, QStringLiteral("降采样文件的列或级别与当前设置不一致: %1").arg(path));
+            }
+            existing.close();
+            if (!Durability::recoverFile(path, nullptr, error)) return false;
+        } else {
+            level->buffer.append(BinaryFormat::encodeHeader(header));
+        }
+        level->path = path;
+        level->buffer.reserve(BUFFER_BYTES + m_recordSize);
+    }
+    return true;
+}
+
+void Pyramid::add(const double* row) {
+    Level* level = m_levels.first();
+    if (level->inputs == 0) {
+        for (int c = 0; c < m_columnCount; ++c) {
+            level->min[c] = level->max[c] = level->sum[c] = row[c];
+        }
+    } else {
+        for (int c = 0; c < m_columnCount; ++c) {
+            const double v = row[c];
+            if (v < level->min[c]) level->min[c] = v;
+            if (v > level->max[c]) level->max[c] = v;
+            level->sum[c] += v;
+        }
+    }
+    ++level->count;
+    if (++level->inputs == level->ratio) {
+        emitBucket(0);
+    }
+}
+
+void Pyramid::emitBucket(int index) {
+    Level* level = m_levels[index];
+    // 写一条记录
+    const int offset = level->buffer.size();
+    level->buffer.resize(offset + m_recordSize);
+    char* rec = level->buffer.data() + offset;
+    BinaryFormat::putInt(rec, BinaryFormat::ColumnType::Int32, level->count);
+    rec += 4;
+    const double n = static_cast<double>(level->count);
+    for (int c = 0; c < m_columnCount; ++c) {
+        BinaryFormat::putDouble(rec, BinaryFormat::ColumnType::Float64, level->min[c]);
+        BinaryFormat::putDouble(rec + 8, BinaryFormat::ColumnType::Float64, level->max[c]);
+        BinaryFormat::putDouble(rec + 16, BinaryFormat::ColumnType::Float64, level->sum[c] / n);
+        rec += 24;
+    }
+
+    // 并入上一级
+    if (index + 1 < m_levels.size()) {
+        Level* up = m_levels[index + 1];
+        if (up->inputs == 0) {
+            up->min = level->min;
+            up->max = level->max;
+            up->sum = level->sum;
+        } else {
+            for (int c = 0; c < m_columnCount; ++c) {
+                if (level->min[c] < up->min[c]) up->min[c] = level->min[c];
+                if (level->max[c] > up->max[c]) up->max[c] = level->max[c];
+                up->sum[c] += level->sum[c];
+            }
+        }
+        up->count += level->count;
+        ++up->inputs;
+    }
+    level->inputs = 0;
+    level->count = 0;
+
+    if (level->buffer.size() >= BUFFER_BYTES) {
+        writeOut(*level, &m_writeError);
+    }
+    if (index + 1 < m_levels.size() && m_levels[index + 1]->inputs == m_levels[index + 1]->ratio) {
+        emitBucket(index + 1);
+    }
+}
+
+bool Pyramid::writeOut(Level& level, QString* error) {
+    if (level.buffer.isEmpty()) return true;
+    // 只在写出时打开：缓冲区满 64KB 才写一次，平时不占用文件描述符
+    QFile file(level.path);
+    const bool ok = file.open(QIODevice::WriteOnly | QIODevice::Append)
+        && file.write(level.buffer) == level.buffer.size();
+    level.buffer.resize(0);
+    if (!ok) {
+        return fail(error, QStringLiteral("写入失败: %1 (%2)").arg(level.path, file.errorString()));
+    }
+    return true;
+}
+
+bool Pyramid::flush(QString* error) {
+    bool ok = m_writeError.isEmpty();
+    if (!ok) {
+        fail(error, m_writeError);
+        m_writeError.clear();
+    }
+    for (Level* level : m_levels) {
+        ok = writeOut(*level, error) && ok;
+    }
+    return ok;
+}
+
+bool Pyramid::close(QString* error) {
+    // 由低到高写出不满一组的桶：低一级的尾部并入高一级后，高一级的尾部覆盖全部剩余数据
+    for (int i = 0; i < m_levels.size(); ++i) {
+        if (m_levels[i]->inputs > 0) emitBucket(i);
+    }
+    return flush(error);
+}
+
+Writer::Writer(const QString& basePath, const QString& source, const QVector<int>& factors,
+               const QStringList& columns, const QString& partitionColumn)
+    : m_basePath(basePath)
+    , m_source(source)
+    , m_factors(factors)
+    , m_columns(columns)
+    , m_partitionColumn(partitionColumn.isEmpty() ? -1 : columns.indexOf(partitionColumn)) {
+}
+
+Writer::~Writer() {
+    close();
+}
+
+bool Writer::open(qint64 key) {
+    QString base = m_basePath;
+    QVector<QPair<QString, QString>> metadata { qMakePair(QStringLiteral("source"), m_source) };
+    if (m_partitionColumn >= 0) {
+        const QString partition = m_columns[m_partitionColumn] + QString::number(key);
+        base += '.' + partition;
+        metadata.append(qMakePair(QStringLiteral("partition"), partition));
+    }
+    Pyramid* p = new Pyramid(m_factors, m_columns.size());
+    if (!p->open(base, m_columns, metadata, &m_error)) {
+        delete p;
+        m_partitions.insert(key, nullptr); // 记住失败，不再逐行重试
+        return false;
+    }
+    m_partitions.insert(key, p);
+    m_lastKey = key;
+    m_last = p;
+    return true;
+}
+
+bool Writer::add(const double* row) {
+    const qint64 key = m_partitionColumn >= 0 ? static_cast<qint64>(std::llround(row[m_partitionColumn])) : 0;
+    if (!m_last || key != m_lastKey) {
+        const auto it = m_partitions.constFind(key);
+        if (it == m_partitions.constEnd()) {
+            if (!open(key)) return false;
+        } else if (!it.value()) {
+            return true; // 打开失败的分区：错误已报告过，其后的行不计入
+        } else {
+            m_lastKey = key;
+            m_last = it.value();
+        }
+    }
+    m_last->add(row);
+    return true;
+}
+
+bool Writer::flush() {
+    bool ok = true;
+    for (auto it = m_partitions.begin(); it != m_partitions.end(); ++it) {
+        if (it.value()) ok = it.value()->flush(&m_error) && ok;
+    }
+    return ok;
+}
+
+bool Writer::close() {
+    bool ok = true;
+    for (auto it = m_partitions.begin(); it != m_partitions.end(); ++it) {
+        if (it.value()) ok = it.value()->close(&m_error) && ok;
+        delete it.value();
+    }
+    m_partitions.clear();
+    m_last = nullptr;
+    return ok;
+}
+
+} // namespace Decimation
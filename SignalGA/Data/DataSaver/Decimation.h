@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Decimation: DataSaver 的多分辨率降采样金字塔（min/max/mean）
+//
+// 每一级把原始数据连续 factor 行合成一条记录，写入 <group>.x<factor>.bin（BinaryFormat）：
+//   count（Int32，本条覆盖的原始行数，只有关闭时写出的最后一条可能小于 factor）
+//   每个原始列 <列名>_min、<列名>_max、<列名>_mean（Float64）
+// 文件头元数据记录 source（原始文件名）、factor 与 partition。各级倍数须递增且每级为上一级的整数倍：
+// 低一级的记录写出时并入高一级，每行原始数据的均摊开销为 O(列数)，与级数无关。
+// 按分区列（如 channel）分别统计时，每个取值一组文件：<group>.<列名><值>.x<factor>.bin。
+// 各级文件只在缓冲区写出时短暂打开，不常驻文件描述符。
+namespace Decimation {
+
+QString levelPath(const QString& basePath, int factor);
+
+// 倍数均大于 1、递增，且每级为上一级的整数倍
+bool validFactors(const QVector<int>& factors);
+
+class Pyramid;
+
+class Writer {
+public:
+    // basePath 为不含扩展名的原始文件路径 <baseDir>/<kind>/<group>；columns 为原始列名。
+    // partitionColumn 为空或不在 columns 中时不分区
+    Writer(const QString& basePath, const QString& source, const QVector<int>& factors,
+           const QStringList& columns, const QString& partitionColumn);
+    ~Writer();
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    int columnCount() const { return m_columns.size(); }
+
+    // 加入一行（columnCount() 个值）；所在分区的级别文件无法打开（或与已有文件的列、倍数不一致）时返回 false，
+    // 见 errorString()。失败只报告一次：之后该分区的行直接跳过，不再重试打开，其他分区不受影响
+    bool add(const double* row);
+    // 把已完成的记录写出
+    bool flush();
+    // 写出各级不满一组的尾部并关闭文件
+    bool close();
+
+    QString errorString() const { return m_error; }
+
+private:
+    // 打开分区的各级文件；失败时记为空，之后不再重试
+    bool open(qint64 key);
+
+    QString m_basePath;
+    QString m_source;
+    QVector<int> m_factors;
+    QStringList m_columns;
+    int m_partitionColumn { -1 };
+    QHash<qint64, Pyramid*> m_partitions; // 打开失败的分区为空
+    // 相邻行通常属于同一分区，缓存上一次的查找结果
+    qint64 m_lastKey { 0 };
+    Pyramid* m_last { nullptr };
+    QString m_error;
+};
+
+} // namespace Decimation
@@ -0,0 +1,158 @@
+#include "Durability.h"
+
+#include <QDateTime>
+#include <cstring>
+
+#include "BinaryFormat.h"
+#include "BlockCompression.h"
+#include "CsvFormat.h"
+
+#if defined(Q_OS_WIN)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h>
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+namespace Durability {
+
+namespace {
+
+bool fail(QString* error, const QString& message) {
+    if (error) *error = message;
+    return false;
+}
+
+// 文本：从末尾向前找最后一个换行，不早于 start
+qint64 lastLineEnd(QFile& file, qint64 start, qint64 size) {
+    const qint64 chunk = 64 * 1024;
+    QByteArray buf;
+    qint64 end = size;
+    while (end > start) {
+        const qint64 begin = qMax(start, end - chunk);
+        buf.resize(static_cast<int>(end - begin));
+        if (!file.seek(begin) || file.read(buf.data(), buf.size()) != buf.size()) break;
+        const int nl = buf.lastIndexOf('\n');
+        if (nl >= 0) return begin + nl + 1;
+        end = begin;
+    }
+    return start;
+}
+
+} // namespace
+
+QString checkpointPath(const QString& path) {
+    return path + '.' + QString::fromLatin1(CHECKPOINT_SUFFIX);
+}
+
+bool syncFile(QFile& file) {
+    if (!file.flush()) return false;
+#if defined(Q_OS_LINUX)
+    return ::fdatasync(file.handle()) == 0;
+#elif defined(Q_OS_WIN)
+    const HANDLE h = reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()));
+    return h != INVALID_HANDLE_VALUE && FlushFileBuffers(h);
+#elif defined(Q_OS_UNIX)
+    return ::fsync(file.handle()) == 0;
+#else
+    return true;
+#endif
+}
+
+bool commitGroup(const QVector<SyncTarget>& targets, QString* error) {
+    // 第一阶段：同步全部数据文件
+    QVector<bool> synced(targets.size(), false);
+    QString failed;
+    for (int i = 0; i < targets.size(); ++i) {
+        QFile* file = targets[i].file;
+        if (!file || !file->isOpen()) continue;
+        synced[i] = syncFile(*file);
+        if (!synced[i]) failed = file->fileName();
+    }
+
+    // 第二阶段：已落盘的文件追加检查点
+    const qint64 wallUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    QByteArray line;
+    for (int i = 0; i < targets.size(); ++i) {
+        QFile* ckpt = targets[i].checkpoint;
+        if (!synced[i] || !ckpt || !ckpt->isOpen()) continue;
+        line.resize(0);
+        if (ckpt->size() == 0) line.append("wall_us,bytes\n");
+        CsvFormat::appendInt(line, wallUs);
+        line.append(',');
+        CsvFormat::appendInt(line, targets[i].file->size());
+        line.append('\n');
+        if (ckpt->write(line) != line.size() || !syncFile(*ckpt)) failed = ckpt->fileName();
+    }
+
+    if (!failed.isEmpty()) {
+        return fail(error, QStringLiteral("同步到磁盘失败: %1").arg(failed));
+    }
+    return true;
+}
+
+qint64 lastCheckpoint(const QString& path) {
+    QFile ckpt(checkpointPath(path));
+    if (!ckpt.open(QIODevice::ReadOnly)) return -1;
+    // 只读末尾一小段；最后一行可能因断电而不完整，取最后一个以换行结尾的行
+    const qint64 size = ckpt.size();
+    const qint64 tail = 4096;
+    if (size > tail) ckpt.seek(size - tail);
+    const QByteArray text = ckpt.readAll();
+    const int end = text.lastIndexOf('\n');
+    if (end < 0) return -1;
+    const int begin = text.lastIndexOf('\n', end - 1) + 1;
+    const QList<QByteArray> fields = text.mid(begin, end - begin).split(',');
+    if (fields.size() != 2) return -1;
+    bool ok = false;
+    const qint64 bytes = fields[1].toLongLong(&ok);
+    return ok ? bytes : -1;
+}
+
+bool recoverFile(const QString& path, qint64* removedBytes, QString* error) {
+    if (removedBytes) *removedBytes = 0;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(error, QStringLiteral("无法打开文件: %1").arg(path));
+    }
+    const qint64 size = file.size();
+    qint64 checkpoint = lastCheckpoint(path);
+    if (checkpoint > size) checkpoint = -1; // 与文件不符（例如文件被替换），不使用
+
+    qint64 keep = size;
+    const QString compressedSuffix = QStringLiteral(".") + QString::fromLatin1(BlockCompression::FILE_SUFFIX);
+    const QString binarySuffix = QStringLiteral(".") + QString::fromLatin1(BinaryFormat::FILE_SUFFIX);
+    if (path.endsWith(compressedSuffix)) {
+        char magic[sizeof(BlockCompression::MAGIC)];
+        if (file.read(magic, sizeof(magic)) != sizeof(magic)
+            || std::memcmp(magic, BlockCompression::MAGIC, sizeof(magic)) != 0) {
+            return fail(error, QStringLiteral("不是 SignalGA 压缩文件: %1").arg(path));
+        }
+        keep = BlockCompression::scanBlocks(file, qMax<qint64>(checkpoint, BlockCompression::FILE_HEADER_SIZE), size);
+    } else if (path.endsWith(binarySuffix)) {
+        BinaryFormat::Header header;
+        QString headerError;
+        if (!BinaryFormat::readHeader(file, header, &headerError)) {
+            return fail(error, QStringLiteral("%1: %2").arg(path, headerError));
+        }
+        const qint64 headerSize = file.pos();
+        const int recordSize = header.recordSize();
+        if (recordSize > 0) keep = headerSize + (size - headerSize) / recordSize * recordSize;
+    } else {
+        keep = lastLineEnd(file, qMax<qint64>(checkpoint, 0), size);
+    }
+    file.close();
+
+    if (keep < size) {
+        if (!QFile::resize(path, keep)) {
+            return fail(error, QStringLiteral("无法截断文件: %1").arg(path));
+        }
+        if (removedBytes) *removedBytes = size - keep;
+    }
+    return true;
+}
+
+} // namespace Durability
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+// Durability: DataSaver 的落盘（fdatasync）与检查点
+//
+// 组提交：一次性把多个文件的数据同步到磁盘（Linux fdatasync / Windows FlushFileBuffers），
+// 全部成功后再给每个文件的检查点旁路文件 <文件名>.ckpt 追加一行并同步。
+// 检查点文件为 CSV：wall_us,bytes —— bytes 之前的数据在 wall_us 时刻已确认落盘，
+// 并且总在完整行/记录/压缩块的边界上。异常断电后恢复时只需检查最后一个检查点之后的尾部。
+namespace Durability {
+
+const char CHECKPOINT_SUFFIX[] = "ckpt";
+
+QString checkpointPath(const QString& path);
+
+// 一个待同步的数据文件及其检查点文件（checkpoint 为空或未打开时不写检查点）
+struct SyncTarget {
+    QFile* file { nullptr };
+    QFile* checkpoint { nullptr };
+};
+
+// 把 file 已写出的数据同步到磁盘（不含文件系统元数据中与读取无关的部分）
+bool syncFile(QFile& file);
+
+// 组提交：先同步全部数据文件，再逐个追加检查点（检查点记录的是同步时的文件长度）
+bool commitGroup(const QVector<SyncTarget>& targets, QString* error = nullptr);
+
+// 读取最后一个完整的检查点，返回已确认落盘的字节数；无检查点返回 -1
+qint64 lastCheckpoint(const QString& path);
+
+// 截掉异常中断留下的不完整尾部：只检查最后一个检查点之后的数据。
+// 按扩展名判断内容：.sgz 保留完整压缩块，.bin 保留完整记录，其余按文本保留到最后一个换行。
+// removedBytes 返回截掉的字节数。
+bool recoverFile(const QString& path, qint64* removedBytes = nullptr, QString* error = nullptr);
+
+} // namespace Durability
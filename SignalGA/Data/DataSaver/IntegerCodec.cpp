@@ -0,0 +1,246 @@
+#include "IntegerCodec.h"
+
+#include <limits>
+
+namespace IntegerCodec {
+
+namespace {
+
+inline char* putVarint(char* p, quint64 v) {
+    // 绝大多数差值小于 128，单字节路径放在最前
+    if (v < 0x80) {
+        *p++ = static_cast<char>(v);
+        return p;
+    }
+    while (v >= 0x80) {
+        *p++ = static_cast<char>(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<char>(v);
+    return p;
+}
+
+// 剩余字节足够一个最长 varint 时不做边界检查
+inline const char* getVarintUnchecked(const char* p, quint64& v) {
+    quint64 b = static_cast<quint8>(*p++);
+    if (b < 0x80) {
+        v = b;
+        return p;
+    }
+    quint64 result = b & 0x7f;
+    for (int shift = 7; shift < 70; shift += 7) {
+        b = static_cast<quint8>(*p++);
+        result |= (b & 0x7f) << shift;
+        if (b < 0x80) {
+            v = result;
+            return p;
+        }
+    }
+    return nullptr; // 超过 10 字节：数据损坏
+}
+
+inline const char* getVarint(const char* p, const char* end, quint64& v) {
+    if (end - p >= MAX_VARINT_BYTES) return getVarintUnchecked(p, v);
+    quint64 result = 0;
+    for (int shift = 0; p < end && shift < 70; shift += 7) {
+        const quint64 b = static_cast<quint8>(*p++);
+        result |= (b & 0x7f) << shift;
+        if (b < 0x80) {
+            v = result;
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+inline int bitWidth(quint64 v) {
+    int w = 0;
+    while (v != 0) {
+        ++w;
+        v >>= 1;
+    }
+    return w;
+}
+
+// 一帧：位宽取帧内最大值的有效位数；每值按不超过 32 位的片段写入，累加器不会溢出
+char* putFrame(char* p, const quint64* u, int n) {
+    quint64 all = 0;
+    for (int i = 0; i < n; ++i) all |= u[i];
+    const int width = bitWidth(all);
+    *p++ = static_cast<char>(width);
+    quint64 acc = 0;
+    int bits = 0;
+    for (int i = 0; i < n; ++i) {
+        quint64 v = u[i];
+        for (int left = width; left > 0;) {
+            const int take = left < 32 ? left : 32;
+            acc |= (v & ((quint64(1) << take) - 1)) << bits;
+            bits += take;
+            v >>= take;
+            left -= take;
+            while (bits >= 8) {
+                *p++ = static_cast<char>(acc);
+                acc >>= 8;
+                bits -= 8;
+            }
+        }
+    }
+    if (bits > 0) *p++ = static_cast<char>(acc);
+    return p;
+}
+
+const char* getFrame(const char* p, const char* end, quint64* u, int n) {
+    if (p >= end) return nullptr;
+    const int width = static_cast<quint8>(*p++);
+    if (width > 64 || (end - p) < (qint64(n) * width + 7) / 8) return nullptr;
+    quint64 acc = 0;
+    int bits = 0;
+    for (int i = 0; i < n; ++i) {
+        quint64 v = 0;
+        int got = 0;
+        for (int left = width; left > 0;) {
+            const int take = left < 32 ? left : 32;
+            while (bits < take) {
+                acc |= quint64(static_cast<quint8>(*p++)) << bits;
+                bits += 8;
+            }
+            v |= (acc & ((quint64(1) << take) - 1)) << got;
+            acc >>= take;
+            bits -= take;
+            got += take;
+            left -= take;
+        }
+        u[i] = v;
+    }
+    return p;
+}
+
+inline bool isBitPacked(Mode mode) {
+    return mode == Mode::DeltaBitPacked || mode == Mode::DeltaOfDeltaBitPacked;
+}
+
+inline bool isDeltaOfDelta(Mode mode) {
+    return mode == Mode::DeltaOfDelta || mode == Mode::DeltaOfDeltaBitPacked;
+}
+
+// 差分在 64 位无符号域上计算（按模回绕），任意输入都能精确还原
+template <typename T>
+int encodeImpl(const T* values, int count, Mode mode, char* dst) {
+    if (count <= 0) return 0;
+    char* p = dst;
+    quint64 prev = static_cast<quint64>(static_cast<qint64>(values[0]));
+    p = putVarint(p, zigzag(static_cast<qint64>(prev)));
+    if (isBitPacked(mode)) {
+        const bool dod = isDeltaOfDelta(mode);
+        quint64 frame[BITPACK_FRAME];
+        int n = 0;
+        quint64 prevDelta = 0;
+        for (int i = 1; i < count; ++i) {
+            const quint64 cur = static_cast<quint64>(static_cast<qint64>(values[i]));
+            const quint64 delta = cur - prev;
+            frame[n++] = zigzag(static_cast<qint64>(dod ? delta - prevDelta : delta));
+            prevDelta = delta;
+            prev = cur;
+            if (n == BITPACK_FRAME) {
+                p = putFrame(p, frame, n);
+                n = 0;
+            }
+        }
+        if (n > 0) p = putFrame(p, frame, n);
+    } else if (mode == Mode::Delta) {
+        for (int i = 1; i < count; ++i) {
+            const quint64 cur = static_cast<quint64>(static_cast<qint64>(values[i]));
+            p = putVarint(p, zigzag(static_cast<qint64>(cur - prev)));
+            prev = cur;
+        }
+    } else {
+        quint64 prevDelta = 0;
+        for (int i = 1; i < count; ++i) {
+            const quint64 cur = static_cast<quint64>(static_cast<qint64>(values[i]));
+            const quint64 delta = cur - prev;
+            p = putVarint(p, zigzag(static_cast<qint64>(delta - prevDelta)));
+            prevDelta = delta;
+            prev = cur;
+        }
+    }
+    return static_cast<int>(p - dst);
+}
+
+template <typename T>
+int decodeImpl(const char* src, int size, int count, Mode mode, T* values) {
+    if (count <= 0) return 0;
+    const char* p = src;
+    const char* end = src + size;
+    quint64 u = 0;
+    if (!(p = getVarint(p, end, u))) return -1;
+    quint64 prev = static_cast<quint64>(unzigzag(u));
+    values[0] = static_cast<T>(static_cast<qint64>(prev));
+    if (isBitPacked(mode)) {
+        const bool dod = isDeltaOfDelta(mode);
+        quint64 frame[BITPACK_FRAME];
+        quint64 prevDelta = 0;
+        for (int i = 1; i < count;) {
+            const int n = count - i < BITPACK_FRAME ? count - i : BITPACK_FRAME;
+            if (!(p = getFrame(p, end, frame, n))) return -1;
+            for (int k = 0; k < n; ++k, ++i) {
+                const quint64 d = static_cast<quint64>(unzigzag(frame[k]));
+                prevDelta = dod ? prevDelta + d : d;
+                prev += prevDelta;
+                values[i] = static_cast<T>(static_cast<qint64>(prev));
+            }
+        }
+    } else if (mode == Mode::Delta) {
+        for (int i = 1; i < count; ++i) {
+            if (!(p = getVarint(p, end, u))) return -1;
+            prev += static_cast<quint64>(unzigzag(u));
+            values[i] = static_cast<T>(static_cast<qint64>(prev));
+        }
+    } else {
+        quint64 prevDelta = 0;
+        for (int i = 1; i < count; ++i) {
+            if (!(p = getVarint(p, end, u))) return -1;
+            prevDelta += static_cast<quint64>(unzigzag(u));
+            prev += prevDelta;
+            values[i] = static_cast<T>(static_cast<qint64>(prev));
+        }
+    }
+    return static_cast<int>(p - src);
+}
+
+template <typename T>
+int appendImpl(const T* values, int count, Mode mode, QByteArray& out) {
+    const int offset = out.size();
+    if (offset + maxEncodedSize(count) > std::numeric_limits<int>::max()) return -1;
+    out.resize(static_cast<int>(offset + maxEncodedSize(count)));
+    const int n = encodeImpl(values, count, mode, out.data() + offset);
+    out.resize(offset + n);
+    return n;
+}
+
+} // namespace
+
+int encode(const qint64* values, int count, Mode mode, char* dst) {
+    return encodeImpl(values, count, mode, dst);
+}
+
+int encode(const qint32* values, int count, Mode mode, char* dst) {
+    return encodeImpl(values, count, mode, dst);
+}
+
+int encode(const qint64* values, int count, Mode mode, QByteArray& out) {
+    return appendImpl(values, count, mode, out);
+}
+
+int encode(const qint32* values, int count, Mode mode, QByteArray& out) {
+    return appendImpl(values, count, mode, out);
+}
+
+int decode(const char* src, int size, int count, Mode mode, qint64* values) {
+    return decodeImpl(src, size, count, mode, values);
+}
+
+int decode(const char* src, int size, int count, Mode mode, qint32* values) {
+    return decodeImpl(src, size, count, mode, values);
+}
+
+} // namespace IntegerCodec
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QByteArray>
+#include <QtGlobal>
+
+// IntegerCodec: 整数时间序列编码（差分 + zigzag + varint）
+//
+// 适用于单调递增的时间戳（ts_us）与缓慢变化的原始计数（如 24 位力传感器读数）：
+//   Delta        第一个值原样，其后存相邻差值        —— 原始计数
+//   DeltaOfDelta 第一个值、第一个差值，其后存差值的差值 —— 近似等间隔的时间戳（恒定间隔时每个值只占 1 字节）
+// 每个数先做 zigzag 映射（小的负数变成小的正数），再按 LEB128 varint 写出：每字节 7 位数据，最高位为续位标志。
+// *BitPacked 模式差分方式相同，但第一个值之后的差值按帧（每帧 BITPACK_FRAME 个）统一位宽紧凑排列：
+//   帧：u8 位宽 w（0..64），随后 ceil(n*w/8) 字节，值按小端位序依次排列
+// 噪声只有几个计数的信号每值只占几位，不受 varint 每值至少 1 字节的限制。
+// 编码结果不含长度信息，调用方需自行记录值个数。
+namespace IntegerCodec {
+
+enum class Mode : quint8 {
+    Delta = 1,
+    DeltaOfDelta = 2,
+    DeltaBitPacked = 3,
+    DeltaOfDeltaBitPacked = 4
+};
+
+// 单个值最多占 10 字节（按位打包时每值不超过 8 字节，另加每帧 1 字节位宽）
+const int MAX_VARINT_BYTES = 10;
+const int BITPACK_FRAME = 128;
+
+// 按 64 位计算，调用方据此分配缓冲区前应检查是否超出目标容器的容量
+inline qint64 maxEncodedSize(qint64 count) {
+    return count * MAX_VARINT_BYTES;
+}
+
+inline quint64 zigzag(qint64 v) {
+    return (static_cast<quint64>(v) << 1) ^ static_cast<quint64>(v >> 63);
+}
+
+inline qint64 unzigzag(quint64 u) {
+    return static_cast<qint64>(u >> 1) ^ -static_cast<qint64>(u & 1);
+}
+
+// 编码 count 个值到 dst（容量至少 maxEncodedSize(count)），返回写入的字节数
+int encode(const qint64* values, int count, Mode mode, char* dst);
+int encode(const qint32* values, int count, Mode mode, char* dst);
+
+// 追加到 out 末尾，返回写入的字节数；结果可能超出 QByteArray 容量时不写入并返回 -1
+int encode(const qint64* values, int count, Mode mode, QByteArray& out);
+int encode(const qint32* values, int count, Mode mode, QByteArray& out);
+
+// 从 src（size 字节）解码 count 个值，返回消耗的字节数；数据不足或损坏返回 -1。
+// qint32 版本要求原始数据在 32 位范围内（由 qint32 编码得到）。
+int decode(const char* src, int size, int count, Mode mode, qint64* values);
+int decode(const char* src, int size, int count, Mode mode, qint32* values);
+
+} // namespace IntegerCodec
@@ -0,0 +1,331 @@
+#include "RecordReader.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "BlockCompression.h"
+#include "CsvFormat.h"
+
+namespace {
+
+bool fail(QString* error, const QString& message) {
+    if (error) *error = message;
+    return false;
+}
+
+// 跳到一行中第 column 个字段的开头（字段可带引号），line 之后至多到 end
+const char* csvField(const char* p, const char* end, int column) {
+    for (int c = 0; c < column && p < end; ++c) {
+        if (*p == '"') {
+            // 引号字段：成对的 "" 为转义引号
+            for (++p; p < end; ++p) {
+                if (*p == '"') {
+                    if (p + 1 < end && p[1] == '"') ++p;
+                    else break;
+                }
+            }
+        }
+        while (p < end && *p != ',' && *p != '\n') ++p;
+        if (p < end && *p == ',') ++p;
+        else return end;
+    }
+    return p;
+}
+
+// 解析整数时间戳；遇到小数点或指数时按浮点解析后取整
+qint64 parseTimestamp(const char* p, const char* end) {
+    if (p < end && *p == '"') ++p;
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    qint64 v = 0;
+    while (p < end && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+    if (p < end && (*p == '.' || *p == 'e' || *p == 'E')) {
+        char buf[64];
+        const int n = static_cast<int>(qMin<qint64>(end - start, sizeof(buf) - 1));
+        std::memcpy(buf, start, n);
+        buf[n] = '\0';
+        return qRound64(std::strtod(buf, nullptr));
+    }
+    return negative ? -v : v;
+}
+
+} // namespace
+
+RecordReader::~RecordReader() {
+    close();
+}
+
+QString RecordReader::indexPath() const {
+    return m_file.fileName() + QStringLiteral(".tsidx");
+}
+
+bool RecordReader::open(const QString& path, const QString& timestampColumn, int stride, QString* error) {
+    close();
+    if (path.endsWith(QStringLiteral(".") + QString::fromLatin1(BlockCompression::FILE_SUFFIX))) {
+        return fail(error, QStringLiteral("压缩文件需先解压（tools/BinToCsv）: %1").arg(path));
+    }
+    m_stride = stride < 1 ? 1 : stride;
+    m_tsName = timestampColumn;
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(error, QStringLiteral("无法打开文件: %1").arg(path));
+    }
+    m_size = m_file.size();
+    if (m_size == 0) {
+        close();
+        return fail(error, QStringLiteral("文件为空: %1").arg(path));
+    }
+    m_data = reinterpret_cast<const char*>(m_file.map(0, m_size));
+    if (!m_data) {
+        const QString message = QStringLiteral("无法映射文件: %1 (%2)").arg(path, m_file.errorString());
+        close();
+        return fail(error, message);
+    }
+
+    const bool binary = m_size >= static_cast<qint64>(sizeof(BinaryFormat::MAGIC))
+        && std::memcmp(m_data, BinaryFormat::MAGIC, sizeof(BinaryFormat::MAGIC)) == 0;
+    m_format = binary ? Format::Binary : Format::Csv;
+    const bool ok = binary ? openBinary(error) : openCsv(timestampColumn, error);
+    if (!ok) {
+        close();
+        return false;
+    }
+    if (binary && !m_columns.contains(timestampColumn)) {
+        close();
+        return fail(error, QStringLiteral("找不到时间戳列 %1: %2").arg(timestampColumn, path));
+    }
+    if (binary) {
+        for (const BinaryFormat::Column& c : m_header.columns) {
+            if (c.name == timestampColumn) {
+                m_tsType = c.type;
+                break;
+            }
+            m_tsOffset += BinaryFormat::columnWidth(c.type);
+        }
+    }
+    buildIndex();
+    return true;
+}
+
+bool RecordReader::openBinary(QString* error) {
+    QString headerError;
+    if (!BinaryFormat::readHeader(m_file, m_header, &headerError)) {
+        return fail(error, QStringLiteral("%1: %2").arg(m_file.fileName(), headerError));
+    }
+    m_recordSize = m_header.recordSize();
+    if (m_recordSize <= 0) {
+        return fail(error, QStringLiteral("文件未定义任何列: %1").arg(m_file.fileName()));
+    }
+    for (const BinaryFormat::Column& c : m_header.columns) m_columns.append(c.name);
+    m_dataStart = m_file.pos();
+    m_rowCount = (m_size - m_dataStart) / m_recordSize;
+    m_dataEnd = m_dataStart + m_rowCount * m_recordSize;
+    return true;
+}
+
+bool RecordReader::openCsv(const QString& timestampColumn, QString* error) {
+    const char* nl = static_cast<const char*>(std::memchr(m_data, '\n', static_cast<size_t>(m_size)));
+    if (!nl) {
+        return fail(error, QStringLiteral("缺少表头: %1").arg(m_file.fileName()));
+    }
+    m_dataStart = nl - m_data + 1;
+    // 表头字段可能带引号（CsvFormat::appendField 的输出）
+    QByteArray name;
+    bool quoted = false;
+    for (const char* p = m_data; p <= nl; ++p) {
+        if (quoted) {
+            if (*p != '"') name.append(*p);
+            else if (p + 1 < nl && p[1] == '"') name.append(*p++);
+            else quoted = false;
+        } else if (*p == '"') {
+            quoted = true;
+        } else if (*p == ',' || p == nl) {
+            m_columns.append(QString::fromUtf8(name.trimmed()));
+            name.clear();
+        } else {
+            name.append(*p);
+        }
+    }
+    m_tsColumn = m_columns.indexOf(timestampColumn);
+    if (m_tsColumn < 0) {
+        return fail(error, QStringLiteral("找不到时间戳列 %1: %2").arg(timestampColumn, m_file.fileName()));
+    }
+    // 末尾没有换行的不完整行不计入
+    m_dataEnd = m_size;
+    while (m_dataEnd > m_dataStart && m_data[m_dataEnd - 1] != '\n') --m_dataEnd;
+    return true;
+}
+
+void RecordReader::close() {
+    if (m_data) m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+    m_file.close();
+    m_data = nullptr;
+    m_size = 0;
+    m_columns.clear();
+    m_dataStart = m_dataEnd = m_rowCount = 0;
+    m_index.clear();
+    m_tsColumn = 0;
+    m_tsName.clear();
+    m_header = BinaryFormat::Header();
+    m_recordSize = 0;
+    m_tsOffset = 0;
+}
+
+void RecordReader::buildIndex() {
+    const bool loaded = loadIndex();
+    const int before = m_index.size();
+    if (m_format == Format::Binary) {
+        // 定长记录：索引项直接按行号计算，无需扫描
+        for (qint64 row = m_index.isEmpty() ? 0 : m_index.last().row + m_stride; row < m_rowCount; row += m_stride) {
+            Position p;
+            p.row = row;
+            p.offset = m_dataStart + row * m_recordSize;
+            m_index.append({ p.row, p.offset, timestampAt(p) });
+        }
+    } else {
+        // 从最后一个索引项向后扫描：统计行数并补齐索引
+        Position p;
+        p.offset = m_dataStart;
+        if (!m_index.isEmpty()) {
+            p.row = m_index.last().row;
+            p.offset = m_index.last().offset;
+        }
+        while (p.offset < m_dataEnd) {
+            if (p.row % m_stride == 0 && (m_index.isEmpty() || p.row > m_index.last().row)) {
+                m_index.append({ p.row, p.offset, timestampAt(p) });
+            }
+            p = next(p);
+        }
+        m_rowCount = p.row;
+    }
+    if (!loaded || m_index.size() != before) {
+        saveIndex(); // 只读目录等写不了索引时不影响查询
+    }
+}
+
+bool RecordReader::loadIndex() {
+    m_index.clear();
+    QFile idx(indexPath());
+    if (!idx.open(QIODevice::ReadOnly)) return false;
+    const QByteArray text = idx.readAll();
+    QList<QByteArray> lines = text.split('\n');
+    if (!text.endsWith('\n')) lines.removeLast(); // 写到一半的最后一行
+    if (lines.isEmpty() || lines.first() + '\n' != indexHeader()) return false;
+
+    QVector<IndexEntry> entries;
+    for (int i = 1; i < lines.size(); ++i) { // 第一行为表头
+        if (lines[i].isEmpty()) continue;
+        const QList<QByteArray> f = lines[i].split(',');
+        if (f.size() != 3) return false;
+        IndexEntry e;
+        e.row = f[0].toLongLong();
+        e.offset = f[1].toLongLong();
+        e.ts = f[2].toLongLong();
+        // 每 stride 行一项，且落在当前文件的完整数据内
+        if (e.row != qint64(entries.size()) * m_stride || e.offset < m_dataStart || e.offset >= m_dataEnd) return false;
+        if (m_format == Format::Binary && e.offset != m_dataStart + e.row * m_recordSize) return false;
+        if (m_format == Format::Csv && e.offset != m_dataStart && m_data[e.offset - 1] != '\n') return false;
+        entries.append(e);
+    }
+    if (entries.isEmpty()) return false;
+    // 抽查首尾两项的时间戳，防止文件被替换后沿用旧索引
+    for (const IndexEntry* e : { &entries.first(), &entries.last() }) {
+        Position p;
+        p.row = e->row;
+        p.offset = e->offset;
+        if (timestampAt(p) != e->ts) return false;
+    }
+    m_index = entries;
+    return true;
+}
+
+QByteArray RecordReader::indexHeader() const {
+    QByteArray text("row,offset,");
+    CsvFormat::appendField(text, m_tsName);
+    text.append('\n');
+    return text;
+}
+
+bool RecordReader::saveIndex() const {
+    QFile idx(indexPath());
+    if (!idx.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    QByteArray text = indexHeader();
+    for (const IndexEntry& e : m_index) {
+        CsvFormat::appendInt(text, e.row);
+        text.append(',');
+        CsvFormat::appendInt(text, e.offset);
+        text.append(',');
+        CsvFormat::appendInt(text, e.ts);
+        text.append('\n');
+    }
+    return idx.write(text) == text.size();
+}
+
+qint64 RecordReader::timestampAt(const Position& p) const {
+    if (m_format == Format::Binary) {
+        return BinaryFormat::getInt(m_data + p.offset + m_tsOffset, m_tsType);
+    }
+    const char* end = m_data + m_dataEnd;
+    return parseTimestamp(csvField(m_data + p.offset, end, m_tsColumn), end);
+}
+
+RecordReader::Position RecordReader::next(const Position& p) const {
+    Position n;
+    n.row = p.row + 1;
+    if (m_format == Format::Binary) {
+        n.offset = p.offset + m_recordSize;
+    } else {
+        const char* nl = static_cast<const char*>(
+            std::memchr(m_data + p.offset, '\n', static_cast<size_t>(m_dataEnd - p.offset)));
+        n.offset = nl ? nl - m_data + 1 : m_dataEnd;
+    }
+    return n;
+}
+
+qint64 RecordReader::timestampAt(qint64 row) const {
+    if (row < 0 || row >= m_rowCount) return 0;
+    Position p;
+    if (m_format == Format::Binary) {
+        p.row = row;
+        p.offset = m_dataStart + row * m_recordSize;
+        return timestampAt(p);
+    }
+    const IndexEntry& e = m_index[static_cast<int>(row / m_stride)];
+    p.row = e.row;
+    p.offset = e.offset;
+    while (p.row < row) p = next(p);
+    return timestampAt(p);
+}
+
+RecordReader::Position RecordReader::seek(qint64 t, bool after) const {
+    const auto before = [=](qint64 ts) { return after ? ts <= t : ts < t; };
+    // 二分找到第一个不在目标之前的索引项，从它的前一项开始顺序扫描（至多 stride 行）
+    int lo = 0;
+    int hi = m_index.size();
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (before(m_index[mid].ts)) lo = mid + 1;
+        else hi = mid;
+    }
+    Position p;
+    p.offset = m_dataStart;
+    if (lo > 0) {
+        p.row = m_index[lo - 1].row;
+        p.offset = m_index[lo - 1].offset;
+    }
+    while (p.row < m_rowCount && before(timestampAt(p))) p = next(p);
+    return p;
+}
+
+RecordReader::Range RecordReader::find(qint64 fromUs, qint64 toUs) const {
+    Range r;
+    if (!m_data || m_rowCount == 0 || fromUs > toUs) return r;
+    const Position first = seek(fromUs, false);
+    const Position end = seek(toUs, true);
+    r.firstRow = first.row;
+    r.begin = first.offset;
+    r.endRow = qMax(first.row, end.row);
+    r.end = qMax(first.offset, end.offset);
+    return r;
+}
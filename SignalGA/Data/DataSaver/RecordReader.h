@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "BinaryFormat.h"
+
+// RecordReader: 读取 DataSaver 录制的文件（<group>.csv / <group>.bin），按时间戳区间查询
+//
+// 文件以只读方式整体内存映射，查询结果直接指向映射区，不复制数据。
+// 时间戳列（默认 ts_us）须按行单调不减。打开时建立稀疏索引：每 stride 行记一条（行号、字节偏移、时间戳），
+// 保存在旁路文件 <文件名>.tsidx（CSV：row,offset,<时间戳列名>），下次打开直接加载；
+// 文件在此之后追加的数据只扫描新增部分补齐索引。区间查询先在索引上二分，再在至多 stride 行内顺序定位，
+// 复杂度 O(log n + stride)，与结果行数无关。
+// 只映射打开时的文件长度；CSV 末尾不完整的行、二进制末尾不完整的记录不计入。压缩文件（.sgz）须先解压。
+class RecordReader {
+public:
+    enum class Format {
+        Csv,
+        Binary
+    };
+
+    // 查询结果：行号区间 [firstRow, endRow) 与对应的字节区间 [begin, end)（相对 data()）
+    struct Range {
+        qint64 firstRow { 0 };
+        qint64 endRow { 0 };
+        qint64 begin { 0 };
+        qint64 end { 0 };
+        qint64 rows() const { return endRow - firstRow; }
+    };
+
+    RecordReader() = default;
+    ~RecordReader();
+    RecordReader(const RecordReader&) = delete;
+    RecordReader& operator=(const RecordReader&) = delete;
+
+    bool open(const QString& path, const QString& timestampColumn = QStringLiteral("ts_us"),
+              int stride = 1024, QString* error = nullptr);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    Format format() const { return m_format; }
+    QString fileName() const { return m_file.fileName(); }
+    QStringList columns() const { return m_columns; }
+    qint64 rowCount() const { return m_rowCount; }
+
+    // 映射区起始地址与长度；Range 的字节偏移相对于此
+    const char* data() const { return m_data; }
+    qint64 size() const { return m_size; }
+
+    // 时间戳在 [fromUs, toUs] 内的全部行
+    Range find(qint64 fromUs, qint64 toUs) const;
+    // 第 row 行的时间戳（CSV 需从最近的索引项向后扫描，至多 stride 行）
+    qint64 timestampAt(qint64 row) const;
+
+    // 仅二进制格式：文件头与按行号直接访问记录（指向映射区，用 BinaryFormat::get* 读取各列）
+    const BinaryFormat::Header& header() const { return m_header; }
+    int recordSize() const { return m_recordSize; }
+    const char* record(qint64 row) const { return m_data + m_dataStart + row * m_recordSize; }
+
+    QString indexPath() const;
+
+private:
+    struct IndexEntry {
+        qint64 row { 0 };
+        qint64 offset { 0 };
+        qint64 ts { 0 };
+    };
+    // 行位置：行号与行首字节偏移
+    struct Position {
+        qint64 row { 0 };
+        qint64 offset { 0 };
+    };
+
+    bool openBinary(QString* error);
+    bool openCsv(const QString& timestampColumn, QString* error);
+    // 加载旁路索引并扫描其后新增的行；索引有变化时写回
+    void buildIndex();
+    bool loadIndex();
+    bool saveIndex() const;
+    QByteArray indexHeader() const;
+
+    qint64 timestampAt(const Position& p) const;
+    Position next(const Position& p) const;
+    // 第一个 ts >= t（after 为 false）或 ts > t（after 为 true）的行
+    Position seek(qint64 t, bool after) const;
+
+    QFile m_file;
+    const char* m_data { nullptr };
+    qint64 m_size { 0 };
+    Format m_format { Format::Csv };
+    QStringList m_columns;
+    QString m_tsName;
+    int m_stride { 1024 };
+    qint64 m_dataStart { 0 };   // 第一行数据的偏移
+    qint64 m_dataEnd { 0 };     // 最后一个完整行/记录的结束偏移
+    qint64 m_rowCount { 0 };
+    QVector<IndexEntry> m_index;
+
+    // CSV
+    int m_tsColumn { 0 };
+    // 二进制
+    BinaryFormat::Header m_header;
+    int m_recordSize { 0 };
+    int m_tsOffset { 0 };
+    BinaryFormat::ColumnType m_tsType { BinaryFormat::ColumnType::Int64 };
+};
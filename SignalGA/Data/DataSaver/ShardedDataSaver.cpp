@@ -0,0 +1,440 @@
+#include "ShardedDataSaver.h"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+#include <cstring>
+
+#include "SpscRing.h"
+
+namespace {
+
+// 每个生产者通往每个分片的在途暂存块上限
+const int LANE_CHUNKS = 16;
+// 分片一次从通道取出的暂存块数
+const int POP_BATCH = 8;
+// 分片空闲时的最长休眠（毫秒），生产者增减或漏掉唤醒时最多延迟这么久
+const int IDLE_WAIT_MS = 50;
+
+enum MessageType : qint32 {
+    RawBlock,
+    IntRows,
+    DoubleRows,
+    Flush
+};
+
+// 暂存块中的消息头，其后为 bytes 字节负载，补齐到 8 字节：QByteArray 数据区按 8 字节对齐，
+// 每条消息与 double 负载因此都保持对齐，分片可直接按数组读取
+struct Message {
+    qint32 stream;
+    qint32 type;
+    qint32 rows;
+    qint32 columns;
+    qint32 precision;
+    qint32 bytes;
+};
+static_assert(sizeof(Message) % 8 == 0, "消息头须保持 8 字节对齐");
+
+int padded(int bytes) {
+    return (bytes + 7) & ~7;
+}
+
+// 暂存块大小与单条消息负载的上限：块内偏移 + 消息头 + 负载始终在 QByteArray 的 int 容量之内
+const int MAX_STAGING_BYTES = 256 * 1024 * 1024;
+const int MAX_PAYLOAD_BYTES = 1024 * 1024 * 1024;
+
+// rows × columns 个元素的负载字节数，在 size_t 中计算；超出单条消息上限时返回 -1
+int payloadBytes(int rows, int columns, size_t elementSize) {
+    const size_t limit = static_cast<size_t>(MAX_PAYLOAD_BYTES) / elementSize;
+    if (static_cast<size_t>(rows) > limit / static_cast<size_t>(columns)) return -1;
+    return static_cast<int>(static_cast<size_t>(rows) * static_cast<size_t>(columns) * elementSize);
+}
+
+} // namespace
+
+struct ShardedDataSaver::Chunk {
+    QByteArray data;
+};
+
+// 一个生产者通往一个分片的通道：full 由生产者写、分片读；free 由分片写、生产者读
+struct ShardedDataSaver::Lane {
+    explicit Lane(Shard* s)
+        : full(LANE_CHUNKS, TCM::RingOverflowPolicy::Block)
+        // 分配的块总数不超过 LANE_CHUNKS + 2（在途、分片正在处理、暂存），free 永远不会满
+        , free(2 * LANE_CHUNKS, TCM::RingOverflowPolicy::Block)
+        , shard(s) {
+    }
+    ~Lane() { qDeleteAll(chunks); }
+
+    TCM::SpscRing<Chunk*> full;
+    TCM::SpscRing<Chunk*> free;
+    Shard* const shard;
+    Chunk* staging { nullptr };
+    QVector<Chunk*> chunks; // 本通道分配过的全部块，随通道释放
+};
+
+// 分片写入线程：独占一个 DataSaver，按通道取出暂存块并解码写入
+class ShardedDataSaver::Shard : public QThread {
+public:
+    Shard(ShardedDataSaver* owner, int index)
+        : m_owner(owner)
+        , m_index(index) {
+    }
+
+    void requestStart() {
+        m_stopping.store(false, std::memory_order_release);
+        start();
+    }
+    void requestStop() {
+        m_stopping.store(true, std::memory_order_release);
+        QMutexLocker locker(&m_mutex);
+        m_wake.wakeOne();
+    }
+    // 生产者交出暂存块后调用：分片正在休眠时唤醒
+    void notify() {
+        // 与 run() 中的栅栏配对：要么分片看到新块，要么这里看到休眠标志
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleeping.load(std::memory_order_relaxed)) {
+            QMutexLocker locker(&m_mutex);
+            m_wake.wakeOne();
+        }
+    }
+
+protected:
+    void run() override;
+
+private:
+    static bool pending(const QVector<Lane*>& lanes);
+    void process(DataSaver& saver, const QByteArray& data);
+    // 全局句柄对应的本分片 DataSaver 句柄，第一次出现时打开文件
+    DataSaver::StreamId local(DataSaver& saver, StreamId id);
+
+    static constexpr DataSaver::StreamId Unopened = -2;
+
+    ShardedDataSaver* const m_owner;
+    const int m_index;
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    std::atomic<bool> m_sleeping { false };
+    std::atomic<bool> m_stopping { false };
+    QVector<DataSaver::StreamId> m_local; // 下标为全局句柄
+};
+
+void ShardedDataSaver::Shard::run() {
+    DataSaver saver;
+    QObject::connect(&saver, &DataSaver::errorOccurred, m_owner, &ShardedDataSaver::errorOccurred, Qt::DirectConnection);
+    if (m_owner->m_configure) m_owner->m_configure(saver);
+    m_local.clear();
+
+    QVector<Lane*> lanes;
+    int generation = -1;
+    Chunk* batch[POP_BATCH];
+    QElapsedTimer sinceSync;
+    sinceSync.start();
+    for (;;) {
+        // 先读停止标志再取数据：停止前交出的块在这一轮一定能取到
+        const bool stopping = m_stopping.load(std::memory_order_acquire);
+        const int current = m_owner->m_producerGeneration.load(std::memory_order_acquire);
+        if (current != generation) {
+            lanes = m_owner->lanes(m_index);
+            generation = current;
+        }
+
+        bool progress = false;
+        for (Lane* lane : lanes) {
+            std::size_t n;
+            while ((n = lane->full.popBatch(batch, POP_BATCH)) > 0) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    process(saver, batch[i]->data);
+                    batch[i]->data.resize(0);
+                    lane->free.push(batch[i]);
+                }
+                progress = true;
+            }
+        }
+
+        // 分片线程没有事件循环，落盘策略的定时组提交在这里补做
+        const int window = saver.durabilityWindowMs();
+        if (window > 0 && sinceSync.elapsed() >= window / 2) {
+            saver.syncAll();
+            sinceSync.restart();
+        }
+        if (progress) continue;
+        if (stopping) break;
+
+        QMutexLocker locker(&m_mutex);
+        m_sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!pending(lanes) && !m_stopping.load(std::memory_order_acquire)
+            && m_owner->m_producerGeneration.load(std::memory_order_acquire) == generation) {
+            m_wake.wait(&m_mutex, window > 0 ? qMax(1, qMin(window / 2, IDLE_WAIT_MS)) : IDLE_WAIT_MS);
+        }
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+    saver.closeAll();
+}
+
+bool ShardedDataSaver::Shard::pending(const QVector<Lane*>& lanes) {
+    for (const Lane* lane : lanes) {
+        if (lane->full.size() > 0) return true;
+    }
+    return false;
+}
+
+void ShardedDataSaver::Shard::process(DataSaver& saver, const QByteArray& data) {
+    const char* p = data.constData();
+    const char* const end = p + data.size();
+    while (p < end) {
+        Message m;
+        std::memcpy(&m, p, sizeof(Message));
+        const char* payload = p + sizeof(Message);
+        p = payload + padded(m.bytes);
+
+        const DataSaver::StreamId id = local(saver, m.stream);
+        if (id == DataSaver::InvalidStream) continue;
+        switch (m.type) {
+        case RawBlock:
+            saver.writeRawBlock(id, QByteArray::fromRawData(payload, m.bytes));
+            break;
+        case IntRows:
+            saver.writeIntRows(id, reinterpret_cast<const int*>(payload), m.rows, m.columns);
+            break;
+        case DoubleRows:
+            saver.writeDoubleRows(id, reinterpret_cast<const double*>(payload), m.rows, m.columns, m.precision);
+            break;
+        case Flush:
+            saver.flush(id);
+            break;
+        }
+    }
+}
+
+DataSaver::StreamId ShardedDataSaver::Shard::local(DataSaver& saver, StreamId id) {
+    if (id < m_local.size() && m_local[id] != Unopened) return m_local[id];
+    while (m_local.size() <= id) m_local.append(Unopened);
+    const StreamDef def = m_owner->streamDef(id);
+    // 打开失败时 DataSaver 已报错，记为无效，之后该流的数据直接丢弃
+    m_local[id] = def.binary ? saver.openBinaryStream(def.kind, def.group, def.columns, def.metadata)
+                             : saver.openStream(def.kind, def.group, def.header);
+    return m_local[id];
+}
+
+ShardedDataSaver::ShardedDataSaver(int shardCount, QObject* parent)
+    : QObject(parent)
+    , m_shardCount(qMax(1, shardCount)) {
+    for (int i = 0; i < m_shardCount; ++i) {
+        m_shards.append(new Shard(this, i));
+    }
+}
+
+ShardedDataSaver::~ShardedDataSaver() {
+    stop();
+    qDeleteAll(m_producers);
+    qDeleteAll(m_shards);
+}
+
+void ShardedDataSaver::configure(const std::function<void(DataSaver&)>& fn) {
+    m_configure = fn;
+}
+
+void ShardedDataSaver::setStagingBytes(int bytes) {
+    m_stagingBytes = qBound(4096, bytes, MAX_STAGING_BYTES);
+}
+
+void ShardedDataSaver::start() {
+    if (m_running) return;
+    for (Shard* shard : m_shards) {
+        shard->requestStart();
+    }
+    m_running = true;
+}
+
+void ShardedDataSaver::stop() {
+    if (!m_running) return;
+    m_running = false;
+    // 生产者已停止，可以在本线程代为交出其剩余暂存块
+    {
+        QMutexLocker locker(&m_producerMutex);
+        for (Producer* producer : m_producers) {
+            producer->publish();
+        }
+    }
+    for (Shard* shard : m_shards) {
+        shard->requestStop();
+    }
+    for (Shard* shard : m_shards) {
+        shard->wait();
+    }
+    QMutexLocker locker(&m_producerMutex);
+    qDeleteAll(m_producers);
+    m_producers.clear();
+    m_producerGeneration.fetch_add(1, std::memory_order_release);
+}
+
+ShardedDataSaver::StreamId ShardedDataSaver::openStream(const QString& kind, const QString& group, const QStringList& header) {
+    StreamDef def;
+    def.kind = kind;
+    def.group = group;
+    def.header = header;
+    return registerStream(def);
+}
+
+ShardedDataSaver::StreamId ShardedDataSaver::openBinaryStream(const QString& kind, const QString& group,
+                                                              const QVector<BinaryFormat::Column>& columns,
+                                                              const QVector<QPair<QString, QString>>& metadata) {
+    StreamDef def;
+    def.kind = kind;
+    def.group = group;
+    def.binary = true;
+    def.columns = columns;
+    def.metadata = metadata;
+    return registerStream(def);
+}
+
+ShardedDataSaver::StreamId ShardedDataSaver::registerStream(const StreamDef& def) {
+    if (def.kind.isEmpty() || def.group.isEmpty()) {
+        emit errorOccurred(QStringLiteral("kind 或 group 为空"));
+        return InvalidStream;
+    }
+    const QString key = def.kind + '|' + def.group;
+    QMutexLocker locker(&m_streamMutex);
+    const auto it = m_streamKeys.constFind(key);
+    if (it != m_streamKeys.constEnd()) return it.value();
+
+    const StreamId id = m_streams.size();
+    m_streams.append(def);
+    // 按注册顺序轮流分配，流数不多时各分片也能均衡
+    m_streams.last().shard = id % m_shardCount;
+    m_streamKeys.insert(key, id);
+    return id;
+}
+
+int ShardedDataSaver::shardOf(StreamId id) const {
+    QMutexLocker locker(&m_streamMutex);
+    return id >= 0 && id < m_streams.size() ? m_streams[id].shard : -1;
+}
+
+ShardedDataSaver::StreamDef ShardedDataSaver::streamDef(StreamId id) const {
+    QMutexLocker locker(&m_streamMutex);
+    return m_streams.value(id);
+}
+
+QVector<ShardedDataSaver::Lane*> ShardedDataSaver::lanes(int shard) const {
+    QMutexLocker locker(&m_producerMutex);
+    QVector<Lane*> result;
+    result.reserve(m_producers.size());
+    for (const Producer* producer : m_producers) {
+        result.append(producer->m_lanes[shard]);
+    }
+    return result;
+}
+
+ShardedDataSaver::Producer* ShardedDataSaver::createProducer() {
+    Producer* producer = new Producer(this, m_stagingBytes);
+    QMutexLocker locker(&m_producerMutex);
+    m_producers.append(producer);
+    m_producerGeneration.fetch_add(1, std::memory_order_release);
+    return producer;
+}
+
+ShardedDataSaver::Producer::Producer(ShardedDataSaver* owner, int stagingBytes)
+    : m_owner(owner)
+    , m_stagingBytes(stagingBytes) {
+    for (Shard* shard : owner->m_shards) {
+        m_lanes.append(new Lane(shard));
+    }
+}
+
+ShardedDataSaver::Producer::~Producer() {
+    qDeleteAll(m_lanes);
+}
+
+char* ShardedDataSaver::Producer::stage(StreamId id, int type, int rows, int columns, int precision, int bytes) {
+    if (bytes < 0) {
+        emit m_owner->errorOccurred(QStringLiteral("单次写入超出 %1 字节上限（%2 行 × %3 列），已拒绝")
+                                        .arg(MAX_PAYLOAD_BYTES).arg(rows).arg(columns));
+        return nullptr;
+    }
+    int shard = id >= 0 && id < m_shardCache.size() ? m_shardCache[id] : -1;
+    if (shard < 0) {
+        shard = m_owner->shardOf(id);
+        if (shard < 0) {
+            emit m_owner->errorOccurred(QStringLiteral("无效的流句柄: %1").arg(id));
+            return nullptr;
+        }
+        while (m_shardCache.size() <= id) m_shardCache.append(-1);
+        m_shardCache[id] = shard;
+    }
+
+    Lane* lane = m_lanes[shard];
+    if (!lane->staging) {
+        Chunk* chunk = nullptr;
+        if (lane->free.popBatch(&chunk, 1) == 0) {
+            chunk = new Chunk();
+            chunk->data.reserve(m_stagingBytes + 4096);
+            lane->chunks.append(chunk);
+        }
+        lane->staging = chunk;
+    }
+    m_current = lane;
+
+    QByteArray& data = lane->staging->data;
+    const int offset = data.size();
+    data.resize(offset + static_cast<int>(sizeof(Message)) + padded(bytes));
+    char* p = data.data() + offset;
+    const Message m { id, type, rows, columns, precision, bytes };
+    std::memcpy(p, &m, sizeof(Message));
+    return p + sizeof(Message);
+}
+
+void ShardedDataSaver::Producer::staged() {
+    if (m_current->staging->data.size() >= m_stagingBytes) publish(m_current);
+}
+
+void ShardedDataSaver::Producer::publish(Lane* lane) {
+    if (!lane->staging || lane->staging->data.isEmpty()) return;
+    // 满时等待分片腾出位置（背压）
+    lane->full.push(lane->staging);
+    lane->staging = nullptr;
+    lane->shard->notify();
+}
+
+bool ShardedDataSaver::Producer::writeRawBlock(StreamId id, const QByteArray& block) {
+    if (block.isEmpty()) return true;
+    char* p = stage(id, RawBlock, 0, 0, 0, block.size() > MAX_PAYLOAD_BYTES ? -1 : block.size());
+    if (!p) return false;
+    std::memcpy(p, block.constData(), static_cast<size_t>(block.size()));
+    staged();
+    return true;
+}
+
+bool ShardedDataSaver::Producer::writeIntRows(StreamId id, const int* data, int rows, int columns) {
+    if (rows <= 0 || columns <= 0) return true;
+    const int bytes = payloadBytes(rows, columns, sizeof(int));
+    char* p = stage(id, IntRows, rows, columns, 0, bytes);
+    if (!p) return false;
+    std::memcpy(p, data, static_cast<size_t>(bytes));
+    staged();
+    return true;
+}
+
+bool ShardedDataSaver::Producer::writeDoubleRows(StreamId id, const double* data, int rows, int columns, int precision) {
+    if (rows <= 0 || columns <= 0) return true;
+    const int bytes = payloadBytes(rows, columns, sizeof(double));
+    char* p = stage(id, DoubleRows, rows, columns, precision, bytes);
+    if (!p) return false;
+    std::memcpy(p, data, static_cast<size_t>(bytes));
+    staged();
+    return true;
+}
+
+void ShardedDataSaver::Producer::flush(StreamId id) {
+    if (stage(id, Flush, 0, 0, 0, 0)) publish();
+}
+
+void ShardedDataSaver::Producer::publish() {
+    for (Lane* lane : m_lanes) {
+        publish(lane);
+    }
+}
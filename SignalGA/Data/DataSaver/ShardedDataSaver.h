@@ -0,0 +1,138 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QPair>
+#include <atomic>
+#include <functional>
+
+#include "BinaryFormat.h"
+#include "DataSaver.h"
+
+// ShardedDataSaver: 供多个生产者线程同时写入的 DataSaver
+//
+// 流（kind/group）注册时按注册顺序轮流固定分到 shardCount 个分片，每个分片一个写入线程，线程内独占一个 DataSaver，
+// DataSaver 本身仍不加锁。每个生产者线程用 createProducer() 取得私有的 Producer：写入先编码进生产者自己的
+// 暂存块，暂存块满或调用 publish()/flush() 时经无锁单生产者/单消费者环形缓冲区（TCM::SpscRing）整块交给分片，
+// 分片写完后把块还给该生产者复用。生产者之间不共享可写状态，写入路径上没有锁；
+// 只有分片线程空闲休眠时，交出暂存块的生产者需要加锁唤醒它。
+//
+// 顺序：同一流只在一个分片中写入，同一生产者对同一流的写入按调用顺序落盘。多个生产者写同一流时，
+// 各自的写入以暂存块为单位交错（块内连续），不保证跨生产者的先后。
+// 背压：分片跟不上时，每个生产者对每个分片至多有 16 个在途暂存块，超出时交出暂存块的生产者等待。
+class ShardedDataSaver : public QObject {
+    Q_OBJECT
+public:
+    using StreamId = int;
+    static constexpr StreamId InvalidStream = -1;
+
+    class Producer;
+
+    explicit ShardedDataSaver(int shardCount = 2, QObject* parent = nullptr);
+    ~ShardedDataSaver() override;
+
+    int shardCount() const { return m_shardCount; }
+
+    // 各分片 DataSaver 的配置（根目录、格式、压缩、落盘策略等），在 start() 时于分片线程中对每个分片执行一次
+    void configure(const std::function<void(DataSaver&)>& fn);
+    // 暂存块大小（字节，默认 64KB，限制在 4KB~256MB），只影响之后创建的生产者
+    void setStagingBytes(int bytes);
+
+    // 启动分片线程；生产者须在 start() 之后写入
+    void start();
+    // 停止：交出各生产者剩余的暂存数据，等待分片写完并关闭全部文件。
+    // 调用前所有生产者须已停止写入；生产者随之销毁
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    // 注册流，可在任意线程调用（加锁，只在打开时调用一次），返回的句柄对所有生产者有效。
+    // 文件在分片第一次收到该流的数据时打开，参数含义同 DataSaver::openStream/openBinaryStream
+    StreamId openStream(const QString& kind, const QString& group, const QStringList& header = {});
+    StreamId openBinaryStream(const QString& kind, const QString& group,
+                              const QVector<BinaryFormat::Column>& columns,
+                              const QVector<QPair<QString, QString>>& metadata = {});
+    // 流所在的分片
+    int shardOf(StreamId id) const;
+
+    // 为调用线程创建生产者（任意线程调用）：只能由一个线程使用，归本对象所有，stop() 后失效
+    Producer* createProducer();
+
+signals:
+    void errorOccurred(const QString& message);
+
+private:
+    struct Chunk;
+    struct Lane;
+    class Shard;
+
+    struct StreamDef {
+        QString kind;
+        QString group;
+        bool binary { false };
+        QStringList header;
+        QVector<BinaryFormat::Column> columns;
+        QVector<QPair<QString, QString>> metadata;
+        int shard { 0 };
+    };
+
+    StreamId registerStream(const StreamDef& def);
+    // 分片线程：取流定义（加锁，每个分片每个流一次）
+    StreamDef streamDef(StreamId id) const;
+    // 分片线程：取所有生产者通往该分片的通道
+    QVector<Lane*> lanes(int shard) const;
+
+    const int m_shardCount;
+    int m_stagingBytes { 64 * 1024 };
+    std::function<void(DataSaver&)> m_configure;
+    bool m_running { false };
+    QVector<Shard*> m_shards;       // 构造时创建，start/stop 启停其线程
+
+    mutable QMutex m_streamMutex;
+    QVector<StreamDef> m_streams;
+    QHash<QString, StreamId> m_streamKeys;
+
+    mutable QMutex m_producerMutex;
+    QVector<Producer*> m_producers;
+    std::atomic<int> m_producerGeneration { 0 }; // 生产者增减时递增，分片据此刷新通道列表
+};
+
+// 生产者：只能由创建它的线程使用。写入接口与 DataSaver 的同名接口含义相同，
+// 数据先进暂存块，返回 true 只表示已暂存（文件错误经 errorOccurred 报告）。
+// 单次写入的数据超过 1GB 时拒绝并返回 false
+class ShardedDataSaver::Producer {
+public:
+    ~Producer();
+    Producer(const Producer&) = delete;
+    Producer& operator=(const Producer&) = delete;
+
+    // block 为已编码的 UTF-8 多行文本，原样追加
+    bool writeRawBlock(StreamId id, const QByteArray& block);
+    // 行主序矩阵：data[r * columns + c]
+    bool writeIntRows(StreamId id, const int* data, int rows, int columns);
+    bool writeDoubleRows(StreamId id, const double* data, int rows, int columns, int precision = 6);
+    // 交出全部暂存块，并要求分片把该流的缓冲写出
+    void flush(StreamId id);
+    // 把全部暂存块交给分片（不要求写出文件缓冲）；低速写入时定期调用以控制延迟
+    void publish();
+
+private:
+    friend class ShardedDataSaver;
+    Producer(ShardedDataSaver* owner, int stagingBytes);
+
+    // 在对应分片的暂存块末尾预留一条消息，返回负载起始地址；句柄无效时报错返回空
+    char* stage(StreamId id, int type, int rows, int columns, int precision, int bytes);
+    // 暂存块达到大小时交出
+    void staged();
+    void publish(Lane* lane);
+
+    ShardedDataSaver* const m_owner;
+    const int m_stagingBytes;
+    QVector<Lane*> m_lanes;         // 下标为分片号
+    QVector<int> m_shardCache;      // 句柄 -> 分片号，未缓存为 -1；未命中时加锁查注册表
+    Lane* m_current { nullptr };    // 最近一次 stage 的通道，写完负载后据此判断暂存块是否已满
+};
@@ -0,0 +1,563 @@
+#include "WriteBatch.h"
+
+#include <QFile>
+#include <QPair>
+#include <QVarLengthArray>
+#include <QtGlobal>
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// O_DIRECT 的对齐粒度（内存地址、长度、文件偏移）
+const qint64 ALIGN = 4096;
+// 单次 writev 的最大分块数（Linux UIO_MAXIOV）
+const int MAX_IOV = 1024;
+
+bool fail(QString* error, const QString& message) {
+    if (error && error->isEmpty()) *error = message;
+    return false;
+}
+
+} // namespace
+
+struct WriteBatch::FileState {
+    QFile* file { nullptr };
+    int fd { -1 };
+    qint64 end { 0 };           // 已写出的文件末尾
+    int flags { 0 };            // 打开时的状态标志，finish 时恢复
+    bool directOn { false };    // 当前是否已设置 O_DIRECT
+    bool directFailed { false }; // 文件系统不支持 O_DIRECT，改为普通写入
+    QByteArray carry;           // direct 模式下不满一个对齐块的尾部
+    bool plainRound { false };  // 本轮以普通写入写出（含 carry）
+    QVector<const QByteArray*> data;
+    qint64 bytes { 0 };         // data 的总字节数
+};
+
+#if defined(Q_OS_LINUX)
+
+namespace {
+
+QString systemError(int code) {
+    return QString::fromLocal8Bit(std::strerror(code));
+}
+
+// 写完全部数据：处理短写与信号中断
+bool writeFully(int fd, const iovec* iov, int count, qint64 offset, qint64* written) {
+    QVarLengthArray<iovec, 16> rest(iov, iov + count);
+    iovec* v = rest.data();
+    int n = count;
+    *written = 0;
+    while (n > 0) {
+        const ssize_t r = ::pwritev(fd, v, qMin(n, MAX_IOV), static_cast<off_t>(offset + *written));
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        *written += r;
+        size_t left = static_cast<size_t>(r);
+        while (n > 0 && left >= v->iov_len) {
+            left -= v->iov_len;
+            ++v;
+            --n;
+        }
+        if (n > 0) {
+            v->iov_base = static_cast<char*>(v->iov_base) + left;
+            v->iov_len -= left;
+        }
+    }
+    return true;
+}
+
+bool setDirect(int fd, int flags, bool on) {
+    return ::fcntl(fd, F_SETFL, on ? (flags | O_DIRECT) : flags) == 0;
+}
+
+} // namespace
+
+// 直接以系统调用使用 io_uring（不依赖 liburing）：提交队列、完成队列与 SQE 数组均映射到用户态
+struct WriteBatch::Ring {
+    ~Ring() {
+        if (sqes) ::munmap(sqes, sqesBytes);
+        if (cqMap && cqMap != sqMap) ::munmap(cqMap, cqMapBytes);
+        if (sqMap) ::munmap(sqMap, sqMapBytes);
+        if (fd >= 0) ::close(fd);
+    }
+
+    bool open(unsigned depth) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = static_cast<int>(::syscall(__NR_io_uring_setup, depth, &params));
+        if (fd < 0) return false;
+        entries = params.sq_entries;
+
+        sqMapBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqMapBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sqMapBytes = cqMapBytes = qMax(sqMapBytes, cqMapBytes);
+        sqMap = ::mmap(nullptr, sqMapBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqMap == MAP_FAILED) {
+            sqMap = nullptr;
+            return false;
+        }
+        if (single) {
+            cqMap = sqMap;
+        } else {
+            cqMap = ::mmap(nullptr, cqMapBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cqMap == MAP_FAILED) {
+                cqMap = nullptr;
+                return false;
+            }
+        }
+        sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+        void* s = ::mmap(nullptr, sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (s == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(s);
+
+        char* sq = static_cast<char*>(sqMap);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cqMap);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // 填一个 writev SQE（本线程是唯一的提交者，尾指针在 push 之后统一发布）
+    void prepareWrite(unsigned index, int file, const iovec* iov, int count, qint64 offset, quint64 userData) {
+        const unsigned tail = *sqTail + index;
+        const unsigned slot = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[slot];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITEV;
+        sqe->fd = file;
+        sqe->addr = reinterpret_cast<quint64>(iov);
+        sqe->len = static_cast<unsigned>(count);
+        sqe->off = static_cast<quint64>(offset);
+        sqe->user_data = userData;
+        sqArray[slot] = slot;
+    }
+
+    // 发布 count 个 SQE，一次系统调用提交并等待全部完成。返回内核接收的个数（按 SQE 顺序）；
+    // 出错时未被接收的 SQE 撤回，由调用方同步写出
+    unsigned submitAndWait(unsigned count) {
+        __atomic_store_n(sqTail, *sqTail + count, __ATOMIC_RELEASE);
+        unsigned submitted = 0;
+        while (submitted < count) {
+            const long r = ::syscall(__NR_io_uring_enter, fd, count - submitted, count - submitted,
+                                     IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                // 没有 SQPOLL 时内核只在 enter 中取 SQE，尾指针退回头指针即撤回剩余的 SQE
+                __atomic_store_n(sqTail, __atomic_load_n(sqHead, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+                break;
+            }
+            submitted += static_cast<unsigned>(r);
+        }
+        return submitted;
+    }
+
+    // 取一个完成事件，队列为空时阻塞等待
+    io_uring_cqe next() {
+        unsigned head = *cqHead;
+        while (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+            ::syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        }
+        const io_uring_cqe cqe = cqes[head & *cqMask];
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return cqe;
+    }
+
+    int fd { -1 };
+    unsigned entries { 0 };
+    void* sqMap { nullptr };
+    size_t sqMapBytes { 0 };
+    void* cqMap { nullptr };
+    size_t cqMapBytes { 0 };
+    io_uring_sqe* sqes { nullptr };
+    size_t sqesBytes { 0 };
+    unsigned* sqHead { nullptr };
+    unsigned* sqTail { nullptr };
+    unsigned* sqMask { nullptr };
+    unsigned* sqArray { nullptr };
+    unsigned* cqHead { nullptr };
+    unsigned* cqTail { nullptr };
+    unsigned* cqMask { nullptr };
+    io_uring_cqe* cqes { nullptr };
+};
+
+// 一次写操作：一个文件本轮的数据（超出 MAX_IOV 时为其中相邻的一段）
+struct WriteBatch::Op {
+    FileState* file { nullptr };
+    qint64 offset { 0 };
+    qint64 bytes { 0 };
+    int first { 0 };    // 在 iovec 数组中的位置
+    int count { 0 };
+};
+
+#else
+
+struct WriteBatch::Ring {
+};
+
+#endif
+
+WriteBatch::WriteBatch(bool preferUring, bool direct, int queueDepth)
+#if defined(Q_OS_LINUX)
+    : m_direct(direct) {
+    if (preferUring) {
+        m_ring = new Ring();
+        if (m_ring->open(static_cast<unsigned>(qMax(2, queueDepth)))) {
+            m_backend = Backend::Uring;
+        } else {
+            delete m_ring;
+            m_ring = nullptr;
+        }
+    }
+}
+#else
+    : m_backend(Backend::QFile)
+    , m_direct(false) {
+    Q_UNUSED(preferUring);
+    Q_UNUSED(direct);
+    Q_UNUSED(queueDepth);
+}
+#endif
+
+WriteBatch::~WriteBatch() {
+    finish();
+    delete m_ring;
+#if defined(Q_OS_LINUX)
+    std::free(m_bounce);
+#endif
+}
+
+const char* WriteBatch::backendName(Backend backend) {
+    switch (backend) {
+    case Backend::Uring: return "io_uring";
+    case Backend::Pwrite: return "pwritev";
+    case Backend::QFile: return "QFile";
+    }
+    return "";
+}
+
+WriteBatch::FileState* WriteBatch::state(QFile* file) {
+    FileState* s = m_files.value(file, nullptr);
+    if (s) return s;
+    s = new FileState();
+    s->file = file;
+    s->fd = file->handle();
+#if defined(Q_OS_LINUX)
+    // 本类按显式偏移写入：取当前长度为起点，并暂时去掉 O_APPEND（否则内核忽略偏移），finish 时恢复
+    struct stat st;
+    s->end = ::fstat(s->fd, &st) == 0 ? st.st_size : file->size();
+    s->flags = ::fcntl(s->fd, F_GETFL);
+    if (s->flags & O_APPEND) ::fcntl(s->fd, F_SETFL, s->flags & ~O_APPEND);
+#endif
+    m_files.insert(file, s);
+    return s;
+}
+
+void WriteBatch::add(QFile* file, const QByteArray& data) {
+    if (data.isEmpty()) return;
+    FileState* s = state(file);
+    if (s->data.isEmpty()) m_pending.append(s);
+    s->data.append(&data);
+    s->bytes += data.size();
+}
+
+bool WriteBatch::submit(QString* error) {
+    if (m_pending.isEmpty()) return true;
+    bool ok = true;
+#if defined(Q_OS_LINUX)
+    ok = m_backend == Backend::Uring ? submitUring(error) : submitPwrite(error);
+#else
+    for (FileState* s : m_pending) {
+        for (const QByteArray* d : s->data) {
+            if (s->file->write(*d) != d->size()) {
+                ok = fail(error, QStringLiteral("写入失败: %1 (%2)").arg(s->file->fileName(), s->file->errorString()));
+            }
+        }
+        s->file->flush();
+    }
+#endif
+    for (FileState* s : m_pending) {
+        // 普通写入时残留的尾部已随本轮写出
+        if (s->plainRound) s->carry.clear();
+        s->plainRound = false;
+        s->data.clear();
+        s->bytes = 0;
+    }
+    m_pending.clear();
+    return ok;
+}
+
+#if defined(Q_OS_LINUX)
+
+bool WriteBatch::reserveBounce(qint64 bytes, QString* error) {
+    if (bytes <= m_bounceBytes) return true;
+    std::free(m_bounce);
+    void* p = nullptr;
+    m_bounce = ::posix_memalign(&p, ALIGN, static_cast<size_t>(bytes)) == 0 ? static_cast<char*>(p) : nullptr;
+    m_bounceBytes = m_bounce ? bytes : 0;
+    return m_bounce ? true : fail(error, QStringLiteral("无法分配 O_DIRECT 对齐缓冲"));
+}
+
+bool WriteBatch::writeSync(FileState* s, const iovec* iov, int count, qint64 offset, qint64* written) {
+    if (writeFully(s->fd, iov, count, offset, written)) return true;
+    if (errno != EINVAL || !s->directOn) return false;
+    // 文件系统不接受 O_DIRECT：该文件改为普通写入，剩余部分重写
+    setDirect(s->fd, s->flags & ~O_APPEND, false);
+    s->directOn = false;
+    s->directFailed = true;
+    QVarLengthArray<iovec, 16> rest(iov, iov + count);
+    qint64 skip = *written;
+    int first = 0;
+    while (skip >= static_cast<qint64>(rest[first].iov_len)) {
+        skip -= static_cast<qint64>(rest[first].iov_len);
+        ++first;
+    }
+    rest[first].iov_base = static_cast<char*>(rest[first].iov_base) + skip;
+    rest[first].iov_len -= static_cast<size_t>(skip);
+    qint64 more = 0;
+    const bool ok = writeFully(s->fd, rest.constData() + first, rest.size() - first, offset + *written, &more);
+    *written += more;
+    return ok;
+}
+
+qint64 WriteBatch::prepareDirect(FileState* s, char* bounce, QString* error) {
+    // 按顺序拼接 carry 与本轮数据，依次切出头部、对齐块与尾部
+    QVarLengthArray<QPair<const char*, qint64>, 16> pieces;
+    if (!s->carry.isEmpty()) pieces.append(qMakePair(s->carry.constData(), qint64(s->carry.size())));
+    for (const QByteArray* d : s->data) pieces.append(qMakePair(d->constData(), qint64(d->size())));
+    int piece = 0;
+    qint64 pieceOffset = 0;
+    auto copy = [&](char* dst, qint64 n) {
+        while (n > 0) {
+            const qint64 take = qMin(n, pieces[piece].second - pieceOffset);
+            std::memcpy(dst, pieces[piece].first + pieceOffset, static_cast<size_t>(take));
+            dst += take;
+            n -= take;
+            pieceOffset += take;
+            if (pieceOffset == pieces[piece].second) {
+                ++piece;
+                pieceOffset = 0;
+            }
+        }
+    };
+
+    const int flags = s->flags & ~O_APPEND;
+    const qint64 total = s->carry.size() + s->bytes;
+    // 文件末尾未对齐（finish 写过尾部之后）时，先以普通写入补齐到对齐位置
+    const qint64 head = s->end % ALIGN ? qMin(ALIGN - s->end % ALIGN, total) : 0;
+    const qint64 body = (total - head) / ALIGN * ALIGN;
+    if (head > 0) {
+        char headBytes[ALIGN];
+        copy(headBytes, head);
+        if (s->directOn && setDirect(s->fd, flags, false)) s->directOn = false;
+        const iovec v { headBytes, static_cast<size_t>(head) };
+        qint64 written = 0;
+        if (!writeFully(s->fd, &v, 1, s->end, &written)) {
+            fail(error, QStringLiteral("写入失败: %1 (%2)").arg(s->file->fileName(), systemError(errno)));
+        }
+        s->end += written;
+    }
+    copy(bounce, body);
+    QByteArray tail(static_cast<int>(total - head - body), Qt::Uninitialized);
+    copy(tail.data(), tail.size());
+    s->carry.swap(tail);
+
+    if (body > 0 && !s->directOn) {
+        if (setDirect(s->fd, flags, true)) {
+            s->directOn = true;
+        } else {
+            s->directFailed = true; // 本轮的对齐块仍从中转缓冲以普通写入写出
+        }
+    }
+    return body;
+}
+
+void WriteBatch::prepareOps(QVector<Op>& ops, QVector<iovec>& iov, char* bounce, QString* error) {
+    qint64 bounceUsed = 0;
+    for (FileState* s : m_pending) {
+        Op op;
+        op.file = s;
+        op.offset = s->end;
+        op.first = iov.size();
+        if (m_direct && !s->directFailed) {
+            // 对齐块放在中转缓冲，尾部留到下一轮；bounce 为空时各文件共用同一段（逐个同步写出）
+            char* dst = bounce ? bounce + bounceUsed : m_bounce;
+            const qint64 body = prepareDirect(s, dst, error);
+            if (body == 0) continue;
+            if (bounce) bounceUsed += body;
+            op.offset = s->end;
+            op.bytes = body;
+            op.count = 1;
+            iov.append(iovec { dst, static_cast<size_t>(body) });
+            ops.append(op);
+            if (!bounce) return;
+            continue;
+        }
+        // 普通写入：先写 direct 模式残留的尾部，再写本轮数据；超出 MAX_IOV 时拆成相邻的几次写
+        s->plainRound = true;
+        auto push = [&](const char* p, qint64 n) {
+            if (op.count == MAX_IOV) {
+                ops.append(op);
+                op.offset += op.bytes;
+                op.first = iov.size();
+                op.count = 0;
+                op.bytes = 0;
+            }
+            iov.append(iovec { const_cast<char*>(p), static_cast<size_t>(n) });
+            ++op.count;
+            op.bytes += n;
+        };
+        if (!s->carry.isEmpty()) push(s->carry.constData(), s->carry.size());
+        for (const QByteArray* d : s->data) push(d->constData(), d->size());
+        ops.append(op);
+    }
+}
+
+bool WriteBatch::submitUring(QString* error) {
+    if (m_direct) {
+        qint64 needed = 0;
+        for (const FileState* s : m_pending) {
+            if (!s->directFailed) needed += (s->carry.size() + s->bytes) / ALIGN * ALIGN;
+        }
+        if (!reserveBounce(needed, error)) return false;
+    }
+    // 每个文件一个 writev，同一文件的数据按 add 顺序排在同一段 iovec 中。
+    // 全部收集完之后才把 iovec 地址交给内核（收集过程中数组可能扩容）
+    QVector<Op> ops;
+    QVector<iovec> iov;
+    prepareOps(ops, iov, m_bounce, error);
+
+    bool ok = true;
+    for (int start = 0; start < ops.size();) {
+        const int n = qMin(ops.size() - start, static_cast<int>(m_ring->entries));
+        for (int i = 0; i < n; ++i) {
+            const Op& op = ops[start + i];
+            m_ring->prepareWrite(static_cast<unsigned>(i), op.file->fd, iov.constData() + op.first, op.count,
+                                 op.offset, static_cast<quint64>(start + i));
+        }
+        const int submitted = static_cast<int>(m_ring->submitAndWait(static_cast<unsigned>(n)));
+        if (submitted < n) {
+            // io_uring 拒绝提交（如资源不足）：未被接收的与之后的写操作均改用 pwritev
+            m_backend = Backend::Pwrite;
+            for (int i = start + submitted; i < ops.size(); ++i) {
+                const Op& op = ops[i];
+                qint64 written = 0;
+                if (!writeSync(op.file, iov.constData() + op.first, op.count, op.offset, &written)) {
+                    ok = fail(error, QStringLiteral("写入失败: %1 (%2)").arg(op.file->file->fileName(), systemError(errno)));
+                }
+                op.file->end = qMax(op.file->end, op.offset + written);
+            }
+        }
+        for (int i = 0; i < submitted; ++i) {
+            const io_uring_cqe cqe = m_ring->next();
+            const Op& op = ops[static_cast<int>(cqe.user_data)];
+            FileState* s = op.file;
+            qint64 written = cqe.res > 0 ? cqe.res : 0;
+            if (cqe.res < 0 && !(cqe.res == -EINVAL && s->directOn)) {
+                ok = fail(error, QStringLiteral("写入失败: %1 (%2)").arg(s->file->fileName(), systemError(-cqe.res)));
+            } else if (written < op.bytes) {
+                // 短写，或文件系统不接受 O_DIRECT：剩余部分同步写完
+                const iovec* v = iov.constData() + op.first;
+                qint64 more = 0;
+                bool done;
+                if (cqe.res < 0) {
+                    done = writeSync(s, v, op.count, op.offset, &more);
+                } else {
+                    QVarLengthArray<iovec, 16> rest(v, v + op.count);
+                    qint64 skip = written;
+                    int first = 0;
+                    while (skip >= static_cast<qint64>(rest[first].iov_len)) {
+                        skip -= static_cast<qint64>(rest[first].iov_len);
+                        ++first;
+                    }
+                    rest[first].iov_base = static_cast<char*>(rest[first].iov_base) + skip;
+                    rest[first].iov_len -= static_cast<size_t>(skip);
+                    done = writeSync(s, rest.constData() + first, rest.size() - first, op.offset + written, &more);
+                }
+                if (!done) {
+                    ok = fail(error, QStringLiteral("写入失败: %1 (%2)").arg(s->file->fileName(), systemError(errno)));
+                }
+                written += more;
+            }
+            s->end = qMax(s->end, op.offset + written);
+        }
+        if (submitted < n) break;
+        start += n;
+    }
+    return ok;
+}
+
+bool WriteBatch::submitPwrite(QString* error) {
+    bool ok = true;
+    if (m_direct) {
+        qint64 needed = 0;
+        for (const FileState* s : m_pending) needed = qMax(needed, (s->carry.size() + s->bytes) / ALIGN * ALIGN);
+        if (!reserveBounce(needed, error)) return false;
+    }
+    // 逐文件准备并立即写出：direct 模式下各文件轮流使用同一段中转缓冲
+    QVector<FileState*> files;
+    files.swap(m_pending);
+    for (FileState* s : files) {
+        m_pending = { s };
+        QVector<Op> ops;
+        QVector<iovec> iov;
+        prepareOps(ops, iov, nullptr, error);
+        for (const Op& op : ops) {
+            qint64 written = 0;
+            if (!writeSync(s, iov.constData() + op.first, op.count, op.offset, &written)) {
+                ok = fail(error, QStringLiteral("写入失败: %1 (%2)").arg(s->file->fileName(), systemError(errno)));
+            }
+            s->end = qMax(s->end, op.offset + written);
+        }
+    }
+    m_pending.swap(files);
+    return ok;
+}
+
+#endif
+
+bool WriteBatch::finish(QString* error) {
+    bool ok = true;
+    for (auto it = m_files.begin(); it != m_files.end(); ++it) {
+        FileState* s = it.value();
+#if defined(Q_OS_LINUX)
+        const int flags = s->flags & ~O_APPEND;
+        if (s->directOn) setDirect(s->fd, flags, false);
+        if (!s->carry.isEmpty()) {
+            const iovec v { s->carry.data(), static_cast<size_t>(s->carry.size()) };
+            qint64 written = 0;
+            if (!writeFully(s->fd, &v, 1, s->end, &written)) {
+                ok = fail(error, QStringLiteral("写入失败: %1 (%2)").arg(s->file->fileName(), systemError(errno)));
+            }
+            s->end += written;
+        }
+        // 恢复打开时的标志，并让描述符位置指向末尾，QFile 之后的写入接在后面
+        if (s->flags != flags) ::fcntl(s->fd, F_SETFL, s->flags);
+        ::lseek(s->fd, static_cast<off_t>(s->end), SEEK_SET);
+#endif
+        delete s;
+    }
+    m_files.clear();
+    m_pending.clear();
+    return ok;
+}
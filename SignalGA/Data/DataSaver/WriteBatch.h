@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QByteArray>
+#include <QtGlobal>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+class QFile;
+#if defined(Q_OS_LINUX)
+struct iovec;
+#endif
+
+// WriteBatch: 写盘线程的批量写后端
+//
+// 写盘线程把一轮取出的全部数据块按文件排队（add），再一次性提交（submit）：
+// 同一文件的多块合并为一次 writev，各文件的写操作在 Linux 上经 io_uring 一次系统调用提交、一次等待全部完成；
+// io_uring 不可用（内核过旧、被禁用）时退回逐文件 pwritev。非 Linux 平台直接用 QFile::write。
+// 写入位置由本类跟踪（第一次写某文件时取文件长度），不经过 QFile 的缓冲与位置；
+// 空闲时 finish() 把文件描述符的位置移到末尾，之后 QFile 自己的写入接着往后写。
+//
+// direct 模式（O_DIRECT，仅 Linux）：每个文件按 4KB 对齐的整块经对齐的中转缓冲绕过页缓存写入，
+// 不满一块的尾部留在内存中与下一块拼接，finish() 时以普通写入写出。
+// 文件系统不支持 O_DIRECT 时该文件自动改为普通写入。
+class WriteBatch {
+public:
+    enum class Backend {
+        Uring,  // io_uring 批量提交
+        Pwrite, // 逐文件 pwritev
+        QFile   // 非 Linux：QFile::write
+    };
+
+    // preferUring 为 false 时直接使用 pwritev；queueDepth 为 io_uring 提交队列深度
+    WriteBatch(bool preferUring, bool direct, int queueDepth = 64);
+    ~WriteBatch();
+    WriteBatch(const WriteBatch&) = delete;
+    WriteBatch& operator=(const WriteBatch&) = delete;
+
+    // 可在任意线程读取（io_uring 提交被拒绝时写盘线程会改为 Pwrite）
+    Backend backend() const { return m_backend.load(std::memory_order_relaxed); }
+    bool isDirect() const { return m_direct; }
+
+    // 排队：把 data 追加到 file 末尾。不拷贝，submit 返回前 data 须保持不变
+    void add(QFile* file, const QByteArray& data);
+    bool isEmpty() const { return m_pending.isEmpty(); }
+    // 提交全部排队的写并等待完成；失败时 error 为第一条错误，其余文件照常写出
+    bool submit(QString* error = nullptr);
+    // 写出 direct 模式留下的尾部，并把各文件描述符的位置移到文件末尾，然后忘掉这些文件。
+    // 在写盘线程空闲、或文件可能被 QFile 直接写入/关闭之前调用
+    bool finish(QString* error = nullptr);
+
+    static const char* backendName(Backend backend);
+
+private:
+    struct FileState;
+    struct Ring;
+    struct Op;
+
+    FileState* state(QFile* file);
+#if defined(Q_OS_LINUX)
+    bool submitUring(QString* error);
+    bool submitPwrite(QString* error);
+    // 按文件生成写操作。bounce 非空时各文件的对齐块依次放入其中；为空时只处理 m_pending 的第一个文件
+    void prepareOps(QVector<Op>& ops, QVector<iovec>& iov, char* bounce, QString* error);
+    // direct 模式：把 carry 与排队数据拼接，以普通写入写出对齐位置之前的头部，
+    // 对齐块拷入 bounce 并返回其长度，尾部存为新的 carry
+    qint64 prepareDirect(FileState* s, char* bounce, QString* error);
+    bool reserveBounce(qint64 bytes, QString* error);
+    // 同步写完；O_DIRECT 被拒绝（EINVAL）时该文件改为普通写入重试
+    bool writeSync(FileState* s, const iovec* iov, int count, qint64 offset, qint64* written);
+#endif
+
+    std::atomic<Backend> m_backend { Backend::Pwrite };
+    const bool m_direct;
+    Ring* m_ring { nullptr };
+    QHash<QFile*, FileState*> m_files;
+    QVector<FileState*> m_pending;   // 本轮有数据的文件，按第一次 add 的顺序
+    char* m_bounce { nullptr };      // direct 模式的对齐中转缓冲
+    qint64 m_bounceBytes { 0 };
+};
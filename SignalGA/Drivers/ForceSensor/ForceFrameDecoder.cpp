@@ -0,0 +1,307 @@
+#include "ForceFrameDecoder.h"
+
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define FFD_HAVE_SSE2 1
+#  include <emmintrin.h>
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#    define FFD_TARGET_AVX2
+#  else
+#    define FFD_TARGET_AVX2 __attribute__((target("avx2")))
+#  endif
+#endif
+
+namespace ForceFrameDecoder {
+
+bool ChannelMap::assign(const char* ids, int n)
+{
+    if (n < 1 || n > MAX_CHANNELS) {
+        return false;
+    }
+    std::int8_t next[256];
+    for (int i = 0; i < 256; ++i) next[i] = -1;
+    for (int i = 0; i < n; ++i) {
+        const unsigned char id = static_cast<unsigned char>(ids[i]);
+        if (id == '\r' || id == '\n' || next[id] >= 0) {
+            return false;
+        }
+        next[id] = static_cast<std::int8_t>(i);
+    }
+    for (int i = 0; i < 256; ++i) index[i] = next[i];
+    count = n;
+    return true;
+}
+
+namespace {
+
+// 标量实现：逐帧解码，遇到第一个无效帧即停止
+int decodeFramesScalar(const char* p, int maxFrames, const ChannelMap& map, std::uint8_t* channels, int* raws)
+{
+    for (int i = 0; i < maxFrames; ++i) {
+        int ch = -1;
+        if (!decodeFrame(p + i * FRAME_SIZE, map, ch, raws[i])) {
+            return i;
+        }
+        channels[i] = static_cast<std::uint8_t>(ch);
+    }
+    return maxFrames;
+}
+
+#if defined(FFD_HAVE_SSE2)
+
+// 10 字节帧与 16/32 字节向量的最小公倍周期：每 80 字节（8 帧）结构重复一次
+const int BLOCK_BYTES = 80;
+const int BLOCK_FRAMES = BLOCK_BYTES / FRAME_SIZE;
+
+// 按字节位置预生成的结构模板（周期 80 字节，AVX2 路径连续使用两个周期）
+struct BlockTemplate {
+    alignas(32) std::uint8_t fixedValue[2 * BLOCK_BYTES]; // 固定字符（'0'、'\r'、'\n'）的期望值
+    alignas(32) std::uint8_t fixedMask[2 * BLOCK_BYTES];  // 固定字符位置为 0xFF
+    alignas(32) std::uint8_t chanMask[2 * BLOCK_BYTES];   // 通道标识位置为 0xFF（向量部分不校验，合并时查表）
+    alignas(32) std::uint8_t hexMask[2 * BLOCK_BYTES];    // 十六进制字符位置为 0xFF
+    constexpr BlockTemplate() : fixedValue(), fixedMask(), chanMask(), hexMask() {
+        for (int i = 0; i < 2 * BLOCK_BYTES; ++i) {
+            const int pos = i % FRAME_SIZE;
+            if (pos < HEX_DIGITS) {
+                hexMask[i] = 0xFF;
+            } else if (pos == CHANNEL_OFFSET) {
+                chanMask[i] = 0xFF;
+            } else {
+                fixedMask[i] = 0xFF;
+                fixedValue[i] = pos == FILLER_OFFSET ? '0' : (pos == CR_OFFSET ? '\r' : '\n');
+            }
+        }
+    }
+};
+constexpr BlockTemplate kTemplate;
+
+// 帧起点均为偶数偏移，因此每个 16 位通道恰好容纳一对相邻半字节。
+// packed[k] = (nibble[2k] << 4) | nibble[2k + 1]，每帧的力值由前 3 个字节拼出。
+// 通道标识按 map 查表，返回从头开始标识有效的帧数。
+inline int combineFrames(const char* p, const std::uint16_t* packed, int frames, const ChannelMap& map,
+                         std::uint8_t* channels, int* raws)
+{
+    const int pairsPerFrame = FRAME_SIZE / 2;
+    for (int f = 0; f < frames; ++f) {
+        const int ch = channelIndexOf(map, p[f * FRAME_SIZE + CHANNEL_OFFSET]);
+        if (ch < 0) {
+            return f;
+        }
+        const std::uint16_t* b = packed + f * pairsPerFrame;
+        raws[f] = (b[0] << 16) | (b[1] << 8) | b[2];
+        channels[f] = static_cast<std::uint8_t>(ch);
+    }
+    return frames;
+}
+
+// SSE2：一次校验并转换 80 字节（8 帧），固定字符与十六进制字符全部有效返回 true
+inline bool decodeBlockSse2(const char* p, std::uint16_t* packed)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_cmpeq_epi8(zero, zero);
+    __m128i bad = zero;
+    for (int off = 0; off < BLOCK_BYTES; off += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + off));
+        const __m128i fixedValue = _mm_load_si128(reinterpret_cast<const __m128i*>(kTemplate.fixedValue + off));
+        const __m128i fixedMask = _mm_load_si128(reinterpret_cast<const __m128i*>(kTemplate.fixedMask + off));
+        const __m128i chanMask = _mm_load_si128(reinterpret_cast<const __m128i*>(kTemplate.chanMask + off));
+        const __m128i hexMask = _mm_load_si128(reinterpret_cast<const __m128i*>(kTemplate.hexMask + off));
+
+        // 有符号比较：>= 0x80 的字节为负，自然落在所有合法区间之外
+        const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        const __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                              _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+        const __m128i isAlpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                              _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+        const __m128i isFixed = _mm_cmpeq_epi8(v, fixedValue);
+
+        __m128i ok = _mm_and_si128(fixedMask, isFixed);
+        ok = _mm_or_si128(ok, chanMask);
+        ok = _mm_or_si128(ok, _mm_and_si128(hexMask, _mm_or_si128(isDigit, isAlpha)));
+        bad = _mm_or_si128(bad, _mm_xor_si128(ok, ones));
+
+        const __m128i digitVal = _mm_and_si128(isDigit, _mm_sub_epi8(v, _mm_set1_epi8('0')));
+        const __m128i alphaVal = _mm_and_si128(isAlpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)));
+        const __m128i nib = _mm_or_si128(digitVal, alphaVal);
+        const __m128i pairs = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nib, _mm_set1_epi16(0x00FF)), 4),
+                                           _mm_srli_epi16(nib, 8));
+        _mm_store_si128(reinterpret_cast<__m128i*>(packed + off / 2), pairs);
+    }
+    return _mm_movemask_epi8(bad) == 0;
+}
+
+int decodeFramesSse2(const char* p, int maxFrames, const ChannelMap& map, std::uint8_t* channels, int* raws)
+{
+    alignas(16) std::uint16_t packed[BLOCK_BYTES / 2];
+    int done = 0;
+    while (maxFrames - done >= BLOCK_FRAMES) {
+        const char* block = p + done * FRAME_SIZE;
+        if (!decodeBlockSse2(block, packed)) {
+            break; // 本块含无效帧，交给标量路径确定有效前缀
+        }
+        const int valid = combineFrames(block, packed, BLOCK_FRAMES, map, channels + done, raws + done);
+        done += valid;
+        if (valid < BLOCK_FRAMES) {
+            return done; // 第 done 帧的通道标识未知
+        }
+    }
+    return done + decodeFramesScalar(p + done * FRAME_SIZE, maxFrames - done, map, channels + done, raws + done);
+}
+
+// AVX2：一次校验并转换 160 字节（16 帧）
+const int AVX2_BLOCK_BYTES = 2 * BLOCK_BYTES;
+const int AVX2_BLOCK_FRAMES = AVX2_BLOCK_BYTES / FRAME_SIZE;
+
+FFD_TARGET_AVX2 bool decodeBlockAvx2(const char* p, std::uint16_t* packed)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_cmpeq_epi8(zero, zero);
+    __m256i bad = zero;
+    for (int off = 0; off < AVX2_BLOCK_BYTES; off += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + off));
+        const __m256i fixedValue = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kTemplate.fixedValue + off));
+        const __m256i fixedMask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kTemplate.fixedMask + off));
+        const __m256i chanMask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kTemplate.chanMask + off));
+        const __m256i hexMask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kTemplate.hexMask + off));
+
+        const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        const __m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                                 _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+        const __m256i isAlpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                                 _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+        const __m256i isFixed = _mm256_cmpeq_epi8(v, fixedValue);
+
+        __m256i ok = _mm256_and_si256(fixedMask, isFixed);
+        ok = _mm256_or_si256(ok, chanMask);
+        ok = _mm256_or_si256(ok, _mm256_and_si256(hexMask, _mm256_or_si256(isDigit, isAlpha)));
+        bad = _mm256_or_si256(bad, _mm256_xor_si256(ok, ones));
+
+        const __m256i digitVal = _mm256_and_si256(isDigit, _mm256_sub_epi8(v, _mm256_set1_epi8('0')));
+        const __m256i alphaVal = _mm256_and_si256(isAlpha, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10)));
+        const __m256i nib = _mm256_or_si256(digitVal, alphaVal);
+        const __m256i pairs = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(nib, _mm256_set1_epi16(0x00FF)), 4),
+                                              _mm256_srli_epi16(nib, 8));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(packed + off / 2), pairs);
+    }
+    return _mm256_movemask_epi8(bad) == 0;
+}
+
+FFD_TARGET_AVX2 int decodeFramesAvx2(const char* p, int maxFrames, const ChannelMap& map, std::uint8_t* channels, int* raws)
+{
+    alignas(32) std::uint16_t packed[AVX2_BLOCK_BYTES / 2];
+    int done = 0;
+    while (maxFrames - done >= AVX2_BLOCK_FRAMES) {
+        const char* block = p + done * FRAME_SIZE;
+        if (!decodeBlockAvx2(block, packed)) {
+            break;
+        }
+        const int valid = combineFrames(block, packed, AVX2_BLOCK_FRAMES, map, channels + done, raws + done);
+        done += valid;
+        if (valid < AVX2_BLOCK_FRAMES) {
+            return done;
+        }
+    }
+    // 剩余不足 16 帧的部分（或含无效帧的块）交给 SSE2 路径
+    return done + decodeFramesSse2(p + done * FRAME_SIZE, maxFrames - done, map, channels + done, raws + done);
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {0, 0, 0, 0};
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // FFD_HAVE_SSE2
+
+using DecodeFn = int (*)(const char*, int, const ChannelMap&, std::uint8_t*, int*);
+
+struct Dispatch {
+    DecodeFn fn;
+    Backend backend;
+};
+
+// 每种实现一个常量表项，切换时只替换指向它的指针，解码线程不会读到拼接的 fn/backend
+const Dispatch kScalarDispatch { &decodeFramesScalar, Backend::Scalar };
+#if defined(FFD_HAVE_SSE2)
+const Dispatch kSse2Dispatch { &decodeFramesSse2, Backend::Sse2 };
+const Dispatch kAvx2Dispatch { &decodeFramesAvx2, Backend::Avx2 };
+#endif
+
+const Dispatch* selectDispatch()
+{
+#if defined(FFD_HAVE_SSE2)
+    if (cpuHasAvx2()) {
+        return &kAvx2Dispatch;
+    }
+    return &kSse2Dispatch;
+#else
+    return &kScalarDispatch;
+#endif
+}
+
+std::atomic<const Dispatch*>& activeDispatch()
+{
+    static std::atomic<const Dispatch*> d { selectDispatch() }; // 首次调用时按 CPU 能力选择
+    return d;
+}
+
+} // namespace
+
+int decodeFrames(const char* p, int maxFrames, const ChannelMap& map, std::uint8_t* channels, int* raws)
+{
+    if (maxFrames <= 0) {
+        return 0;
+    }
+    return activeDispatch().load(std::memory_order_relaxed)->fn(p, maxFrames, map, channels, raws);
+}
+
+Backend activeBackend()
+{
+    return activeDispatch().load(std::memory_order_relaxed)->backend;
+}
+
+const char* backendName(Backend backend)
+{
+    switch (backend) {
+    case Backend::Scalar: return "Scalar";
+    case Backend::Sse2: return "SSE2";
+    case Backend::Avx2: return "AVX2";
+    default: return "(Unknown)";
+    }
+}
+
+void forceBackend(Backend backend)
+{
+    std::atomic<const Dispatch*>& d = activeDispatch();
+    switch (backend) {
+#if defined(FFD_HAVE_SSE2)
+    case Backend::Avx2:
+        if (cpuHasAvx2()) d.store(&kAvx2Dispatch, std::memory_order_relaxed);
+        break;
+    case Backend::Sse2:
+        d.store(&kSse2Dispatch, std::memory_order_relaxed);
+        break;
+#endif
+    case Backend::Scalar:
+        d.store(&kScalarDispatch, std::memory_order_relaxed);
+        break;
+    default:
+        break;
+    }
+}
+
+} // namespace ForceFrameDecoder
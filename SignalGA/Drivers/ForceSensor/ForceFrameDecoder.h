@@ -0,0 +1,103 @@
+#ifndef FORCEFRAMEDECODER_H
+#define FORCEFRAMEDECODER_H
+
+#include <cstdint>
+
+// ForceFrameDecoder: 力传感器串口帧的原地解码工具（不依赖 Qt，不做任何堆分配）
+// 单帧格式（10 字节）："XXXXXX0b\r\n"，XXXXXX 为 6 位十六进制原始力值，b 为通道标识（见 ChannelMap）
+// 多通道数据即连续的单帧，例如双通道："XXXXXX0b\r\nYYYYYY0d\r\n"
+namespace ForceFrameDecoder {
+
+const int FRAME_SIZE = 10;      // 单帧字节数
+const int HEX_DIGITS = 6;       // 十六进制力值位数
+const int FILLER_OFFSET = 6;    // '0' 填充字符位置
+const int CHANNEL_OFFSET = 7;   // 通道标识字符位置
+const int CR_OFFSET = 8;        // '\r' 位置
+const int LF_OFFSET = 9;        // '\n' 位置
+
+// 十六进制字符查表：'0'-'9'/'a'-'f'/'A'-'F' 映射为 0-15，其余为 -1（编译期生成）
+struct HexTable {
+    std::int8_t v[256];
+    constexpr HexTable() : v() {
+        for (int i = 0; i < 256; ++i) v[i] = -1;
+        for (int i = 0; i < 10; ++i) v['0' + i] = static_cast<std::int8_t>(i);
+        for (int i = 0; i < 6; ++i) {
+            v['a' + i] = static_cast<std::int8_t>(10 + i);
+            v['A' + i] = static_cast<std::int8_t>(10 + i);
+        }
+    }
+};
+inline constexpr HexTable kHexTable {};
+
+// 将 p 起始的 6 个十六进制字符解码为整数（0 ~ 0xFFFFFF）
+// 成功返回 true；遇到非法字符返回 false（value 不修改）
+inline bool decodeHex6(const char* p, int& value)
+{
+    const std::int8_t d0 = kHexTable.v[static_cast<unsigned char>(p[0])];
+    const std::int8_t d1 = kHexTable.v[static_cast<unsigned char>(p[1])];
+    const std::int8_t d2 = kHexTable.v[static_cast<unsigned char>(p[2])];
+    const std::int8_t d3 = kHexTable.v[static_cast<unsigned char>(p[3])];
+    const std::int8_t d4 = kHexTable.v[static_cast<unsigned char>(p[4])];
+    const std::int8_t d5 = kHexTable.v[static_cast<unsigned char>(p[5])];
+    // 任一字符非法时其查表值为 -1，按位或后符号位为 1
+    if ((d0 | d1 | d2 | d3 | d4 | d5) < 0) {
+        return false;
+    }
+    value = (d0 << 20) | (d1 << 16) | (d2 << 12) | (d3 << 8) | (d4 << 4) | d5;
+    return true;
+}
+
+const int MAX_CHANNELS = 16;    // 通道数上限
+
+// 通道标识映射：标识字符 -> 通道索引（0 起），未配置的字符为 -1。默认两通道 'b'/'d'
+struct ChannelMap {
+    std::int8_t index[256];
+    int count = 0;
+
+    ChannelMap() { assign("bd", 2); }
+    // ids[i] 为第 i 个通道的标识字符；数量不在 1 ~ MAX_CHANNELS、标识重复或为 '\r'/'\n' 时返回 false（映射不变）
+    bool assign(const char* ids, int n);
+};
+
+// 将通道标识字符映射为通道索引，未知标识返回 -1
+inline int channelIndexOf(const ChannelMap& map, char id)
+{
+    return map.index[static_cast<unsigned char>(id)];
+}
+
+// 解码一个完整的 10 字节单帧（调用方保证 p 至少有 FRAME_SIZE 字节可读）
+// 校验 '0' 填充、通道标识与 "\r\n" 结束符；成功时输出通道索引与原始值
+inline bool decodeFrame(const char* p, const ChannelMap& map, int& channelIndex, int& raw)
+{
+    if (p[FILLER_OFFSET] != '0' || p[CR_OFFSET] != '\r' || p[LF_OFFSET] != '\n') {
+        return false;
+    }
+    const int idx = channelIndexOf(map, p[CHANNEL_OFFSET]);
+    if (idx < 0 || !decodeHex6(p, raw)) {
+        return false;
+    }
+    channelIndex = idx;
+    return true;
+}
+
+// 批量解码实现（运行时按 CPU 能力选择，可通过 forceBackend 指定以便对比测试）
+enum class Backend {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// 批量解码 p 起始处背靠背排列的最多 maxFrames 个单帧（p 至少有 maxFrames * FRAME_SIZE 字节可读）。
+// 通道标识按 map 映射，通道索引写入 channels[]，原始值写入连续的 raws[]（尚未标定）。
+// 返回从头开始连续有效的帧数；小于 maxFrames 时，第 (返回值) 帧无效，需由调用方重新同步。
+int decodeFrames(const char* p, int maxFrames, const ChannelMap& map, std::uint8_t* channels, int* raws);
+
+Backend activeBackend();
+const char* backendName(Backend backend);
+// 强制使用指定实现（CPU 不支持时保持不变），用于对比测试各实现的结果与性能。
+// 切换是原子的，可与解码并发调用；正在进行的一次 decodeFrames 仍用原来的实现完成
+void forceBackend(Backend backend);
+
+} // namespace ForceFrameDecoder
+
+#endif // FORCEFRAMEDECODER_H
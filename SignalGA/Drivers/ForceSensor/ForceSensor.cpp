@@ -1,27 +1,45 @@
 #include "ForceSensor.h"
+#include "ForceFrameDecoder.h"
+#include "RawCapture.h"
 #include <QDebug>
+#include <QMetaMethod>
+#include <algorithm>
+#include <cstring>
 #include <QDateTime> // 尽管在当前优化版本中未直接用于数据处理，但如果将来需要时间戳可保留
 
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
 // 构造函数实现
 ForceSensor::ForceSensor(const QString &portName, double sensitivityCH1, double sensitivityCH2)
     : SerialCommon() // 调用基类 SerialCommon 的构造函数
     , portName_(portName)
 {
-    // 初始化通道 1 的数据
-    channelData_[0].sensitivity = sensitivityCH1;
-    channelData_[0].referenceZero = 0;
-    channelData_[0].forceReferceFlagSet = false;
-    channelData_[0].lastProcessedRawForce = 0;
-    channelData_[0].currentRawForce = 0;
-
-    // 初始化通道 2 的数据
-    channelData_[1].sensitivity = sensitivityCH2;
-    channelData_[1].referenceZero = 0;
-    channelData_[1].forceReferceFlagSet = false;
-    channelData_[1].lastProcessedRawForce = 0;
-    channelData_[1].currentRawForce = 0;
+    // 初始化各通道的数据：默认两通道，其余通道的灵敏度为 1.0（setChannelIds 启用后生效）
+    for (int i = 0; i < ForceSensorConstants::MAX_CHANNELS; ++i) {
+        sensitivity_[i] = 1.0;
+        referenceZero_[i] = 0;
+        currentRaw_[i] = 0;
+        lastRaw_[i] = 0;
+        zeroSet_[i] = false;
+    }
+    sensitivity_[0] = sensitivityCH1;
+    sensitivity_[1] = sensitivityCH2;
     // 启动高分辨率计时器
     highResTimer_.start();
+
+    // 批量投递：预留容量，并以子对象方式创建定时器（随 moveToThread 一起迁移）
+    qRegisterMetaType<ForceSample>("ForceSample");
+    qRegisterMetaType<QVector<ForceSample>>("QVector<ForceSample>");
+    pendingBatch_.reserve(batchSize_);
+    batchTimer_ = new QTimer(this);
+    batchTimer_->setInterval(ForceSensorConstants::DEFAULT_SAMPLE_BATCH_LATENCY_MS);
+    QObject::connect(batchTimer_, &QTimer::timeout, this, [this]() {
+        if (!pendingBatch_.isEmpty() && highResTimer_.nsecsElapsed() - batchFirstNs_ >= batchMaxLatencyNs_) {
+            flushBatch();
+        }
+    });
 }
 
 // 析构函数实现
@@ -33,215 +51,362 @@ ForceSensor::~ForceSensor()
 // 重写 SerialCommon 的 readData 槽函数
 void ForceSensor::readData()
 {
-    QByteArray newData = serial->readAll(); // 从串口读取所有可用数据
-    buffer_.append(newData);                 // 将新数据追加到内部缓冲区
-    // qDebug() << "接收到原始数据 (十六进制): " << newData.toHex(); // 用于调试接收到的原始十六进制数据
-    processReceivedBuffer();                 // 处理累积的缓冲区数据
+    receive([this](char *dst, qint64 maxSize) { return serial->read(dst, maxSize); });
+}
+
+// Direct 模式：在读线程中从描述符读取并解析
+void ForceSensor::directReadReady(int fd)
+{
+#if defined(Q_OS_LINUX)
+    receive([fd](char *dst, qint64 maxSize) -> qint64 { return ::read(fd, dst, static_cast<size_t>(maxSize)); });
+#else
+    Q_UNUSED(fd);
+#endif
+}
+
+// Direct 模式不启动批量定时器，读线程 poll 超时后在此检查时间上界
+int ForceSensor::directIdleTimeoutMs() const
+{
+    return static_cast<int>((batchMaxLatencyNs_ + 999999) / 1000000);
+}
+
+void ForceSensor::directIdle()
+{
+    if (!pendingBatch_.isEmpty() && highResTimer_.nsecsElapsed() - batchFirstNs_ >= batchMaxLatencyNs_) {
+        flushBatch();
+    }
+}
+
+// 读出全部可读数据并解析；read(dst, maxSize) 返回读到的字节数，无数据或出错时返回 <= 0
+template <typename ReadFn>
+void ForceSensor::receive(ReadFn read)
+{
+    using namespace ForceSensorConstants;
+    // 直接读入环形缓冲区的空闲区段，避免 readAll() 分配临时 QByteArray
+    for (;;) {
+        const quint64 freeBytes = reserveRx();
+        const int offset = static_cast<int>(rxWritePos_ & RX_RING_MASK);
+        const qint64 contiguous = std::min<quint64>(freeBytes, RX_RING_CAPACITY - offset);
+        const qint64 n = read(rxRing_ + offset, contiguous);
+        if (n <= 0) {
+            break;
+        }
+        // 抓取直接引用接收缓冲区中刚读到的字节，解析（及覆盖该区段）之前统一写出
+        if (rawCapture_) {
+            rawCapture_->append(highResTimer_.nsecsElapsed(), rxRing_ + offset, static_cast<int>(n));
+        }
+        rxWritePos_ += static_cast<quint64>(n);
+    }
+    if (rawCapture_) {
+        rawCapture_->commit();
+    }
+    processReceivedBuffer(); // 处理累积的缓冲区数据
+}
+
+// 返回环形缓冲区的空闲字节数，已满时先解析腾出空间
+quint64 ForceSensor::reserveRx()
+{
+    using namespace ForceSensorConstants;
+    quint64 freeBytes = RX_RING_CAPACITY - (rxWritePos_ - rxReadPos_);
+    if (freeBytes == 0) {
+        if (rawCapture_) {
+            rawCapture_->commit(); // 解析后这些字节所在的区段将被覆盖
+        }
+        processReceivedBuffer(); // 缓冲区已满，先解析腾出空间
+        freeBytes = RX_RING_CAPACITY - (rxWritePos_ - rxReadPos_);
+        if (freeBytes == 0) {
+            qDebug() << "接收缓冲区已满且无法解析，清空缓冲区。";
+            resetRx();
+            freeBytes = RX_RING_CAPACITY;
+        }
+    }
+    return freeBytes;
+}
+
+// 离线输入一段原始字节
+void ForceSensor::feedRaw(const char *data, int size, qint64 timestampNs)
+{
+    using namespace ForceSensorConstants;
+    timestampOverrideNs_ = timestampNs;
+    while (size > 0) {
+        const quint64 freeBytes = reserveRx();
+        const int offset = static_cast<int>(rxWritePos_ & RX_RING_MASK);
+        const int n = static_cast<int>(std::min<quint64>(std::min<quint64>(freeBytes, RX_RING_CAPACITY - offset),
+                                                         static_cast<quint64>(size)));
+        std::memcpy(rxRing_ + offset, data, n);
+        rxWritePos_ += static_cast<quint64>(n);
+        data += n;
+        size -= n;
+    }
+    processReceivedBuffer();
+    timestampOverrideNs_ = -1;
+}
+
+// 回放抓取文件
+quint64 ForceSensor::replayCapture(RawCaptureReader &reader)
+{
+    quint64 chunks = 0;
+    RawCaptureReader::Chunk chunk;
+    while (reader.next(chunk)) {
+        feedRaw(chunk.data, chunk.size, chunk.timestampNs);
+        ++chunks;
+    }
+    if (reader.isTruncated()) {
+        qDebug() << "抓取文件末尾的数据块不完整，已忽略。";
+    }
+    flushBatch();
+    return chunks;
+}
+
+qint64 ForceSensor::captureTimestampNs() const
+{
+    return highResTimer_.isValid() ? highResTimer_.nsecsElapsed() : 0;
+}
+
+// 从环形缓冲区读游标偏移 offset 处拷贝 n 个字节（处理环绕）
+void ForceSensor::peekRx(quint64 offset, char *dst, int n) const
+{
+    using namespace ForceSensorConstants;
+    const int start = static_cast<int>((rxReadPos_ + offset) & RX_RING_MASK);
+    const int first = std::min(n, RX_RING_CAPACITY - start);
+    std::memcpy(dst, rxRing_ + start, first);
+    if (first < n) {
+        std::memcpy(dst + first, rxRing_, n - first);
+    }
 }
 
 // 处理单个通道的原始力数据
 int ForceSensor::processRawForceData(int rawForce, int channelIndex)
 {
     // 确保通道索引有效
-    if (channelIndex < 0 || channelIndex >= 2) {
+    if (channelIndex < 0 || channelIndex >= channelCount_) {
         qDebug() << "错误: processRawForceData 中通道索引无效:" << channelIndex;
         return rawForce; // 如果通道无效，返回原始力值
     }
 
-    ChannelData& ch = channelData_[channelIndex]; // 获取对应通道的数据引用
     int currentProcessedForce = rawForce;
 
     // 如果零点参考未设置且当前力值非负，则设置零点参考
-    if (!ch.forceReferceFlagSet && currentProcessedForce >= 0) {
-        ch.referenceZero = currentProcessedForce;
-        ch.forceReferceFlagSet = true;
-        qDebug() << "通道" << (channelIndex + 1) << "零点参考设置为:" << ch.referenceZero;
+    if (!zeroSet_[channelIndex] && currentProcessedForce >= 0) {
+        referenceZero_[channelIndex] = currentProcessedForce;
+        zeroSet_[channelIndex] = true;
+        qDebug() << "通道" << (channelIndex + 1) << "零点参考设置为:" << referenceZero_[channelIndex];
     }
 
     // 如果当前力值是负数，则使用上次有效的已处理力值
     // 这假定负的原始数据表示传感器读数异常或不稳定
     if (currentProcessedForce < 0) {
-        currentProcessedForce = ch.lastProcessedRawForce;
+        currentProcessedForce = lastRaw_[channelIndex];
         qDebug() << "通道" << (channelIndex + 1) << "接收到负原始力，使用上次有效值:" << currentProcessedForce;
     }
 
-    ch.lastProcessedRawForce = currentProcessedForce; // 更新上次有效力值
-    ch.currentRawForce = currentProcessedForce;       // 更新当前处理后的原始力值
+    lastRaw_[channelIndex] = currentProcessedForce;    // 更新上次有效力值
+    currentRaw_[channelIndex] = currentProcessedForce; // 更新当前处理后的原始力值
 
     return currentProcessedForce;
 }
 
-// 辅助函数：将十六进制字符串安全转换为整数，并进行错误检查
-bool ForceSensor::tryConvertHexToInt(const QByteArray& hexString, int& result) {
-    bool ok;
-    result = hexString.toLongLong(&ok, 16); // 尝试将十六进制字符串转换为长整型
-    if (!ok) {
-        qDebug() << "将十六进制字符串 '" << hexString << "' 转换为数字失败。";
+// 解析并处理一个 10 字节单帧 "XXXXXX0b\r\n"
+bool ForceSensor::parseAndProcessFrame(const char *frame)
+{
+    int channelIndex = -1;
+    int rawForce = 0;
+    if (!ForceFrameDecoder::decodeFrame(frame, channelMap_, channelIndex, rawForce)) {
+        return false;
     }
-    return ok;
+
+    processDecodedSample(channelIndex, rawForce);
+    return true;
+}
+
+// 处理一个已解码的样本并发射信号
+void ForceSensor::processDecodedSample(int channelIndex, int rawForce)
+{
+    const int raw = processRawForceData(rawForce, channelIndex);
+    const double sensitivity = sensitivity_[channelIndex];
+    // 为该帧生成微秒时间戳（离线输入时使用指定的时间戳）
+    const qint64 nowNs = highResTimer_.isValid() ? highResTimer_.nsecsElapsed() : 0;
+    const long long tsUs = (timestampOverrideNs_ >= 0 ? timestampOverrideNs_ : nowNs) / 1000;
+    deliverSample(ForceSample{tsUs, channelIndex + 1, raw, raw * sensitivity,
+                              (raw - referenceZero_[channelIndex]) * sensitivity}, nowNs);
 }
 
+// 批量处理已解码的样本
+void ForceSensor::processDecodedBatch(const quint8 *channels, int *raws, int count)
+{
+    // 零点/负值处理依赖同一通道的前一个样本，按到达顺序逐个更新状态
+    for (int i = 0; i < count; ++i) {
+        raws[i] = processRawForceData(raws[i], channels[i]);
+    }
+
+    // 状态更新后零点已确定（自动零点只在通道的首个样本处设定，早于其换算），
+    // 整批换算是一个无分支的循环：按通道索引从结构数组中取灵敏度与零点
+    double *absForces = rxBatchAbs_;
+    double *relForces = rxBatchRel_;
+    for (int i = 0; i < count; ++i) {
+        const int ch = channels[i];
+        const double sensitivity = sensitivity_[ch];
+        absForces[i] = raws[i] * sensitivity;
+        relForces[i] = (raws[i] - referenceZero_[ch]) * sensitivity;
+    }
+
+    // 同一次读取解码出的样本共用一个时间戳
+    const qint64 nowNs = highResTimer_.isValid() ? highResTimer_.nsecsElapsed() : 0;
+    const long long tsUs = (timestampOverrideNs_ >= 0 ? timestampOverrideNs_ : nowNs) / 1000;
+    for (int i = 0; i < count; ++i) {
+        deliverSample(ForceSample{tsUs, channels[i] + 1, raws[i], absForces[i], relForces[i]}, nowNs);
+    }
+}
 
-// 解析一个完整的传感器数据包
-bool ForceSensor::parseAndProcessDataPacket(const QByteArray &packet)
+// 投递一个已换算的样本
+void ForceSensor::deliverSample(const ForceSample &sample, qint64 nowNs)
 {
-    int rawForceCH1 = -1, rawForceCH2 = -1; // 存储解析出的原始力值
-    char channelID1 = '\0', channelID2 = '\0'; // 存储解析出的通道 ID
-    bool success = false; // 标记解析和处理是否成功
-
-    if (packet.size() == ForceSensorConstants::PACKET_SINGLE_CHANNEL_SIZE) {
-        // 处理单通道数据包格式: "XXXXXX0C\r\n"
-        if (packet[ForceSensorConstants::HEX_VALUE_LENGTH] == '0' && // 检查力值后是否为 '0'
-            packet.endsWith(ForceSensorConstants::MESSAGE_TERMINATOR)) // 检查是否以 "\r\n" 结尾
-        {
-            QByteArray hexValue = packet.mid(0, ForceSensorConstants::HEX_VALUE_LENGTH); // 提取十六进制力值部分
-            channelID1 = packet[ForceSensorConstants::HEX_VALUE_LENGTH + 1]; // 提取通道 ID 字符
-
-            if (tryConvertHexToInt(hexValue, rawForceCH1)) { // 尝试将十六进制转换为整数
-                if (channelID1 == ForceSensorConstants::CHANNEL_ID_1_CHAR) {
-                    processRawForceData(rawForceCH1, 0); // 处理通道 1 的数据
-                    // 成功处理后，发射信号
-                    double absForce, relForce;
-                    getForce(1, false, absForce); // 获取绝对力值
-                    getForce(1, true, relForce);  // 获取相对力值
-                    // 单通道：为该包生成微秒时间戳
-                    const long long tsUs = highResTimer_.isValid() ? highResTimer_.nsecsElapsed() / 1000 : 0;
-                    emit forceDataReady(1, absForce, relForce, tsUs);
-                    success = true;
-                } else if (channelID1 == ForceSensorConstants::CHANNEL_ID_2_CHAR) {
-                    processRawForceData(rawForceCH1, 1); // 处理通道 2 的数据
-                    // 成功处理后，发射信号
-                    double absForce, relForce;
-                    getForce(2, false, absForce); // 获取绝对力值
-                    getForce(2, true, relForce);  // 获取相对力值
-                    // 单通道：为该包生成微秒时间戳
-                    const long long tsUs = highResTimer_.isValid() ? highResTimer_.nsecsElapsed() / 1000 : 0;
-                    emit forceDataReady(2, absForce, relForce, tsUs);
-                    success = true;
-                } else {
-                    qDebug() << "错误: 单通道数据包中未知通道ID:" << channelID1;
-                }
-            }
-        } else {
-            qDebug() << "错误: 无效的单通道数据包格式:" << packet.toHex();
-        }
-    } else if (packet.size() == ForceSensorConstants::PACKET_DUAL_CHANNEL_SIZE) {
-        // 处理双通道数据包格式: "XXXXXX0C1\r\nYYYYYY0C2\r\n"
-        // 检查关键位置的固定字符 '0'，以及换行符位置，确保格式正确
-        if (packet[ForceSensorConstants::HEX_VALUE_LENGTH] == '0' && // 第一个力值后的 '0'
-            packet[ForceSensorConstants::HEX_VALUE_LENGTH + 2] == ForceSensorConstants::MESSAGE_TERMINATOR.at(0) && // 第一个力值后的 '\r'
-            packet[ForceSensorConstants::HEX_VALUE_LENGTH + 3] == ForceSensorConstants::MESSAGE_TERMINATOR.at(1) && // 第一个力值后的 '\n'
-            // 第二个力值前的 '0' 位于索引 16 (0-based)
-            packet[ForceSensorConstants::HEX_VALUE_LENGTH + ForceSensorConstants::MESSAGE_TERMINATOR.size() + 2 + ForceSensorConstants::HEX_VALUE_LENGTH] == '0' &&
-            packet.endsWith(ForceSensorConstants::MESSAGE_TERMINATOR)) // 整个包以 "\r\n" 结束
-        {
-            QByteArray hexValue1 = packet.mid(0, ForceSensorConstants::HEX_VALUE_LENGTH); // 提取第一个十六进制力值
-            channelID1 = packet[ForceSensorConstants::HEX_VALUE_LENGTH + 1]; // 提取第一个通道 ID
-
-            // 第二个力值从索引 10 开始 (HEX_VALUE_LENGTH (6) + '0' (1) + 'C1' (1) + '\r' (1) + '\n' (1) = 10 字节)
-            QByteArray hexValue2 = packet.mid(10, ForceSensorConstants::HEX_VALUE_LENGTH); // 提取第二个十六进制力值
-            channelID2 = packet[10 + ForceSensorConstants::HEX_VALUE_LENGTH + 1]; // 提取第二个通道 ID
-
-
-            if (tryConvertHexToInt(hexValue1, rawForceCH1) && tryConvertHexToInt(hexValue2, rawForceCH2)) {
-                // 根据通道 ID 判断哪个值属于哪个通道
-                if (channelID1 == ForceSensorConstants::CHANNEL_ID_1_CHAR && channelID2 == ForceSensorConstants::CHANNEL_ID_2_CHAR) {
-                    processRawForceData(rawForceCH1, 0); // 处理通道 1
-                    processRawForceData(rawForceCH2, 1); // 处理通道 2
-                    success = true;
-                    // 为双通道包复用同一微秒时间戳
-                    const long long tsUs = highResTimer_.isValid() ? highResTimer_.nsecsElapsed() / 1000 : 0;
-                    // 发射两个通道的信号
-                    double absForce1, relForce1;
-                    getForce(1, false, absForce1);
-                    getForce(1, true, relForce1);
-                    emit forceDataReady(1, absForce1, relForce1, tsUs);
-
-                    double absForce2, relForce2;
-                    getForce(2, false, absForce2);
-                    getForce(2, true, relForce2);
-                    emit forceDataReady(2, absForce2, relForce2, tsUs);
-
-                } else if (channelID1 == ForceSensorConstants::CHANNEL_ID_2_CHAR && channelID2 == ForceSensorConstants::CHANNEL_ID_1_CHAR) {
-                    processRawForceData(rawForceCH2, 0); // 处理通道 1 (因为数据包中顺序反了)
-                    processRawForceData(rawForceCH1, 1); // 处理通道 2
-                    success = true;
-                    // 为双通道包复用同一微秒时间戳
-                    const long long tsUs = highResTimer_.isValid() ? highResTimer_.nsecsElapsed() / 1000 : 0;
-                    // 发射两个通道的信号 (注意顺序)
-                    double absForce1, relForce1;
-                    getForce(1, false, absForce1);
-                    getForce(1, true, relForce1);
-                    emit forceDataReady(1, absForce1, relForce1, tsUs);
-
-                    double absForce2, relForce2;
-                    getForce(2, false, absForce2);
-                    getForce(2, true, relForce2);
-                    emit forceDataReady(2, absForce2, relForce2, tsUs);
-                } else {
-                    qDebug() << "错误: 双通道数据包中未知或不匹配的通道ID:" << channelID1 << channelID2;
-                }
-            }
-        } else {
-            qDebug() << "错误: 无效的双通道数据包格式:" << packet.toHex();
-        }
-    } else {
-        qDebug() << "警告: 未知的数据包大小或格式:" << packet.size() << "字节, 数据:" << packet.toHex();
+    // 已设置环形缓冲区时直接写入，由存储线程批量取出
+    if (sampleRing_) {
+        sampleRing_->push(sample);
+        return;
     }
-    return success;
+
+    // 逐样本信号只为未改用批量投递的接收方保留：forceBatchReady 有接收方时不再逐样本发出
+    static const QMetaMethod batchSignal = QMetaMethod::fromSignal(&ForceSensor::forceBatchReady);
+    if (!isSignalConnected(batchSignal)) {
+        emit forceDataReady(sample.channel, sample.absoluteForce, sample.relativeForce, sample.timestampUs);
+    }
+
+    // 累积到批次中，达到条数上限即投递
+    if (pendingBatch_.isEmpty()) {
+        batchFirstNs_ = nowNs;
+    }
+    pendingBatch_.append(sample);
+    if (pendingBatch_.size() >= batchSize_) {
+        flushBatch();
+    }
+}
+
+// 立即投递当前累积的样本
+void ForceSensor::flushBatch()
+{
+    if (pendingBatch_.isEmpty()) {
+        return;
+    }
+    // 交换出整批数据投递，本地重新预留容量；跨线程时接收方共享同一份数据，不做逐样本拷贝
+    QVector<ForceSample> batch;
+    batch.swap(pendingBatch_);
+    pendingBatch_.reserve(batchSize_);
+    emit forceBatchReady(batch);
+}
+
+// 设置批量投递的条数上限
+void ForceSensor::setBatchSize(int samples)
+{
+    if (samples <= 0) {
+        qDebug() << "设置批量大小失败: 必须大于 0。";
+        return;
+    }
+    batchSize_ = samples;
+    pendingBatch_.reserve(batchSize_);
+}
+
+// 设置批量投递的时间上界
+void ForceSensor::setBatchMaxLatencyMs(int ms)
+{
+    if (ms <= 0) {
+        qDebug() << "设置批量延迟上界失败: 必须大于 0。";
+        return;
+    }
+    batchMaxLatencyNs_ = static_cast<qint64>(ms) * 1000000LL;
+    batchTimer_->setInterval(ms);
 }
 
-// 处理内部缓冲区中累积的数据，提取并处理完整的传感器数据包
+// 处理环形缓冲区中累积的数据，提取并处理完整的传感器帧
 void ForceSensor::processReceivedBuffer()
 {
-    // 循环处理，直到缓冲区中不再包含完整的消息帧
-    while (buffer_.size() >= ForceSensorConstants::PACKET_SINGLE_CHANNEL_SIZE) {
-        int packetEndIndex = buffer_.indexOf(ForceSensorConstants::MESSAGE_TERMINATOR); // 查找消息结束符
-
-        if (packetEndIndex != -1) {
-            // 找到了一个潜在的消息结束符
-            int packetSizeWithTerminator = packetEndIndex + ForceSensorConstants::MESSAGE_TERMINATOR.size();
-
-            // 提取潜在的数据包
-            QByteArray potentialPacket = buffer_.left(packetSizeWithTerminator);
-
-            // 检查提取出的数据包长度是否符合预期的单通道或双通道包长度
-            if (potentialPacket.size() == ForceSensorConstants::PACKET_SINGLE_CHANNEL_SIZE ||
-                potentialPacket.size() == ForceSensorConstants::PACKET_DUAL_CHANNEL_SIZE)
-            {
-                // 如果数据包长度符合预期，尝试解析并处理
-                if (parseAndProcessDataPacket(potentialPacket)) {
-                    // 成功处理后，从缓冲区中移除该数据包
-                    buffer_.remove(0, packetSizeWithTerminator);
-                } else {
-                    // 数据包长度符合，但内容无效。丢弃此数据包以防止无限循环。
-                    qDebug() << "数据包内容无效，丢弃:" << potentialPacket.toHex();
-                    buffer_.remove(0, packetSizeWithTerminator);
-                    // 考虑到可能的数据错位，这里中断循环并等待更多数据，尝试重新同步
-                    break;
-                }
-            } else if (potentialPacket.size() > ForceSensorConstants::PACKET_DUAL_CHANNEL_SIZE) {
-                // 如果数据包比预期的双通道数据包还大，可能包含多个消息或格式严重错误。
-                // 此时，简单地丢弃已找到的终止符之前的数据，并尝试重新同步。
-                qDebug() << "数据包过大或格式错误，丢弃部分数据以重新同步。长度:" << potentialPacket.size() << "数据:" << potentialPacket.toHex();
-                buffer_.remove(0, packetSizeWithTerminator); // 移除这部分可能损坏的数据
-                break; // 中断，等待更多数据以重新同步
-            } else { // potentialPacket.size() < PACKET_SINGLE_CHANNEL_SIZE
-                // 理论上，如果找到了终止符，数据包至少应该有单通道的最小长度。
-                // 如果出现这种情况，说明数据流异常或逻辑错误。清空缓冲区以避免问题。
-                qDebug() << "不完整的数据以终止符结尾，丢弃。数据:" << potentialPacket.toHex();
-                buffer_.clear(); // 清空缓冲区，避免异常数据累积
+    using namespace ForceSensorConstants;
+    char frame[PACKET_SINGLE_CHANNEL_SIZE]; // 栈上暂存一帧，处理环绕边界
+
+    // 循环处理，直到缓冲区中不再包含完整的帧
+    while (rxWritePos_ - rxReadPos_ >= static_cast<quint64>(PACKET_SINGLE_CHANNEL_SIZE)) {
+        const quint64 available = rxWritePos_ - rxReadPos_;
+
+        // 批量路径：读游标到缓冲区物理末尾之间的连续完整帧一次性交给 SIMD 解码
+        const int start = static_cast<int>(rxReadPos_ & RX_RING_MASK);
+        const int contiguousFrames = static_cast<int>(
+            std::min<quint64>(available, RX_RING_CAPACITY - start) / PACKET_SINGLE_CHANNEL_SIZE);
+        if (contiguousFrames >= RX_BATCH_MIN_FRAMES) {
+            const int decoded = ForceFrameDecoder::decodeFrames(rxRing_ + start,
+                                                                std::min(contiguousFrames, RX_BATCH_FRAMES),
+                                                                channelMap_, rxBatchChannels_, rxBatchRaws_);
+            processDecodedBatch(rxBatchChannels_, rxBatchRaws_, decoded);
+            rxReadPos_ += static_cast<quint64>(decoded) * PACKET_SINGLE_CHANNEL_SIZE;
+            if (decoded > 0) {
+                continue;
+            }
+            // 首帧即无效：交给下面的逐帧路径重新同步
+        }
+
+        // 快速路径：数据流对齐时，结束符恰好位于第 8/9 字节
+        peekRx(0, frame, PACKET_SINGLE_CHANNEL_SIZE);
+        if (frame[PACKET_SINGLE_CHANNEL_SIZE - 2] == '\r' && frame[PACKET_SINGLE_CHANNEL_SIZE - 1] == '\n') {
+            if (parseAndProcessFrame(frame)) {
+                rxReadPos_ += PACKET_SINGLE_CHANNEL_SIZE;
+                continue;
+            }
+            // 内容无效：交给慢速路径按第一个结束符丢弃
+        }
+
+        // 慢速路径：数据错位，查找下一个结束符以重新同步
+        quint64 lineSize = 0;
+        for (quint64 i = 0; i + 1 < available; ++i) {
+            if (rxRing_[(rxReadPos_ + i) & RX_RING_MASK] == '\r'
+                && rxRing_[(rxReadPos_ + i + 1) & RX_RING_MASK] == '\n') {
+                lineSize = i + MESSAGE_TERMINATOR.size();
                 break;
             }
-        } else {
+        }
+
+        if (lineSize == 0) {
             // 缓冲区中没有找到完整的消息终止符。等待更多数据。
-            // 如果缓冲区在没有终止符的情况下变得过大，可能表示数据流有问题。
-            if (buffer_.size() > ForceSensorConstants::PACKET_DUAL_CHANNEL_SIZE * 2) { // 设置一个任意阈值
-                qDebug() << "缓冲区在没有终止符的情况下变得过大，可能数据错位。清空缓冲区。";
-                buffer_.clear(); // 清空以防止无限增长
+            // 如果缓冲区在没有终止符的情况下变得过大，说明数据错位，丢弃（保留末尾可能的 '\r'）。
+            if (available > static_cast<quint64>(PACKET_DUAL_CHANNEL_SIZE * 2)) {
+                qDebug() << "缓冲区在没有终止符的情况下变得过大，可能数据错位。丢弃" << (available - 1) << "字节。";
+                rxReadPos_ = rxWritePos_ - 1;
+            }
+            break;
+        }
+
+        // 不是数据帧的一行可能是设备对命令的响应（queueRequest），先交给等待中的请求匹配
+        char line[PACKET_DUAL_CHANNEL_SIZE * 8];
+        if (hasPendingRequests() && lineSize <= sizeof(line)) {
+            peekRx(0, line, static_cast<int>(lineSize));
+            if (offerResponse(line, static_cast<int>(lineSize))) {
+                rxReadPos_ += lineSize;
+                continue;
             }
-            break; // 没有完整的包，等待更多数据
         }
+
+        if (lineSize == static_cast<quint64>(PACKET_SINGLE_CHANNEL_SIZE)) {
+            // 长度符合但内容无效，丢弃此帧以防止无限循环
+            qDebug() << "数据包内容无效，丢弃:" << QByteArray(frame, PACKET_SINGLE_CHANNEL_SIZE).toHex();
+        } else {
+            // 终止符之前的数据长度不符合单帧格式，丢弃至终止符处以重新同步
+            qDebug() << "数据错位，丢弃" << lineSize << "字节以重新同步。";
+        }
+        rxReadPos_ += lineSize;
+    }
+
+    // 数据流停顿时，不足一帧长的短响应（例如 "OK\r\n"）也要交给等待中的请求
+    const quint64 remaining = rxWritePos_ - rxReadPos_;
+    if (hasPendingRequests() && remaining >= static_cast<quint64>(MESSAGE_TERMINATOR.size()) && remaining <= sizeof(frame)
+        && rxRing_[(rxWritePos_ - 2) & RX_RING_MASK] == '\r' && rxRing_[(rxWritePos_ - 1) & RX_RING_MASK] == '\n') {
+        peekRx(0, frame, static_cast<int>(remaining));
+        if (offerResponse(frame, static_cast<int>(remaining))) {
+            rxReadPos_ = rxWritePos_;
+        }
+    }
+
+    // 数据持续到达时在此检查时间上界；数据停顿时由 batchTimer_ 兜底
+    if (!pendingBatch_.isEmpty() && highResTimer_.nsecsElapsed() - batchFirstNs_ >= batchMaxLatencyNs_) {
+        flushBatch();
     }
 }
 
@@ -252,16 +417,18 @@ bool ForceSensor::connect(const QString &portName,
                           QSerialPort::Parity parity,
                           QSerialPort::StopBits stopBits)
 {
+    // 连接前重置零点参考标志和清除内部数据缓冲区，确保状态干净（Direct 模式下打开后读线程即开始解析）
+    resetReferenceZero();
+    resetRx(); // 清空缓冲区
+
     // 调用基类的 open 方法来实际打开串口
     if (!SerialCommon::open(portName, baudRate, dataBits, parity, stopBits)) {
         qDebug() << "力传感器: 无法打开串口。";
         return false;
     }
-
-    // 成功连接后，重置零点参考标志和清除内部数据缓冲区，确保状态干净
-    channelData_[0].forceReferceFlagSet = false;
-    channelData_[1].forceReferceFlagSet = false;
-    buffer_.clear(); // 清空缓冲区
+    if (!isDirectReading()) {
+        batchTimer_->start();
+    }
     qDebug() << "力传感器: 成功连接到" << portName;
     return true;
 }
@@ -269,16 +436,18 @@ bool ForceSensor::connect(const QString &portName,
 // 使用默认设置连接串口 (端口名来自构造函数，波特率/校验位等固定)
 bool ForceSensor::connect()
 {
+    // 连接前重置零点参考标志和清除内部数据缓冲区
+    resetReferenceZero();
+    resetRx(); // 清空缓冲区
+
     // 默认串口参数: 921600 波特率, 8 数据位, 无校验位, 1 停止位
     if (!SerialCommon::open(portName_, 921600, QSerialPort::Data8, QSerialPort::NoParity, QSerialPort::OneStop)) {
         qDebug() << "力传感器: 无法使用默认设置打开串口。";
         return false;
     }
-
-    // 成功连接后，重置零点参考标志和清除内部数据缓冲区
-    channelData_[0].forceReferceFlagSet = false;
-    channelData_[1].forceReferceFlagSet = false;
-    buffer_.clear(); // 清空缓冲区
+    if (!isDirectReading()) {
+        batchTimer_->start();
+    }
     qDebug() << "力传感器: 成功连接到" << portName_;
     return true;
 }
@@ -286,37 +455,70 @@ bool ForceSensor::connect()
 // 断开串口连接
 bool ForceSensor::disConnect()
 {
-    if (SerialCommon::close()) { // 调用基类的 close 方法来关闭串口
+    // 停止批量定时器；先关闭串口（Direct 模式下同时停止读线程），再投递残留样本
+    batchTimer_->stop();
+    const bool closed = SerialCommon::close(); // 调用基类的 close 方法来关闭串口
+    flushBatch();
+
+    if (closed) {
         // 断开连接后，重置零点参考标志
-        channelData_[0].forceReferceFlagSet = false;
-        channelData_[1].forceReferceFlagSet = false;
+        resetReferenceZero();
         qDebug() << "力传感器: 已断开连接。";
         return true;
     }
     return false; // 如果串口已经关闭或关闭失败，返回 false
 }
 
+// 清除全部通道的零点参考标志
+void ForceSensor::resetReferenceZero()
+{
+    for (int i = 0; i < ForceSensorConstants::MAX_CHANNELS; ++i) {
+        zeroSet_[i] = false;
+    }
+}
+
+// 配置通道标识
+bool ForceSensor::setChannelIds(const QByteArray &ids)
+{
+    if (isOpen()) {
+        qDebug() << "设置通道标识失败: 必须在连接前设置。";
+        return false;
+    }
+    if (!channelMap_.assign(ids.constData(), ids.size())) {
+        qDebug() << "设置通道标识失败: 数量必须为 1 ~" << ForceSensorConstants::MAX_CHANNELS << "且不能重复:" << ids;
+        return false;
+    }
+    channelCount_ = ids.size();
+    resetReferenceZero();
+    for (int i = 0; i < ForceSensorConstants::MAX_CHANNELS; ++i) {
+        currentRaw_[i] = 0;
+        lastRaw_[i] = 0;
+    }
+    qDebug() << "力传感器: 通道标识设置为" << ids << "，共" << channelCount_ << "个通道。";
+    return true;
+}
+
 // 为指定通道设置零点参考值
 bool ForceSensor::setReferenceZero(int num, int channel)
 {
-    if (channel < 1 || channel > 2) {
-        qDebug() << "设置零点参考失败: 通道无效。必须是 1 或 2。";
+    if (channel < 1 || channel > channelCount_) {
+        qDebug() << "设置零点参考失败: 通道无效。必须是 1 ~" << channelCount_ << "。";
         return false;
     }
 
-    ChannelData& ch = channelData_[channel - 1]; // 根据通道号获取对应的 ChannelData 实例
+    const int index = channel - 1; // 根据通道号得到通道索引
 
     if (num > 0) {
-        ch.referenceZero = num;
-        ch.forceReferceFlagSet = true;
+        referenceZero_[index] = num;
+        zeroSet_[index] = true;
         qDebug() << "通道" << channel << "零点参考已显式设置为:" << num;
         return true;
     } else {
         // 如果传入的 num 小于等于 0，则尝试使用当前处理后的力值作为零点参考
-        if (ch.currentRawForce >= 0) { // 只有当当前处理后的力值非负时才允许设置为零点
-            ch.referenceZero = ch.currentRawForce;
-            ch.forceReferceFlagSet = true;
-            qDebug() << "通道" << channel << "零点参考设置为当前处理的力值:" << ch.currentRawForce;
+        if (currentRaw_[index] >= 0) { // 只有当当前处理后的力值非负时才允许设置为零点
+            referenceZero_[index] = currentRaw_[index];
+            zeroSet_[index] = true;
+            qDebug() << "通道" << channel << "零点参考设置为当前处理的力值:" << currentRaw_[index];
             return true;
         } else {
             qDebug() << "设置通道" << channel << "零点参考失败: 当前力值非正 (或 0)。";
@@ -332,12 +534,12 @@ bool ForceSensor::setSensitivity(double sensitivity, int channel)
         qDebug() << "设置灵敏度失败: 必须大于 0。";
         return false;
     }
-    if (channel < 1 || channel > 2) {
-        qDebug() << "设置灵敏度失败: 通道无效。必须是 1 或 2。";
+    if (channel < 1 || channel > channelCount_) {
+        qDebug() << "设置灵敏度失败: 通道无效。必须是 1 ~" << channelCount_ << "。";
         return false;
     }
 
-    channelData_[channel - 1].sensitivity = sensitivity; // 根据通道号设置对应的灵敏度
+    sensitivity_[channel - 1] = sensitivity; // 根据通道号设置对应的灵敏度
     qDebug() << "通道" << channel << "灵敏度设置为:" << sensitivity;
     return true;
 }
@@ -345,12 +547,12 @@ bool ForceSensor::setSensitivity(double sensitivity, int channel)
 // 获取指定通道的灵敏度
 bool ForceSensor::getSensitivity(double &sensitivity, int channel)
 {
-    if (channel < 1 || channel > 2) {
-        qDebug() << "获取灵敏度失败: 通道无效。必须是 1 或 2。";
+    if (channel < 1 || channel > channelCount_) {
+        qDebug() << "获取灵敏度失败: 通道无效。必须是 1 ~" << channelCount_ << "。";
         sensitivity = 0.0; // 如果通道无效，将输出参数设为默认值
         return false;
     }
-    sensitivity = channelData_[channel - 1].sensitivity; // 根据通道号获取对应的灵敏度
+    sensitivity = sensitivity_[channel - 1]; // 根据通道号获取对应的灵敏度
     return true;
 }
 
@@ -358,21 +560,36 @@ bool ForceSensor::getSensitivity(double &sensitivity, int channel)
 // 读取指定通道的力值 (绝对值或相对值)
 bool ForceSensor::getForce(int channel, bool isRelative, double &force)
 {
-    if (channel < 1 || channel > 2) {
-        qDebug() << "获取力值失败: 通道无效。必须是 1 或 2。";
+    if (channel < 1 || channel > channelCount_) {
+        qDebug() << "获取力值失败: 通道无效。必须是 1 ~" << channelCount_ << "。";
         force = 0.0; // 如果通道无效，将输出参数设为默认值
         return false;
     }
 
-    const ChannelData& ch = channelData_[channel - 1]; // 获取对应通道的常量引用
+    const int index = channel - 1; // 根据通道号得到通道索引
 
     if (isRelative) {
         // 计算相对力值: (当前原始力值 - 零点参考) * 灵敏度
-        force = static_cast<double>(ch.currentRawForce - ch.referenceZero) * ch.sensitivity;
+        force = static_cast<double>(currentRaw_[index] - referenceZero_[index]) * sensitivity_[index];
     } else {
         // 计算绝对力值: 当前原始力值 * 灵敏度
-        // 根据 `processRawForceData` 的逻辑，`currentRawForce` 最终会是非负的。
-        force = static_cast<double>(ch.currentRawForce) * ch.sensitivity;
+        // 根据 `processRawForceData` 的逻辑，`currentRaw_` 最终会是非负的。
+        force = static_cast<double>(currentRaw_[index]) * sensitivity_[index];
+    }
+    return true;
+}
+
+// 一次读取全部通道的力值
+bool ForceSensor::getForces(bool isRelative, double *forces, int count) const
+{
+    if (count < channelCount_) {
+        qDebug() << "获取力值失败: 输出数组长度" << count << "小于通道数" << channelCount_ << "。";
+        return false;
+    }
+    // 绝对力值即零点取 0；循环体无分支，按结构数组连续访问
+    const int zeroScale = isRelative ? 1 : 0;
+    for (int i = 0; i < channelCount_; ++i) {
+        forces[i] = static_cast<double>(currentRaw_[i] - zeroScale * referenceZero_[i]) * sensitivity_[i];
     }
     return true;
 }
@@ -2,27 +2,54 @@
 #define FORCESENSOR_H
 
 #include "SerialCommon.h" // 确保包含 SerialCommon 基类的定义
+#include "SpscRing.h"
+#include "ForceFrameDecoder.h"
 #include <QByteArray>
 #include <QString>
 #include <QDebug>
 #include <QElapsedTimer>
+#include <QVector>
+#include <QTimer>
+#include <QMetaType>
+
+class RawCaptureReader;
 
 // 串口通信协议相关的常量，用于提高代码可读性和可维护性
 namespace ForceSensorConstants {
 const int PACKET_SINGLE_CHANNEL_SIZE = 10; // 单通道数据包的完整字节长度，例如 "XXXXXX0b\r\n"
 const int PACKET_DUAL_CHANNEL_SIZE = 20;   // 双通道数据包的完整字节长度，例如 "XXXXXX0b\r\nYYYYYY0d\r\n"
-const char CHANNEL_ID_1_CHAR = 'b';        // 通道 1 在数据包中的标识符字符
-const char CHANNEL_ID_2_CHAR = 'd';        // 通道 2 在数据包中的标识符字符
+const char CHANNEL_ID_1_CHAR = 'b';        // 通道 1 在数据包中的默认标识符字符
+const char CHANNEL_ID_2_CHAR = 'd';        // 通道 2 在数据包中的默认标识符字符
+const int MAX_CHANNELS = ForceFrameDecoder::MAX_CHANNELS; // 可配置的通道数上限（setChannelIds）
 const QByteArray MESSAGE_TERMINATOR = "\r\n"; // 数据包的结束符 (回车+换行)
 const int HEX_VALUE_LENGTH = 6;            // 数据包中十六进制力值部分的长度
+const int RX_RING_CAPACITY = 1 << 16;      // 接收环形缓冲区容量（字节，必须为 2 的幂）
+const int RX_RING_MASK = RX_RING_CAPACITY - 1;
+const int RX_BATCH_FRAMES = 256;           // 单次批量（SIMD）解码的最大帧数
+const int RX_BATCH_MIN_FRAMES = 8;         // 连续完整帧不少于此数时才走批量路径
+const int DEFAULT_SAMPLE_BATCH_SIZE = 256; // 样本批量投递的默认条数
+const int DEFAULT_SAMPLE_BATCH_LATENCY_MS = 10; // 样本批量投递的默认最大等待时长（毫秒）
 }
 
+// 单个通道的一次力值样本，按批次通过 forceBatchReady 投递
+struct ForceSample {
+    long long timestampUs;  // 高分辨率单调时钟微秒时间戳
+    int channel;            // 通道号（1 ~ channelCount）
+    int raw;                // 原始计数（负值处理后），absoluteForce = raw × 该通道灵敏度
+    double absoluteForce;   // 绝对力值
+    double relativeForce;   // 相对于零点的力值
+};
+Q_DECLARE_METATYPE(ForceSample)
+
+// 采集线程到存储线程的样本环形缓冲区（单生产者/单消费者）
+using ForceSampleRing = TCM::SpscRing<ForceSample>;
+
 class ForceSensor : public SerialCommon
 {
     Q_OBJECT // 声明为 Qt 对象，支持信号与槽机制
 
 public:
-    // 构造函数：初始化传感器，设置串口名称和两个通道的灵敏度
+    // 构造函数：初始化传感器，设置串口名称和前两个通道的灵敏度（默认两通道 'b'/'d'，其余通道灵敏度为 1.0）
     ForceSensor(const QString &portName, double sensitivityCH1, double sensitivityCH2);
     // 析构函数：负责资源的清理，使用 override 关键字明确表示重写基类虚函数
     ~ForceSensor() override;
@@ -38,29 +65,64 @@ public:
     // 断开串口连接
     bool disConnect();
 
+    // 配置通道标识（应在连接前设置）：ids[i] 为通道 i + 1 在数据包中的标识符字符，例如 "bd"（默认）或 "abcdefgh"。
+    // 数量须为 1 ~ MAX_CHANNELS，标识不能重复。成功后各通道零点重置，灵敏度保持不变。
+    bool setChannelIds(const QByteArray &ids);
+    // 当前通道数
+    int channelCount() const { return channelCount_; }
+
     // 为指定通道设置零点参考值。
     // num: 如果大于 0，则直接使用此值作为零点；如果小于等于 0，则尝试使用当前通道的力值作为零点。
-    // channel: 指定要设置的通道（1 或 2）。
+    // channel: 指定要设置的通道（1 ~ channelCount）。
     // 返回 true 表示成功设置，false 表示失败（例如通道无效，或当前力值不适合作为零点）。
     bool setReferenceZero(int num, int channel);
 
     // 为指定通道设置灵敏度。
     // sensitivity: 灵敏度值，必须大于 0。
-    // channel: 指定要设置的通道（1 或 2）。
+    // channel: 指定要设置的通道（1 ~ channelCount）。
     // 返回 true 表示成功设置，false 表示灵敏度无效或通道无效。
     bool setSensitivity(double sensitivity, int channel);
     // 获取指定通道的灵敏度。
     // sensitivity: 输出参数，用于存储获取到的灵敏度。
-    // channel: 指定要获取的通道（1 或 2）。
+    // channel: 指定要获取的通道（1 ~ channelCount）。
     // 返回 true 表示成功获取，false 表示通道无效。
     bool getSensitivity(double &sensitivity, int channel);
 
     // 读取指定通道的力值。
-    // channel: 指定要读取的通道（1 或 2）。
+    // channel: 指定要读取的通道（1 ~ channelCount）。
     // isRelative: 如果为 true，则返回相对于零点参考的力值；否则，返回原始（绝对）力值。
     // force: 输出参数，用于存储计算后的力值。
     // 返回 true 表示成功读取，false 表示通道无效。
     bool getForce(int channel, bool isRelative, double &force);
+    // 一次读取全部通道的力值（一次换算，代替逐通道调用 getForce）。
+    // forces: 输出数组，forces[i] 为通道 i + 1 的力值；count 必须不小于 channelCount()。
+    // 返回 true 表示成功读取，false 表示 count 不足。
+    bool getForces(bool isRelative, double *forces, int count) const;
+
+    // 批量投递配置（应在传感器线程启动前设置）
+    // samples: 累计到该样本数即投递一批，必须大于 0。
+    void setBatchSize(int samples);
+    // ms: 批内最早样本等待超过该时长即投递，保证低速率时的延迟上界；必须大于 0。
+    void setBatchMaxLatencyMs(int ms);
+
+    // 设置样本环形缓冲区（应在传感器线程启动前设置，ring 的生命周期由调用方管理）。
+    // 设置后样本直接写入该缓冲区，由存储线程批量取出，不再通过 forceBatchReady 投递；传 nullptr 恢复信号投递。
+    void setSampleRing(ForceSampleRing *ring) { sampleRing_ = ring; }
+
+    // 当前时间戳（与样本 timestampUs 同一时基），可用于换算样本的墙钟时间
+    long long currentTimestampUs() const { return highResTimer_.isValid() ? highResTimer_.nsecsElapsed() / 1000 : 0; }
+
+    // 离线输入：把一段原始字节（例如抓取文件中的一块）送入解析器，处理方式与从串口读到的数据相同。
+    // timestampNs >= 0 时，由这段数据解析出的样本使用该时间戳，而不是当前时间。
+    // 应在未连接串口时使用。
+    void feedRaw(const char *data, int size, qint64 timestampNs = -1);
+    // 把抓取文件从当前位置到末尾的全部数据块依次送入解析器（不按原始节奏等待，尽可能快），
+    // 样本沿用抓取时的时间戳，结束时投递残留样本。返回处理的块数
+    quint64 replayCapture(RawCaptureReader &reader);
+
+public slots:
+    // 立即投递当前累积的样本（若有）
+    void flushBatch();
 
 signals:
     // 新增信号：当成功处理并计算出力值时发出。
@@ -68,48 +130,99 @@ signals:
     // absoluteForce: 绝对力值。
     // relativeForce: 相对于零点的力值。
     // timestampUs: 高分辨率单调时钟（QElapsedTimer）微秒时间戳，适合 5kHz 以上速率。
+    // 仅在未设置环形缓冲区、且 forceBatchReady 没有接收方时发出。
     void forceDataReady(int channel, double absoluteForce, double relativeForce, long long timestampUs);
+    // 批量信号：一次投递一段连续的样本，按条数或时间上界触发。
+    // 跨线程时每批只产生一次事件投递，替代逐样本的 forceDataReady。
+    void forceBatchReady(const QVector<ForceSample> &batch);
 
 private slots:
     // 重写 SerialCommon 的 readData 槽函数。当串口有新数据可读时，此槽函数会被触发。
     void readData() override;
 
-private:
-    // 内部结构体，用于封装每个力传感器通道的私有数据和状态
-    struct ChannelData {
-        int referenceZero = 0;              // 该通道的零点参考值
-        bool forceReferceFlagSet = false;   // 标志，表示该通道的零点参考是否已设定
-        int lastProcessedRawForce = 0;      // 上一次成功处理的原始力值，用于处理负值异常
-        int currentRawForce = 0;            // 最新处理的原始力值
-        double sensitivity = 0.0;           // 该通道的灵敏度（例如，单位力对应的传感器读数）
-    };
+protected:
+    // 抓取时间戳与样本时间戳使用同一时基，回放时样本时间与原始采集一致
+    qint64 captureTimestampNs() const override;
+    // Direct 读取模式（setReadMode）：在读线程中直接读入接收缓冲区并解析，批量时间上界由读线程的 poll 超时保证。
+    // 此模式下样本在读线程中产生：setSampleRing 的环形缓冲区以读线程为生产者，forceBatchReady 从读线程发出
+    void directReadReady(int fd) override;
+    int directIdleTimeoutMs() const override;
+    void directIdle() override;
 
-    ChannelData channelData_[2]; // 包含两个 ChannelData 实例的数组，分别代表通道 1 和通道 2
+private:
+    // 各通道的标定状态，按通道索引（0 起）分列存放（结构数组），
+    // 一批样本或全部通道的力值换算是对连续数组的一个循环，编译器可以向量化
+    ForceFrameDecoder::ChannelMap channelMap_; // 标识字符 -> 通道索引
+    int channelCount_ = 2;
+    alignas(32) double sensitivity_[ForceSensorConstants::MAX_CHANNELS];  // 灵敏度（单位读数对应的力）
+    alignas(32) int referenceZero_[ForceSensorConstants::MAX_CHANNELS];   // 零点参考值
+    alignas(32) int currentRaw_[ForceSensorConstants::MAX_CHANNELS];      // 最新处理的原始力值
+    alignas(32) int lastRaw_[ForceSensorConstants::MAX_CHANNELS];         // 上一次有效的原始力值，用于处理负值异常
+    bool zeroSet_[ForceSensorConstants::MAX_CHANNELS];                    // 零点参考是否已设定
 
     QString portName_;           // 存储串口的名称
-    QByteArray buffer_;          // 内部缓冲区，用于累积从串口接收到的不完整数据包
     QElapsedTimer highResTimer_; // 高分辨率单调计时器，用于生成微秒级时间戳
 
+    // 固定容量的接收环形缓冲区：串口数据直接读入，帧在原地解析，不做逐帧的堆分配与内存搬移。
+    // 读/写游标单调递增，取模（& RX_RING_MASK）后得到实际下标；两者之差即为未处理字节数。
+    char rxRing_[ForceSensorConstants::RX_RING_CAPACITY];
+    quint64 rxReadPos_ = 0;      // 下一个待解析字节的位置
+    quint64 rxWritePos_ = 0;     // 下一个写入字节的位置
+    // 批量解码的输出：连续的原始值数组（标定前）及对应的通道索引，以及换算后的力值
+    alignas(32) int rxBatchRaws_[ForceSensorConstants::RX_BATCH_FRAMES];
+    quint8 rxBatchChannels_[ForceSensorConstants::RX_BATCH_FRAMES];
+    alignas(32) double rxBatchAbs_[ForceSensorConstants::RX_BATCH_FRAMES];
+    alignas(32) double rxBatchRel_[ForceSensorConstants::RX_BATCH_FRAMES];
+
+    // 待投递的样本批次
+    QVector<ForceSample> pendingBatch_;
+    int batchSize_ = ForceSensorConstants::DEFAULT_SAMPLE_BATCH_SIZE;
+    qint64 batchMaxLatencyNs_ = ForceSensorConstants::DEFAULT_SAMPLE_BATCH_LATENCY_MS * 1000000LL;
+    qint64 batchFirstNs_ = 0;    // 当前批次第一个样本的时间（纳秒）
+    QTimer *batchTimer_;         // 数据流停顿时按时间上界投递残留样本
+    ForceSampleRing *sampleRing_ = nullptr; // 非空时样本写入该环形缓冲区
+    qint64 timestampOverrideNs_ = -1; // feedRaw 指定的样本时间戳（纳秒），-1 为使用当前时间
+
     // 私有辅助函数：处理单个通道的原始力数据。
     // rawForce: 从传感器读取到的原始力值。
-    // channelIndex: 对应 channelData_ 数组的索引（0 或 1）。
+    // channelIndex: 通道索引（0 ~ channelCount_ - 1）。
     // 返回经过零点参考和负值处理后的力值。
     int processRawForceData(int rawForce, int channelIndex);
 
-    // 私有辅助函数：解析一个完整的传感器数据包（10字节或20字节）。
-    // packet: 待解析的完整数据包。
-    // 如果成功解析并处理了数据包中的力值，返回 true；否则返回 false。
-    bool parseAndProcessDataPacket(const QByteArray &packet);
+    // 私有辅助函数：解析并处理一个 10 字节单帧（frame 指向连续的 10 字节）。
+    // 双通道数据包即两个连续的单帧，逐帧解析即可。
+    // 如果成功解析并处理了帧中的力值，返回 true；否则返回 false。
+    bool parseAndProcessFrame(const char *frame);
 
-    // 私有辅助函数：处理内部缓冲区中累积的数据。
-    // 它会尝试从缓冲区中识别并提取完整的传感器数据包，然后调用 parseAndProcessDataPacket 进行处理。
+    // 私有辅助函数：对一个已解码的样本做零点/负值处理、标定并发射信号。
+    void processDecodedSample(int channelIndex, int rawForce);
+
+    // 私有辅助函数：批量处理 decodeFrames 的输出（原地修改 raws）。
+    // 先按到达顺序更新零点/负值状态，再用一个循环换算全部样本的绝对/相对力值，最后逐个投递。
+    void processDecodedBatch(const quint8 *channels, int *raws, int count);
+
+    // 私有辅助函数：投递一个已换算的样本（信号、环形缓冲区或批次）。
+    void deliverSample(const ForceSample &sample, qint64 nowNs);
+
+    // 私有辅助函数：清除全部通道的零点参考标志。
+    void resetReferenceZero();
+
+    // 私有辅助函数：处理环形缓冲区中累积的数据。
+    // 它会尝试从缓冲区中识别完整的帧，然后调用 parseAndProcessFrame 进行处理。
     void processReceivedBuffer();
 
-    // 私有辅助函数：将十六进制字符串安全转换为整数，并进行错误检查。
-    // hexString: 待转换的十六进制字符串。
-    // result: 输出参数，存储转换后的整数结果。
-    // 成功转换返回 true，失败返回 false。
-    bool tryConvertHexToInt(const QByteArray& hexString, int& result);
+    // 私有辅助函数：通过 read 读出全部可读数据到接收缓冲区（逐段抓取），然后解析。
+    template <typename ReadFn>
+    void receive(ReadFn read);
+
+    // 私有辅助函数：返回环形缓冲区的空闲字节数；已满时先解析腾出空间，仍无法腾出则清空。
+    quint64 reserveRx();
+
+    // 私有辅助函数：从读游标偏移 offset 处拷贝 n 个字节到 dst（处理环绕）。
+    void peekRx(quint64 offset, char *dst, int n) const;
+
+    // 私有辅助函数：清空环形缓冲区。
+    void resetRx() { rxReadPos_ = rxWritePos_ = 0; }
 };
 
 #endif // FORCESENSOR_H
@@ -0,0 +1,353 @@
+#include "ForceSensorSimulator.h"
+#include "ForceFrameDecoder.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace {
+const char kHexDigits[] = "0123456789ABCDEF";
+const char kGarbage[] = "#@!?~%";
+const double kTwoPi = 6.283185307179586;
+const int kMaxBatchMs = 100; // 单次写入最多合并的时长（毫秒），接收端长时间阻塞后避免一次生成过多数据
+
+// 按协议写一帧 "XXXXXX0b\r\n"
+void encodeFrame(char *p, int raw, char channelId)
+{
+    for (int i = ForceFrameDecoder::HEX_DIGITS - 1; i >= 0; --i) {
+        p[i] = kHexDigits[raw & 0xF];
+        raw >>= 4;
+    }
+    p[ForceFrameDecoder::FILLER_OFFSET] = '0';
+    p[ForceFrameDecoder::CHANNEL_OFFSET] = channelId;
+    p[ForceFrameDecoder::CR_OFFSET] = '\r';
+    p[ForceFrameDecoder::LF_OFFSET] = '\n';
+}
+}
+
+ForceSensorSimulator::ForceSensorSimulator(QObject *parent)
+    : QThread(parent)
+{
+    // 默认各通道频率不同的正弦，便于肉眼区分
+    for (int c = 1; c < ForceFrameDecoder::MAX_CHANNELS; ++c) {
+        channel_[c].frequencyHz = 1.0 / (c + 1);
+    }
+}
+
+ForceSensorSimulator::~ForceSensorSimulator()
+{
+    close();
+}
+
+bool ForceSensorSimulator::open()
+{
+#if defined(Q_OS_LINUX)
+    close();
+    masterFd_ = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (masterFd_ < 0 || ::grantpt(masterFd_) != 0 || ::unlockpt(masterFd_) != 0) {
+        qDebug() << "模拟器: 无法创建伪终端:" << std::strerror(errno);
+        close();
+        return false;
+    }
+    char name[128];
+    if (::ptsname_r(masterFd_, name, sizeof(name)) != 0) {
+        qDebug() << "模拟器: 无法获取伪终端从端名称:" << std::strerror(errno);
+        close();
+        return false;
+    }
+    // 从端设为原始模式（不回显、不做行处理），并保持打开
+    slaveFd_ = ::open(name, O_RDWR | O_NOCTTY);
+    termios tio;
+    if (slaveFd_ < 0 || ::tcgetattr(slaveFd_, &tio) != 0) {
+        qDebug() << "模拟器: 无法打开伪终端从端" << name << ":" << std::strerror(errno);
+        close();
+        return false;
+    }
+    ::cfmakeraw(&tio);
+    ::tcsetattr(slaveFd_, TCSANOW, &tio);
+    // 主端非阻塞：缓冲区满时由 run() 决定丢弃还是等待
+    ::fcntl(masterFd_, F_SETFL, ::fcntl(masterFd_, F_GETFL) | O_NONBLOCK);
+    portName_ = QString::fromLocal8Bit(name);
+    qDebug() << "模拟器: 伪终端" << portName_;
+    return true;
+#else
+    qDebug() << "模拟器: 仅支持 Linux 伪终端。";
+    return false;
+#endif
+}
+
+void ForceSensorSimulator::close()
+{
+    stopAndWait();
+#if defined(Q_OS_LINUX)
+    if (slaveFd_ >= 0) {
+        ::close(slaveFd_);
+    }
+    if (masterFd_ >= 0) {
+        ::close(masterFd_);
+    }
+#endif
+    slaveFd_ = -1;
+    masterFd_ = -1;
+    portName_.clear();
+}
+
+bool ForceSensorSimulator::setRateHz(int hz)
+{
+    if (hz < 1 || hz > 50000) {
+        qDebug() << "模拟器: 速率必须在 1 ~ 50000 Hz 之间。";
+        return false;
+    }
+    rateHz_ = hz;
+    return true;
+}
+
+bool ForceSensorSimulator::setChannelIds(const QByteArray &ids)
+{
+    // 与接收端使用同一套校验（数量、重复、结束符）
+    ForceFrameDecoder::ChannelMap map;
+    if (!map.assign(ids.constData(), ids.size())) {
+        qDebug() << "模拟器: 通道标识无效（1 ~" << ForceFrameDecoder::MAX_CHANNELS << "个不重复字符）:" << ids;
+        return false;
+    }
+    channelIds_ = ids;
+    channels_ = ids.size();
+    return true;
+}
+
+bool ForceSensorSimulator::setChannels(int channels)
+{
+    if (channels < 1 || channels > channelIds_.size()) {
+        qDebug() << "模拟器: 通道数必须是 1 ~" << channelIds_.size() << "。";
+        return false;
+    }
+    channels_ = channels;
+    return true;
+}
+
+bool ForceSensorSimulator::setWaveform(int channel, Waveform waveform, double amplitude, double frequencyHz, int offset)
+{
+    if (channel < 1 || channel > channelIds_.size()) {
+        qDebug() << "模拟器: 通道无效。必须是 1 ~" << channelIds_.size() << "。";
+        return false;
+    }
+    Channel &ch = channel_[channel - 1];
+    ch.waveform = waveform;
+    ch.amplitude = amplitude;
+    ch.frequencyHz = frequencyHz;
+    ch.offset = offset;
+    return true;
+}
+
+qint64 ForceSensorSimulator::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+qint64 ForceSensorSimulator::packetDueNs(quint64 seq) const
+{
+    const qint64 start = startNs_.load(std::memory_order_acquire);
+    if (start == 0) {
+        return 0;
+    }
+    return start + static_cast<qint64>(seq * 1000000000ULL / static_cast<quint64>(rateHz_));
+}
+
+ForceSensorSimulator::Stats ForceSensorSimulator::stats() const
+{
+    Stats s;
+    s.packets = packets_.load(std::memory_order_relaxed);
+    s.sent = sent_.load(std::memory_order_relaxed);
+    s.corrupted = corrupted_.load(std::memory_order_relaxed);
+    s.skipped = skipped_.load(std::memory_order_relaxed);
+    s.overrun = overrun_.load(std::memory_order_relaxed);
+    s.maxLagNs = maxLagNs_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void ForceSensorSimulator::stopAndWait()
+{
+    stopRequested_.store(true);
+    wait();
+    stopRequested_.store(false);
+}
+
+int ForceSensorSimulator::rawValue(const Channel &channel, quint64 seq, double noise) const
+{
+    if (channel.waveform == Waveform::Counter) {
+        return static_cast<int>((seq + static_cast<quint64>(channel.offset)) & 0xFFFFFF);
+    }
+    const double t = static_cast<double>(seq) / rateHz_;
+    double shape = 0.0;
+    switch (channel.waveform) {
+    case Waveform::Sine:
+        shape = std::sin(kTwoPi * channel.frequencyHz * t);
+        break;
+    case Waveform::Square:
+        shape = std::sin(kTwoPi * channel.frequencyHz * t) >= 0.0 ? 1.0 : -1.0;
+        break;
+    case Waveform::Triangle: {
+        const double phase = channel.frequencyHz * t - std::floor(channel.frequencyHz * t);
+        shape = 1.0 - 4.0 * std::fabs(phase - 0.5);
+        break;
+    }
+    default:
+        break;
+    }
+    const double value = channel.offset + channel.amplitude * shape + noise;
+    return static_cast<int>(std::min(std::max(std::lround(value), 0L), 0xFFFFFFL));
+}
+
+void ForceSensorSimulator::run()
+{
+#if defined(Q_OS_LINUX)
+    if (masterFd_ < 0) {
+        qDebug() << "模拟器: 未创建伪终端，请先调用 open()。";
+        return;
+    }
+    using ForceFrameDecoder::FRAME_SIZE;
+    packets_.store(0);
+    sent_.store(0);
+    corrupted_.store(0);
+    skipped_.store(0);
+    overrun_.store(0);
+    maxLagNs_.store(0);
+
+    std::mt19937 rng(seed_);
+    std::normal_distribution<double> noise(0.0, noiseStddev_ > 0.0 ? noiseStddev_ : 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::uniform_int_distribution<int> pick(0, 1 << 20);
+
+    const double gapProbability = gapsPerSecond_ > 0.0 ? gapsPerSecond_ / rateHz_ : 0.0;
+    const quint64 gapPackets = static_cast<quint64>(gapDurationMs_) * static_cast<quint64>(rateHz_) / 1000;
+    const quint64 maxBatch = std::max<quint64>(1, static_cast<quint64>(rateHz_) * kMaxBatchMs / 1000);
+    const int packetBytes = channels_ * FRAME_SIZE;
+
+    std::vector<char> buffer;
+    buffer.reserve(static_cast<size_t>(maxBatch) * (packetBytes + 8));
+    std::vector<int> packetEnds;          // 本批各数据包在 buffer 中的结束位置
+    std::vector<bool> packetCorrupted;
+    packetEnds.reserve(maxBatch);
+    packetCorrupted.reserve(maxBatch);
+
+    const qint64 start = nowNs();
+    startNs_.store(start, std::memory_order_release);
+    quint64 seq = 0;
+    quint64 gapUntil = 0;
+    qint64 tick = start;
+    char input[4096];
+
+    while (!stopRequested_.load(std::memory_order_relaxed)) {
+        // 丢弃接收端发来的命令，避免反向缓冲区写满
+        while (::read(masterFd_, input, sizeof(input)) > 0) {
+        }
+
+        // 生成排期已到的数据包
+        const qint64 now = nowNs();
+        quint64 due = static_cast<quint64>((now - start) * rateHz_ / 1000000000LL) + 1;
+        due = std::min(due, seq + maxBatch);
+        const quint64 first = seq;
+        buffer.clear();
+        packetEnds.clear();
+        packetCorrupted.clear();
+        for (; seq < due; ++seq) {
+            if (seq < gapUntil) {
+                skipped_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            if (gapProbability > 0.0 && uniform(rng) < gapProbability) {
+                gapUntil = seq + std::max<quint64>(gapPackets, 1);
+                skipped_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            const bool corrupt = corruptionRate_ > 0.0 && uniform(rng) < corruptionRate_;
+            const int kind = corrupt ? pick(rng) % 3 : -1;
+            if (kind == 2) {
+                // 插入 1 ~ 5 个垃圾字节
+                const int n = 1 + pick(rng) % 5;
+                for (int i = 0; i < n; ++i) {
+                    buffer.push_back(kGarbage[pick(rng) % (sizeof(kGarbage) - 1)]);
+                }
+            }
+            const size_t at = buffer.size();
+            buffer.resize(at + static_cast<size_t>(packetBytes));
+            for (int c = 0; c < channels_; ++c) {
+                const double n = noiseStddev_ > 0.0 ? noise(rng) : 0.0;
+                encodeFrame(&buffer[at + static_cast<size_t>(c) * FRAME_SIZE], rawValue(channel_[c], seq, n), channelIds_.at(c));
+            }
+            if (kind == 0) {
+                buffer[at + static_cast<size_t>(pick(rng) % ForceFrameDecoder::HEX_DIGITS)] = 'Z'; // 非法十六进制字符
+            } else if (kind == 1) {
+                buffer.pop_back(); // 缺失结束符 '\n'
+            }
+            packetEnds.push_back(static_cast<int>(buffer.size()));
+            packetCorrupted.push_back(corrupt);
+        }
+        packets_.fetch_add(due - first, std::memory_order_relaxed);
+
+        // 写出；缓冲区满时丢弃剩余数据包，或在 blockOnFull 时等待
+        size_t written = 0;
+        while (written < buffer.size() && !stopRequested_.load(std::memory_order_relaxed)) {
+            const ssize_t n = ::write(masterFd_, buffer.data() + written, buffer.size() - written);
+            if (n > 0) {
+                written += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && errno == EAGAIN && blockOnFull_) {
+                pollfd pfd { masterFd_, POLLOUT, 0 };
+                ::poll(&pfd, 1, 50);
+                continue;
+            }
+            if (n < 0 && errno != EAGAIN) {
+                qDebug() << "模拟器: 写入伪终端失败:" << std::strerror(errno);
+                stopRequested_.store(true);
+            }
+            break;
+        }
+        quint64 sent = 0;
+        quint64 corrupted = 0;
+        for (size_t i = 0; i < packetEnds.size() && static_cast<size_t>(packetEnds[i]) <= written; ++i) {
+            ++sent;
+            corrupted += packetCorrupted[i] ? 1 : 0;
+        }
+        sent_.fetch_add(sent, std::memory_order_relaxed);
+        corrupted_.fetch_add(corrupted, std::memory_order_relaxed);
+        overrun_.fetch_add(packetEnds.size() - sent, std::memory_order_relaxed);
+        if (due > first) {
+            const qint64 lag = nowNs() - packetDueNs(first);
+            if (lag > maxLagNs_.load(std::memory_order_relaxed)) {
+                maxLagNs_.store(lag, std::memory_order_relaxed);
+            }
+        }
+
+        // 按绝对时刻休眠到下一个写入周期，落后时不累积
+        tick += static_cast<qint64>(writeIntervalUs_) * 1000;
+        const qint64 after = nowNs();
+        if (tick < after) {
+            tick = after;
+        }
+        const qint64 sleepNs = tick - after;
+        if (sleepNs > 0) {
+            timespec ts { static_cast<time_t>(sleepNs / 1000000000LL), static_cast<long>(sleepNs % 1000000000LL) };
+            ::nanosleep(&ts, nullptr);
+        }
+    }
+#endif
+}
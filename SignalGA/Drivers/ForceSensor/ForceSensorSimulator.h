@@ -0,0 +1,123 @@
+#ifndef FORCESENSORSIMULATOR_H
+#define FORCESENSORSIMULATOR_H
+
+#include <QThread>
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+#include "ForceFrameDecoder.h"
+
+// ForceSensorSimulator: 基于 Linux 伪终端（pty）的力传感器模拟器，用于没有实物时的负载测试。
+// open() 创建一对 pty，portName() 返回从端路径（如 /dev/pts/5），ForceSensor::connect(portName, ...) 可直接连接。
+// 线程运行后按设定速率在主端写出与实物相同的协议："XXXXXX0b\r\n"（单通道）或 "XXXXXX0b\r\nYYYYYY0d\r\n"（双通道），
+// 多通道放大器按 setChannelIds 的标识依次发送每个通道的一帧，
+// 每个数据包的发送时刻按速率固定排期，每隔 writeIntervalUs 把到期的数据包合并为一次写入。
+// 可选注入噪声、损坏（非法字符 / 缺失结束符 / 插入垃圾字节）与断流（一段时间内不发送，序号照常递增）。
+//
+// 波形 Counter 的原始值为数据包序号（24 位回绕），接收端据此识别丢包，并用 packetDueNs(序号) 与 nowNs() 计算延迟。
+// 接收端跟不上、pty 缓冲区已满时，默认像实物串口一样丢弃数据包并计数；setBlockOnFull(true) 则等待可写。
+// 配置须在 start() 之前完成。仅 Linux 可用，其他平台 open() 返回 false。
+class ForceSensorSimulator : public QThread
+{
+    Q_OBJECT
+
+public:
+    enum class Waveform {
+        Constant,   // offset
+        Sine,       // offset + amplitude * sin(2π f t)
+        Square,     // offset ± amplitude
+        Triangle,   // offset + amplitude * 三角波（-1 ~ 1）
+        Counter     // (数据包序号 + offset) & 0xFFFFFF，忽略 amplitude/frequency 与噪声
+    };
+
+    // 发包统计（可在任意线程读取）
+    struct Stats {
+        quint64 packets = 0;    // 已排期的数据包数（含下面各类未正常送达的）
+        quint64 sent = 0;       // 已写入 pty 的数据包
+        quint64 corrupted = 0;  // 已写入但被注入损坏的数据包
+        quint64 skipped = 0;    // 断流期间未发送的数据包
+        quint64 overrun = 0;    // pty 缓冲区满而丢弃的数据包
+        qint64 maxLagNs = 0;    // 实际写出时间相对排期的最大滞后
+    };
+
+    explicit ForceSensorSimulator(QObject *parent = nullptr);
+    ~ForceSensorSimulator() override;
+
+    // 创建 pty，成功后 portName() 有效
+    bool open();
+    // 停止线程并关闭 pty
+    void close();
+    QString portName() const { return portName_; }
+
+    // 数据包速率（包/秒，1 ~ 50000），每包含每个通道各一帧
+    bool setRateHz(int hz);
+    int rateHz() const { return rateHz_; }
+    // 通道标识（默认 "bd"，1 ~ ForceFrameDecoder::MAX_CHANNELS 个不重复字符），通道数随之设为标识个数
+    bool setChannelIds(const QByteArray &ids);
+    // 通道数（1 ~ 标识个数）：只发送前 channels 个通道，例如默认标识下 1 只发 'b' 通道，2 发 'b'/'d' 两帧
+    bool setChannels(int channels);
+    // 通道波形（channel 为 1 ~ 标识个数），原始值限制在 0 ~ 0xFFFFFF
+    bool setWaveform(int channel, Waveform waveform, double amplitude = 0.0, double frequencyHz = 1.0, int offset = 0x400000);
+    // 高斯噪声的标准差（原始值单位）
+    void setNoise(double stddev) { noiseStddev_ = stddev; }
+    // 每个数据包被损坏的概率（0 ~ 1）
+    void setCorruptionRate(double probability) { corruptionRate_ = probability; }
+    // 平均每秒出现 gapsPerSecond 次断流，每次持续 durationMs
+    void setGaps(double gapsPerSecond, int durationMs) { gapsPerSecond_ = gapsPerSecond; gapDurationMs_ = durationMs; }
+    // 合并写入的间隔（微秒，默认 1000）
+    void setWriteIntervalUs(int us) { writeIntervalUs_ = us > 0 ? us : 1; }
+    void setBlockOnFull(bool block) { blockOnFull_ = block; }
+    void setSeed(quint32 seed) { seed_ = seed; }
+
+    // 与 packetDueNs 同一时基的当前时间（纳秒，单调时钟）
+    static qint64 nowNs();
+    // 第 seq 个数据包的排期发送时刻，线程启动前为 0
+    qint64 packetDueNs(quint64 seq) const;
+
+    Stats stats() const;
+
+    // 请求停止并等待线程结束
+    void stopAndWait();
+
+protected:
+    void run() override;
+
+private:
+    struct Channel {
+        Waveform waveform = Waveform::Sine;
+        double amplitude = 200000.0;
+        double frequencyHz = 1.0;
+        int offset = 0x400000;
+    };
+
+    int rawValue(const Channel &channel, quint64 seq, double noise) const;
+
+    QString portName_;
+    int masterFd_ = -1;
+    int slaveFd_ = -1;    // 自己保持打开一个从端，使接收端断开重连时 pty 仍然有效
+
+    int rateHz_ = 5000;
+    QByteArray channelIds_ { "bd" };
+    int channels_ = 2;
+    Channel channel_[ForceFrameDecoder::MAX_CHANNELS];
+    double noiseStddev_ = 0.0;
+    double corruptionRate_ = 0.0;
+    double gapsPerSecond_ = 0.0;
+    int gapDurationMs_ = 0;
+    int writeIntervalUs_ = 1000;
+    bool blockOnFull_ = false;
+    quint32 seed_ = 1;
+
+    std::atomic<bool> stopRequested_ { false };
+    std::atomic<qint64> startNs_ { 0 };
+    std::atomic<quint64> packets_ { 0 };
+    std::atomic<quint64> sent_ { 0 };
+    std::atomic<quint64> corrupted_ { 0 };
+    std::atomic<quint64> skipped_ { 0 };
+    std::atomic<quint64> overrun_ { 0 };
+    std::atomic<qint64> maxLagNs_ { 0 };
+};
+
+#endif // FORCESENSORSIMULATOR_H
@@ -0,0 +1,237 @@
+#include "RawCapture.h"
+#include <QDebug>
+#include <QtEndian>
+#include <cstring>
+
+#if defined(Q_OS_UNIX)
+#include <sys/uio.h>
+#include <cerrno>
+#endif
+
+RawCapture::RawCapture()
+{
+}
+
+RawCapture::~RawCapture()
+{
+    close();
+}
+
+bool RawCapture::open(const QString &path, qint64 epochUs)
+{
+    close();
+    file_.setFileName(path);
+#if defined(Q_OS_UNIX)
+    // 数据由 writev 直接写出，不经过 QFile 的缓冲
+    const QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered;
+#else
+    const QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Truncate;
+#endif
+    if (!file_.open(mode)) {
+        qDebug() << "无法创建原始数据抓取文件" << path << ":" << file_.errorString();
+        return false;
+    }
+
+    char header[RawCaptureFormat::FILE_HEADER_SIZE];
+    std::memset(header, 0, sizeof(header));
+    std::memcpy(header, RawCaptureFormat::MAGIC, sizeof(RawCaptureFormat::MAGIC));
+    qToLittleEndian<quint32>(RawCaptureFormat::VERSION, header + 8);
+    qToLittleEndian<quint32>(RawCaptureFormat::FILE_HEADER_SIZE, header + 12);
+    qToLittleEndian<qint64>(epochUs, header + 16);
+    if (file_.write(header, sizeof(header)) != static_cast<qint64>(sizeof(header))) {
+        qDebug() << "写入原始数据抓取文件头失败:" << file_.errorString();
+        file_.close();
+        return false;
+    }
+    pending_ = 0;
+    chunkCount_ = 0;
+    byteCount_ = 0;
+    return true;
+}
+
+void RawCapture::close()
+{
+    if (!file_.isOpen()) {
+        return;
+    }
+    commit();
+    file_.close();
+}
+
+void RawCapture::append(qint64 timestampNs, const char *data, int size)
+{
+    if (size <= 0 || !file_.isOpen()) {
+        return;
+    }
+    if (pending_ == MAX_PENDING && !commit()) {
+        return;
+    }
+    qToLittleEndian<qint64>(timestampNs, headers_[pending_]);
+    qToLittleEndian<quint32>(static_cast<quint32>(size), headers_[pending_] + 8);
+    data_[pending_] = data;
+    sizes_[pending_] = size;
+    ++pending_;
+}
+
+bool RawCapture::write(qint64 timestampNs, const char *data, int size)
+{
+    append(timestampNs, data, size);
+    return commit();
+}
+
+bool RawCapture::commit()
+{
+    if (pending_ == 0) {
+        return file_.isOpen();
+    }
+    const int count = pending_;
+    qint64 bytes = 0;
+    for (int i = 0; i < count; ++i) {
+        bytes += sizes_[i];
+    }
+    pending_ = 0;
+
+#if defined(Q_OS_UNIX)
+    struct iovec iov[2 * MAX_PENDING];
+    for (int i = 0; i < count; ++i) {
+        iov[2 * i].iov_base = headers_[i];
+        iov[2 * i].iov_len = RawCaptureFormat::CHUNK_HEADER_SIZE;
+        iov[2 * i + 1].iov_base = const_cast<char *>(data_[i]);
+        iov[2 * i + 1].iov_len = static_cast<size_t>(sizes_[i]);
+    }
+    // 部分写入时跳过已写出的 iovec 继续写
+    struct iovec *cur = iov;
+    int left = 2 * count;
+    while (left > 0) {
+        const ssize_t n = ::writev(file_.handle(), cur, left);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            qDebug() << "原始数据抓取写入失败:" << std::strerror(errno) << "，停止抓取。";
+            file_.close();
+            return false;
+        }
+        size_t done = static_cast<size_t>(n);
+        while (left > 0 && done >= cur->iov_len) {
+            done -= cur->iov_len;
+            ++cur;
+            --left;
+        }
+        if (left > 0) {
+            cur->iov_base = static_cast<char *>(cur->iov_base) + done;
+            cur->iov_len -= done;
+        }
+    }
+#else
+    for (int i = 0; i < count; ++i) {
+        if (file_.write(headers_[i], RawCaptureFormat::CHUNK_HEADER_SIZE) != RawCaptureFormat::CHUNK_HEADER_SIZE
+            || file_.write(data_[i], sizes_[i]) != sizes_[i]) {
+            qDebug() << "原始数据抓取写入失败:" << file_.errorString() << "，停止抓取。";
+            file_.close();
+            return false;
+        }
+    }
+#endif
+
+    chunkCount_ += static_cast<quint64>(count);
+    byteCount_ += static_cast<quint64>(bytes);
+    return true;
+}
+
+RawCaptureReader::~RawCaptureReader()
+{
+    close();
+}
+
+bool RawCaptureReader::open(const QString &path)
+{
+    close();
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::ReadOnly)) {
+        qDebug() << "无法打开原始数据抓取文件" << path << ":" << file_.errorString();
+        return false;
+    }
+    size_ = file_.size();
+    if (size_ < RawCaptureFormat::FILE_HEADER_SIZE) {
+        qDebug() << "原始数据抓取文件过短:" << path;
+        file_.close();
+        return false;
+    }
+    map_ = file_.map(0, size_);
+    if (!map_) {
+        qDebug() << "无法映射原始数据抓取文件" << path << ":" << file_.errorString();
+        file_.close();
+        return false;
+    }
+
+    const char *header = reinterpret_cast<const char *>(map_);
+    const quint32 version = qFromLittleEndian<quint32>(header + 8);
+    const quint32 headerSize = qFromLittleEndian<quint32>(header + 12);
+    if (std::memcmp(header, RawCaptureFormat::MAGIC, sizeof(RawCaptureFormat::MAGIC)) != 0
+        || version != RawCaptureFormat::VERSION
+        || headerSize != static_cast<quint32>(RawCaptureFormat::FILE_HEADER_SIZE)) {
+        qDebug() << "不是原始数据抓取文件或版本不支持:" << path;
+        close();
+        return false;
+    }
+    epochUs_ = qFromLittleEndian<qint64>(header + 16);
+    rewind();
+    return true;
+}
+
+void RawCaptureReader::close()
+{
+    if (map_) {
+        file_.unmap(const_cast<uchar *>(map_));
+        map_ = nullptr;
+    }
+    if (file_.isOpen()) {
+        file_.close();
+    }
+    size_ = 0;
+    pos_ = 0;
+    truncated_ = false;
+}
+
+bool RawCaptureReader::next(Chunk &chunk)
+{
+    if (!map_ || pos_ >= size_) {
+        return false;
+    }
+    const char *p = reinterpret_cast<const char *>(map_) + pos_;
+    const qint64 left = size_ - pos_;
+    if (left < RawCaptureFormat::CHUNK_HEADER_SIZE) {
+        truncated_ = true;
+        return false;
+    }
+    const quint32 size = qFromLittleEndian<quint32>(p + 8);
+    if (static_cast<qint64>(size) > left - RawCaptureFormat::CHUNK_HEADER_SIZE) {
+        truncated_ = true;
+        return false;
+    }
+    chunk.timestampNs = qFromLittleEndian<qint64>(p);
+    chunk.data = p + RawCaptureFormat::CHUNK_HEADER_SIZE;
+    chunk.size = static_cast<int>(size);
+    pos_ += RawCaptureFormat::CHUNK_HEADER_SIZE + static_cast<qint64>(size);
+    return true;
+}
+
+qint64 RawCaptureReader::payloadBytes() const
+{
+    if (!map_) {
+        return 0;
+    }
+    qint64 bytes = 0;
+    qint64 pos = RawCaptureFormat::FILE_HEADER_SIZE;
+    const char *base = reinterpret_cast<const char *>(map_);
+    while (size_ - pos >= RawCaptureFormat::CHUNK_HEADER_SIZE) {
+        const qint64 size = qFromLittleEndian<quint32>(base + pos + 8);
+        if (size > size_ - pos - RawCaptureFormat::CHUNK_HEADER_SIZE) {
+            break;
+        }
+        bytes += size;
+        pos += RawCaptureFormat::CHUNK_HEADER_SIZE + size;
+    }
+    return bytes;
+}
@@ -0,0 +1,97 @@
+#ifndef RAWCAPTURE_H
+#define RAWCAPTURE_H
+
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+
+// 串口原始字节流抓取文件格式（小端）
+// 文件头 32 字节：魔数 "SGRAWCAP"(8) + 版本(4) + 文件头长度(4) + 时间戳 0 对应的墙钟时间(微秒, 8) + 保留(8)
+// 之后逐块记录：时间戳(纳秒, qint64) + 字节数(quint32) + 该次从串口读到的原始字节
+namespace RawCaptureFormat {
+const char MAGIC[8] = { 'S', 'G', 'R', 'A', 'W', 'C', 'A', 'P' };
+const quint32 VERSION = 1;
+const int FILE_HEADER_SIZE = 32;
+const int CHUNK_HEADER_SIZE = 12;
+}
+
+// RawCapture: 抓取文件写端，每次从串口读到的数据块连同时间戳追加写入。
+// append() 只记录数据块的地址，不拷贝；commit() 时把排队的块头与数据一起用一次 writev 写出
+// （非 POSIX 平台退回逐段写入）。因此 append 的数据在 commit 之前必须保持有效且不被改写，
+// 例如仍在接收缓冲区中、尚未被下一次读取覆盖。排队的块数达到上限时 append 会自动 commit。
+// 写入失败时输出错误并关闭文件，之后的 append/commit 不再生效。
+class RawCapture
+{
+public:
+    RawCapture();
+    ~RawCapture();
+
+    // epochUs: 时间戳 0 对应的墙钟时间（微秒），写入文件头供离线换算
+    bool open(const QString &path, qint64 epochUs);
+    // 写出排队的块并关闭文件
+    void close();
+    bool isOpen() const { return file_.isOpen(); }
+    QString path() const { return file_.fileName(); }
+
+    // 排队一个数据块（不拷贝），size 为 0 时忽略
+    void append(qint64 timestampNs, const char *data, int size);
+    // 写出排队的块，失败返回 false
+    bool commit();
+    // 排队并立即写出，用于数据随后即失效的场合（如 readAll() 返回的临时 QByteArray）
+    bool write(qint64 timestampNs, const char *data, int size);
+
+    quint64 chunkCount() const { return chunkCount_; }
+    quint64 byteCount() const { return byteCount_; }
+
+private:
+    static const int MAX_PENDING = 64; // 单次 commit 的最大块数（2 * MAX_PENDING 个 iovec）
+
+    QFile file_;
+    char headers_[MAX_PENDING][RawCaptureFormat::CHUNK_HEADER_SIZE]; // 排队块的块头
+    const char *data_[MAX_PENDING];                                  // 排队块的数据地址（不持有）
+    int sizes_[MAX_PENDING];
+    int pending_ = 0;
+    quint64 chunkCount_ = 0;
+    quint64 byteCount_ = 0;
+};
+
+// RawCaptureReader: 抓取文件读端。整个文件以只读方式映射，next() 返回的数据指针直接指向映射内存（不拷贝），
+// 在 close() 或对象销毁前有效。抓取中断导致文件末尾的块不完整时，读到该块即结束并置 isTruncated()。
+class RawCaptureReader
+{
+public:
+    struct Chunk {
+        qint64 timestampNs; // 抓取时的时间戳（纳秒）
+        const char *data;   // 指向映射内存
+        int size;
+    };
+
+    RawCaptureReader() = default;
+    ~RawCaptureReader();
+    RawCaptureReader(const RawCaptureReader &) = delete;
+    RawCaptureReader &operator=(const RawCaptureReader &) = delete;
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return map_ != nullptr; }
+
+    // 时间戳 0 对应的墙钟时间（微秒）
+    qint64 epochUs() const { return epochUs_; }
+    // 读取下一块，到达文件末尾（或不完整的尾块）时返回 false
+    bool next(Chunk &chunk);
+    // 回到第一块
+    void rewind() { pos_ = RawCaptureFormat::FILE_HEADER_SIZE; truncated_ = false; }
+    bool isTruncated() const { return truncated_; }
+    // 全部块的负载字节数（不含文件头与块头）
+    qint64 payloadBytes() const;
+
+private:
+    QFile file_;
+    const uchar *map_ = nullptr;
+    qint64 size_ = 0;
+    qint64 pos_ = 0;
+    qint64 epochUs_ = 0;
+    bool truncated_ = false;
+};
+
+#endif // RAWCAPTURE_H
@@ -0,0 +1,200 @@
+#include "SerialChunkPool.h"
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QVector>
+#include <QWaitCondition>
+#include <new>
+
+// 块头，数据紧随其后（同一次分配）
+struct SerialChunk::Block {
+    std::atomic<int> refs { 1 };
+    int size = 0;
+    qint64 timestampNs = 0;
+    SerialChunkPool::Shared *owner = nullptr;
+
+    char *payload() { return reinterpret_cast<char *>(this + 1); }
+};
+
+// 池的共享状态：池对象与尚未归还的块共同持有，两者都结束后释放
+struct SerialChunkPool::Shared {
+    QMutex mutex;
+    QVector<SerialChunk::Block *> free; // 预留 maxChunks 容量，归还时不再分配
+    QWaitCondition available;           // 块归还时唤醒 waitAvailable()
+    int chunkBytes = 0;
+    int maxChunks = 0;
+    int allocated = 0;
+    bool poolAlive = true;
+};
+
+SerialChunk &SerialChunk::operator=(const SerialChunk &other)
+{
+    if (block_ != other.block_) {
+        release();
+        block_ = other.block_;
+        retain();
+    }
+    return *this;
+}
+
+SerialChunk &SerialChunk::operator=(SerialChunk &&other) noexcept
+{
+    if (this != &other) {
+        release();
+        block_ = other.block_;
+        other.block_ = nullptr;
+    }
+    return *this;
+}
+
+const char *SerialChunk::constData() const
+{
+    return block_ ? block_->payload() : nullptr;
+}
+
+int SerialChunk::size() const
+{
+    return block_ ? block_->size : 0;
+}
+
+qint64 SerialChunk::timestampNs() const
+{
+    return block_ ? block_->timestampNs : 0;
+}
+
+char *SerialChunk::data()
+{
+    return block_ ? block_->payload() : nullptr;
+}
+
+int SerialChunk::capacity() const
+{
+    return block_ ? block_->owner->chunkBytes : 0;
+}
+
+void SerialChunk::setSize(int size, qint64 timestampNs)
+{
+    block_->size = size;
+    block_->timestampNs = timestampNs;
+}
+
+void SerialChunk::retain()
+{
+    if (block_) {
+        block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SerialChunk::release()
+{
+    if (block_ && block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        SerialChunkPool::recycle(block_);
+    }
+    block_ = nullptr;
+}
+
+SerialChunkPool::SerialChunkPool(int chunkBytes, int maxChunks)
+    : shared_(new Shared)
+{
+    shared_->chunkBytes = chunkBytes > 0 ? chunkBytes : 4096;
+    shared_->maxChunks = maxChunks > 0 ? maxChunks : 1;
+    shared_->free.reserve(shared_->maxChunks);
+}
+
+SerialChunkPool::~SerialChunkPool()
+{
+    bool last = false;
+    {
+        QMutexLocker locker(&shared_->mutex);
+        shared_->poolAlive = false;
+        for (SerialChunk::Block *block : shared_->free) {
+            freeBlock(block);
+        }
+        shared_->allocated -= shared_->free.size();
+        shared_->free.clear();
+        last = shared_->allocated == 0;
+    }
+    if (last) {
+        delete shared_;
+    }
+}
+
+SerialChunk SerialChunkPool::acquire()
+{
+    QMutexLocker locker(&shared_->mutex);
+    if (!shared_->free.isEmpty()) {
+        SerialChunk::Block *block = shared_->free.takeLast();
+        block->refs.store(1, std::memory_order_relaxed);
+        block->size = 0;
+        return SerialChunk(block);
+    }
+    if (shared_->allocated >= shared_->maxChunks) {
+        return SerialChunk();
+    }
+    ++shared_->allocated;
+    return SerialChunk(allocateBlock(shared_, shared_->chunkBytes));
+}
+
+bool SerialChunkPool::waitAvailable(int timeoutMs)
+{
+    QMutexLocker locker(&shared_->mutex);
+    QElapsedTimer timer;
+    timer.start();
+    while (shared_->free.isEmpty() && shared_->allocated >= shared_->maxChunks) {
+        const qint64 remainingMs = timeoutMs - timer.elapsed();
+        if (remainingMs <= 0 || !shared_->available.wait(&shared_->mutex, static_cast<unsigned long>(remainingMs))) {
+            break;
+        }
+    }
+    return !shared_->free.isEmpty() || shared_->allocated < shared_->maxChunks;
+}
+
+void SerialChunkPool::recycle(SerialChunk::Block *block)
+{
+    Shared *shared = block->owner;
+    bool last = false;
+    {
+        QMutexLocker locker(&shared->mutex);
+        if (shared->poolAlive) {
+            shared->free.append(block);
+            shared->available.wakeAll();
+            return;
+        }
+        freeBlock(block);
+        last = --shared->allocated == 0;
+    }
+    if (last) {
+        delete shared;
+    }
+}
+
+int SerialChunkPool::chunkBytes() const
+{
+    return shared_->chunkBytes;
+}
+
+int SerialChunkPool::allocatedChunks() const
+{
+    QMutexLocker locker(&shared_->mutex);
+    return shared_->allocated;
+}
+
+int SerialChunkPool::freeChunks() const
+{
+    QMutexLocker locker(&shared_->mutex);
+    return shared_->free.size();
+}
+
+SerialChunk::Block *SerialChunkPool::allocateBlock(Shared *owner, int chunkBytes)
+{
+    void *memory = ::operator new(sizeof(SerialChunk::Block) + static_cast<size_t>(chunkBytes));
+    SerialChunk::Block *block = new (memory) SerialChunk::Block;
+    block->owner = owner;
+    return block;
+}
+
+void SerialChunkPool::freeBlock(SerialChunk::Block *block)
+{
+    block->~Block();
+    ::operator delete(block);
+}
@@ -0,0 +1,83 @@
+#ifndef SERIALCHUNKPOOL_H
+#define SERIALCHUNKPOOL_H
+
+#include <QMetaType>
+#include <QtGlobal>
+#include <atomic>
+
+class SerialChunkPool;
+
+// SerialChunk: 对池中一个接收块的引用。串口数据直接读入块内，接收者拿到的是引用而不是数据拷贝。
+// 拷贝只增加引用计数；最后一个引用释放时块自动归还到池中复用（任意线程均可释放）。
+// 块内容在交给接收者之后只读。
+class SerialChunk
+{
+public:
+    SerialChunk() = default;
+    SerialChunk(const SerialChunk &other) : block_(other.block_) { retain(); }
+    SerialChunk(SerialChunk &&other) noexcept : block_(other.block_) { other.block_ = nullptr; }
+    SerialChunk &operator=(const SerialChunk &other);
+    SerialChunk &operator=(SerialChunk &&other) noexcept;
+    ~SerialChunk() { release(); }
+
+    bool isNull() const { return block_ == nullptr; }
+    const char *constData() const;
+    int size() const;
+    // 读到该块数据时的时间戳（纳秒，与 SerialCommon 抓取时间戳同一时基）
+    qint64 timestampNs() const;
+    // 释放引用（若为最后一个引用则归还块）
+    void reset() { release(); }
+
+private:
+    friend class SerialChunkPool;
+    friend class SerialCommon;
+    struct Block;
+
+    explicit SerialChunk(Block *block) : block_(block) {}
+    // 生产者（SerialCommon）填充数据
+    char *data();
+    int capacity() const;
+    void setSize(int size, qint64 timestampNs);
+
+    void retain();
+    void release();
+
+    Block *block_ = nullptr;
+};
+Q_DECLARE_METATYPE(SerialChunk)
+
+// SerialChunkPool: 固定大小接收块的池。块按需分配，归还后留在池中复用，稳态下接收路径不再分配堆内存。
+// 在用的块数达到 maxChunks（接收者持有过多块未释放）时 acquire() 返回空引用，由调用方暂停读取，
+// 可用 waitAvailable() 等待块归还。
+// 池可以先于未释放的块销毁，这些块在最后一个引用释放时直接释放内存。
+class SerialChunkPool
+{
+public:
+    explicit SerialChunkPool(int chunkBytes = 4096, int maxChunks = 1024);
+    ~SerialChunkPool();
+    SerialChunkPool(const SerialChunkPool &) = delete;
+    SerialChunkPool &operator=(const SerialChunkPool &) = delete;
+
+    // 取一个空块（size 为 0），池已用尽时返回空引用
+    SerialChunk acquire();
+    // 池已用尽时等待接收者归还块，至多 timeoutMs 毫秒；返回之后能否取到块
+    bool waitAvailable(int timeoutMs);
+
+    int chunkBytes() const;
+    // 已分配的块数（含在用与空闲）与空闲块数
+    int allocatedChunks() const;
+    int freeChunks() const;
+
+private:
+    friend class SerialChunk;
+    struct Shared;
+    // 块的最后一个引用释放时调用
+    static void recycle(SerialChunk::Block *block);
+    // 块头与数据一次分配
+    static SerialChunk::Block *allocateBlock(Shared *owner, int chunkBytes);
+    static void freeBlock(SerialChunk::Block *block);
+
+    Shared *shared_;
+};
+
+#endif // SERIALCHUNKPOOL_H
@@ -1,17 +1,107 @@
 #include "SerialCommon.h"
+#include "RawCapture.h"
+#include "SerialReactor.h"
 #include <QDebug>
+#include <QDateTime>
+#include <QMetaMethod>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/serial.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+// Direct 读线程在接收块池用尽时等待块归还的上限；921600 波特率下内核 tty 缓冲区可容纳数十毫秒的数据
+const int kPoolWaitMs = 20;
+
+// 标准波特率到 termios 速率常量的映射，不支持的返回 0
+speed_t toSpeed(qint32 baudRate)
+{
+    switch (baudRate) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 500000: return B500000;
+    case 576000: return B576000;
+    case 921600: return B921600;
+    case 1000000: return B1000000;
+    case 1152000: return B1152000;
+    case 1500000: return B1500000;
+    case 2000000: return B2000000;
+    case 3000000: return B3000000;
+    case 4000000: return B4000000;
+    default: return 0;
+    }
+}
+}
+#endif
+
+// Direct 模式的读线程：只执行 SerialCommon::directReadLoop()
+class SerialCommon::ReaderThread : public QThread {
+public:
+    explicit ReaderThread(SerialCommon *owner) : owner_(owner) {}
+
+protected:
+    void run() override
+    {
+        owner_->directReadLoop();
+        owner_->readerRunning_ = false; // 设备断开等原因自行退出时 isDirectReading() 随之变为 false
+    }
+
+private:
+    SerialCommon *owner_;
+};
 
 SerialCommon::SerialCommon()
-    : QObject(), serial(new QSerialPort())
+    : QObject(), serial(new QSerialPort()), chunkPool_(new SerialChunkPool()), commandTimer_(new QTimer(this))
 {
+    qRegisterMetaType<SerialChunk>("SerialChunk");
     connect(serial, &QSerialPort::readyRead, this, &SerialCommon::readData);
+    connect(serial, &QSerialPort::bytesWritten, this, &SerialCommon::commandBytesWritten);
+    commandTimer_->setSingleShot(true);
+    connect(commandTimer_, &QTimer::timeout, this, [this]() {
+        expireRequests();
+        armCommandTimer();
+    });
+    captureClock_.start();
 }
 
 SerialCommon::~SerialCommon()
 {
+    closeDirect();
     if (serial->isOpen())
         serial->close();
     delete serial;
+    delete rawCapture_;
+    delete chunkPool_;
+}
+
+bool SerialCommon::setChunkPool(int chunkBytes, int maxChunks) {
+    if (isOpen()) {
+        qDebug() << "Chunk pool can only be changed before the serial port is opened.";
+        return false;
+    }
+    if (chunkBytes <= 0 || maxChunks <= 0) {
+        qDebug() << "Invalid chunk pool size:" << chunkBytes << maxChunks;
+        return false;
+    }
+    // 仍被接收者持有的旧块在释放时自行回收
+    delete chunkPool_;
+    chunkPool_ = new SerialChunkPool(chunkBytes, maxChunks);
+    return true;
 }
 
 
@@ -44,6 +134,9 @@ bool SerialCommon::open(const QString &portName,
           QSerialPort::Parity parity,
           QSerialPort::StopBits stopBits)
 {
+    if (readMode_ == ReadMode::Direct) {
+        return openDirect(portName, baudRate, dataBits, parity, stopBits);
+    }
     serial->setBaudRate(baudRate);
     serial->setDataBits(dataBits);
     serial->setParity(parity);
@@ -61,8 +154,17 @@ bool SerialCommon::open(const QString &portName,
 }
 
 bool SerialCommon::close() {
+    if (directFd_ >= 0) {
+        closeDirect(); // 先停读线程，之后结束抓取不会与其并发
+        stopRawCapture();
+        finishAllCommands(SerialCommandResult::Cancelled);
+        qDebug() << "Serial" << serial->portName() << "port closed";
+        return 1;
+    }
+    stopRawCapture();
     if (serial->isOpen()) {
         serial->close();
+        finishAllCommands(SerialCommandResult::Cancelled);
         qDebug() << "Serial" << serial->portName() << "port closed";
         return 1;
     }
@@ -70,32 +172,623 @@ bool SerialCommon::close() {
 }
 
 bool SerialCommon::isOpen() const {
-    return serial->isOpen();
+    return directFd_ >= 0 || serial->isOpen();
 }
 
 void SerialCommon::readData() {
-    QByteArray data = serial->readAll();
-    // qDebug() << "data" << data;
-    emit dataReceived(data);  // 发出信号，通知有新数据到达
+    // 池用尽时剩余数据留在 QSerialPort 缓冲区，下次 readyRead 时再读
+    receiveChunks([this](char *dst, qint64 max) { return serial->read(dst, max); });
+}
+
+template<typename ReadFn>
+bool SerialCommon::receiveChunks(ReadFn read) {
+    for (;;) {
+        SerialChunk chunk = chunkPool_->acquire();
+        if (chunk.isNull()) {
+            if (!poolExhaustedLogged_) {
+                poolExhaustedLogged_ = true;
+                qDebug() << "Serial chunk pool exhausted (" << chunkPool_->allocatedChunks()
+                         << "chunks held by receivers), reading paused.";
+            }
+            return true;
+        }
+        poolExhaustedLogged_ = false;
+        const qint64 n = read(chunk.data(), chunk.capacity());
+        if (n <= 0) {
+            return false;  // chunk 析构时归还
+        }
+        chunk.setSize(static_cast<int>(n), captureTimestampNs());
+        deliverChunk(chunk);
+        if (n < chunk.capacity()) {
+            return false;
+        }
+    }
+}
+
+void SerialCommon::deliverChunk(const SerialChunk &chunk) {
+    if (rawCapture_) {
+        rawCapture_->write(chunk.timestampNs(), chunk.constData(), chunk.size());
+    }
+    if (pendingRequests_ > 0) {
+        offerResponse(chunk.constData(), chunk.size());
+    }
+    emit chunkReceived(chunk);  // 发出信号，通知有新数据到达
+    static const QMetaMethod legacySignal = QMetaMethod::fromSignal(&SerialCommon::dataReceived);
+    if (isSignalConnected(legacySignal)) {
+        emit dataReceived(QByteArray(chunk.constData(), chunk.size()));
+    }
 }
 
 qint64 SerialCommon::writeData(const QByteArray &data) {
-    if (!serial->isOpen()) {
+    return queueWrite(data) != 0 ? data.size() : -1;
+}
+
+quint64 SerialCommon::queueWrite(const QByteArray &data, SerialCommandCallback done) {
+    return enqueueCommand(data, SerialResponseMatcher(), 0, std::move(done));
+}
+
+quint64 SerialCommon::queueRequest(const QByteArray &data, SerialResponseMatcher match, int timeoutMs,
+                                   SerialCommandCallback done) {
+    if (!match || timeoutMs <= 0) {
+        qDebug() << "Serial request needs a response matcher and a positive timeout.";
+        return 0;
+    }
+    return enqueueCommand(data, std::move(match), timeoutMs, std::move(done));
+}
+
+quint64 SerialCommon::enqueueCommand(const QByteArray &data, SerialResponseMatcher match, int timeoutMs,
+                                     SerialCommandCallback done) {
+    PendingCommand command;
+    command.data = data;
+    command.match = std::move(match);
+    command.timeoutNs = timeoutMs * 1000000LL;
+    command.done = std::move(done);
+    // 持锁检查打开状态并唤醒：closeDirect() 在同一把锁下关闭描述符，唤醒不会写到已关闭（或被复用）的描述符
+    QMutexLocker locker(&commandMutex_);
+    if (!isOpen()) {
         qDebug() << "Serial port is not open for writing.";
-        return -1;
+        return 0;
     }
+    const quint64 id = ++lastCommandId_;
+    command.id = id;
+    commandQueue_.append(std::move(command));
+    // 已有未处理的唤醒时不再重复唤醒，同一轮内排队的命令合并写出
+    if (!flushRequested_) {
+        flushRequested_ = true;
+        wakeCommandFlush();
+    }
+    return id;
+}
+
+void SerialCommon::wakeCommandFlush() {
+#if defined(Q_OS_LINUX)
+    if (directFd_ >= 0) {
+        // 读线程暂停期间写入的计数保留在 eventfd 中，读线程恢复后照常处理
+        const quint64 one = 1;
+        if (::write(wakeFd_, &one, sizeof(one)) < 0) {
+            qDebug() << "Failed to wake serial reader thread:" << std::strerror(errno);
+        }
+        return;
+    }
+#endif
+    QMetaObject::invokeMethod(this, [this]() { flushCommands(); }, Qt::QueuedConnection);
+}
 
-    // Write the data to the serial port
-    qint64 bytesWritten = serial->write(data);
-    if (bytesWritten == -1) {
+void SerialCommon::flushCommands() {
+    QVector<PendingCommand> batch;
+    {
+        QMutexLocker locker(&commandMutex_);
+        flushRequested_ = false;
+        batch.swap(commandQueue_);
+    }
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    // 合并为一次写入
+    int total = 0;
+    for (const PendingCommand &command : batch) {
+        total += command.data.size();
+    }
+    QByteArray bytes;
+    bytes.reserve(total);
+    const qint64 now = captureClock_.nsecsElapsed();
+    for (PendingCommand &command : batch) {
+        bytes.append(command.data);
+        bytesQueued_ += static_cast<quint64>(command.data.size());
+        command.endOffset = bytesQueued_;
+        command.data.clear();
+        if (command.match) {
+            command.deadlineNs = now + command.timeoutNs;
+            ++pendingRequests_;
+        }
+        activeCommands_.append(std::move(command));
+    }
+
+    if (directFd_ >= 0) {
+        directWriteBuffer_.append(bytes);
+        writeDirectPending();
+    } else if (serial->write(bytes) != bytes.size()) {
         qDebug() << "Failed to write data to serial port.";
+        finishAllCommands(SerialCommandResult::Failed);
+        return;
+    } else if (bytes.isEmpty()) {
+        commandBytesWritten(0);
+    }
+    armCommandTimer();
+}
+
+void SerialCommon::writeDirectPending() {
+#if defined(Q_OS_LINUX)
+    // 描述符为非阻塞：写满时保留剩余数据，由读线程等待可写后继续
+    qint64 written = 0;
+    while (written < directWriteBuffer_.size()) {
+        const ssize_t n = ::write(directFd_, directWriteBuffer_.constData() + written,
+                                  static_cast<size_t>(directWriteBuffer_.size() - written));
+        if (n > 0) {
+            written += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN) {
+            break;
+        }
+        qDebug() << "Failed to write data to serial port:" << std::strerror(errno);
+        directWriteBuffer_.clear();
+        finishAllCommands(SerialCommandResult::Failed);
+        return;
+    }
+    directWriteBuffer_.remove(0, static_cast<int>(written));
+    commandBytesWritten(written);
+#endif
+}
+
+void SerialCommon::commandBytesWritten(qint64 bytes) {
+    bytesWritten_ += static_cast<quint64>(bytes);
+    QVector<QPair<SerialCommandCallback, SerialCommandResult>> results;
+    for (int i = 0; i < activeCommands_.size();) {
+        PendingCommand &command = activeCommands_[i];
+        if (command.endOffset > bytesWritten_) {
+            break; // 按写入顺序，后面的命令也尚未写完
+        }
+        command.written = true;
+        if (command.match) {
+            ++i; // 请求继续等待响应
+            continue;
+        }
+        SerialCommandResult result;
+        result.id = command.id;
+        result.status = SerialCommandResult::Written;
+        results.append(qMakePair(std::move(command.done), result));
+        activeCommands_.remove(i);
+    }
+    invokeCallbacks(results);
+}
+
+bool SerialCommon::offerResponse(const char *data, int size) {
+    for (int i = 0; i < activeCommands_.size(); ++i) {
+        PendingCommand &command = activeCommands_[i];
+        if (!command.match || !command.match(data, size)) {
+            continue;
+        }
+        QVector<QPair<SerialCommandCallback, SerialCommandResult>> results;
+        SerialCommandResult result;
+        result.id = command.id;
+        result.status = SerialCommandResult::Responded;
+        result.response = QByteArray(data, size);
+        results.append(qMakePair(std::move(command.done), result));
+        activeCommands_.remove(i);
+        --pendingRequests_;
+        invokeCallbacks(results);
+        return true;
+    }
+    return false;
+}
+
+qint64 SerialCommon::expireRequests() {
+    if (pendingRequests_ == 0) {
         return -1;
     }
+    const qint64 now = captureClock_.nsecsElapsed();
+    qint64 nextDeadline = -1;
+    QVector<QPair<SerialCommandCallback, SerialCommandResult>> results;
+    for (int i = 0; i < activeCommands_.size();) {
+        PendingCommand &command = activeCommands_[i];
+        if (!command.match) {
+            ++i;
+            continue;
+        }
+        if (command.deadlineNs > now) {
+            if (nextDeadline < 0 || command.deadlineNs < nextDeadline) {
+                nextDeadline = command.deadlineNs;
+            }
+            ++i;
+            continue;
+        }
+        SerialCommandResult result;
+        result.id = command.id;
+        result.status = SerialCommandResult::TimedOut;
+        results.append(qMakePair(std::move(command.done), result));
+        activeCommands_.remove(i);
+        --pendingRequests_;
+    }
+    invokeCallbacks(results);
+    return nextDeadline;
+}
+
+void SerialCommon::finishAllCommands(SerialCommandResult::Status status) {
+    QVector<PendingCommand> queued;
+    {
+        QMutexLocker locker(&commandMutex_);
+        queued.swap(commandQueue_);
+        flushRequested_ = false;
+    }
+    QVector<QPair<SerialCommandCallback, SerialCommandResult>> results;
+    for (QVector<PendingCommand> *list : { &activeCommands_, &queued }) {
+        for (PendingCommand &command : *list) {
+            SerialCommandResult result;
+            result.id = command.id;
+            result.status = status;
+            results.append(qMakePair(std::move(command.done), result));
+        }
+        list->clear();
+    }
+    pendingRequests_ = 0;
+    bytesQueued_ = bytesWritten_ = 0;
+    directWriteBuffer_.clear();
+    if (directFd_ < 0) {
+        commandTimer_->stop(); // Direct 模式下可能在读线程中调用，定时器只属于对象线程
+    }
+    invokeCallbacks(results);
+}
 
-    // Ensure all data is sent out before proceeding
-    serial->flush();
+void SerialCommon::invokeCallbacks(QVector<QPair<SerialCommandCallback, SerialCommandResult>> &results) {
+    for (auto &entry : results) {
+        if (entry.first) {
+            entry.first(entry.second);
+        }
+    }
+}
 
-    // qDebug() << "Wrote" << bytesWritten << "bytes to serial port.";
+void SerialCommon::armCommandTimer() {
+    if (directFd_ >= 0) {
+        return; // Direct 模式由读线程的 poll 超时处理
+    }
+    qint64 nextDeadline = -1;
+    for (const PendingCommand &command : activeCommands_) {
+        if (command.match && (nextDeadline < 0 || command.deadlineNs < nextDeadline)) {
+            nextDeadline = command.deadlineNs;
+        }
+    }
+    if (nextDeadline < 0) {
+        commandTimer_->stop();
+        return;
+    }
+    const qint64 remainingNs = nextDeadline - captureClock_.nsecsElapsed();
+    commandTimer_->start(static_cast<int>(std::max<qint64>(0, (remainingNs + 999999) / 1000000)));
+}
 
-    return bytesWritten;
+bool SerialCommon::startRawCapture(const QString &path) {
+    // 读线程运行时暂停它，避免与其并发访问 rawCapture_
+    const bool resume = isDirectReading();
+    if (resume) {
+        stopReader();
+    }
+    stopRawCapture();
+    RawCapture *capture = new RawCapture();
+    // 文件头记录时间戳 0 对应的墙钟时间
+    const qint64 epochUs = QDateTime::currentMSecsSinceEpoch() * 1000 - captureTimestampNs() / 1000;
+    const bool ok = capture->open(path, epochUs);
+    if (ok) {
+        rawCapture_ = capture;
+        qDebug() << "Raw capture started:" << path;
+    } else {
+        delete capture;
+    }
+    if (resume) {
+        startReader();
+    }
+    return ok;
+}
+
+void SerialCommon::stopRawCapture() {
+    if (!rawCapture_) {
+        return;
+    }
+    const bool resume = isDirectReading();
+    if (resume) {
+        stopReader();
+    }
+    rawCapture_->close();
+    qDebug() << "Raw capture stopped:" << rawCapture_->path() << rawCapture_->chunkCount() << "chunks,"
+             << rawCapture_->byteCount() << "bytes";
+    delete rawCapture_;
+    rawCapture_ = nullptr;
+    if (resume) {
+        startReader();
+    }
+}
+
+bool SerialCommon::isRawCapturing() const {
+    return rawCapture_ && rawCapture_->isOpen();
+}
+
+qint64 SerialCommon::captureTimestampNs() const {
+    return captureClock_.nsecsElapsed();
+}
+
+bool SerialCommon::setReadMode(ReadMode mode) {
+#if !defined(Q_OS_LINUX)
+    if (mode == ReadMode::Direct) {
+        qDebug() << "Direct read mode is only supported on Linux.";
+        return false;
+    }
+#endif
+    if (isOpen()) {
+        qDebug() << "Read mode must be set before the port is opened.";
+        return false;
+    }
+    readMode_ = mode;
+    return true;
+}
+
+bool SerialCommon::setReactor(SerialReactor *reactor) {
+#if !defined(Q_OS_LINUX)
+    if (reactor) {
+        qDebug() << "Serial reactor is only supported on Linux.";
+        return false;
+    }
+#endif
+    if (isOpen()) {
+        qDebug() << "Reactor must be set before the port is opened.";
+        return false;
+    }
+    reactor_ = reactor;
+    if (reactor) {
+        readMode_ = ReadMode::Direct;
+    }
+    return true;
+}
+
+bool SerialCommon::openDirect(const QString &portName, qint32 baudRate, QSerialPort::DataBits dataBits,
+                              QSerialPort::Parity parity, QSerialPort::StopBits stopBits) {
+#if defined(Q_OS_LINUX)
+    closeDirect();
+    serial->setPortName(portName);
+    const QString path = portName.startsWith('/') ? portName : QStringLiteral("/dev/") + portName;
+    const speed_t speed = toSpeed(baudRate);
+    if (speed == 0 || stopBits == QSerialPort::OneAndHalfStop) {
+        qDebug() << "Failed to open port" << portName << ", error: unsupported baud rate or stop bits";
+        return false;
+    }
+    const int fd = ::open(path.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        qDebug() << "Failed to open port" << portName << ", error:" << std::strerror(errno);
+        return false;
+    }
+    ::ioctl(fd, TIOCEXCL); // 与 QSerialPort 一样独占设备
+
+    termios tio;
+    if (::tcgetattr(fd, &tio) != 0) {
+        qDebug() << "Failed to open port" << portName << ", error:" << std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    ::cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSIZE | CSTOPB | PARENB | PARODD | CRTSCTS);
+    switch (dataBits) {
+    case QSerialPort::Data5: tio.c_cflag |= CS5; break;
+    case QSerialPort::Data6: tio.c_cflag |= CS6; break;
+    case QSerialPort::Data7: tio.c_cflag |= CS7; break;
+    default: tio.c_cflag |= CS8; break;
+    }
+    if (stopBits == QSerialPort::TwoStop) {
+        tio.c_cflag |= CSTOPB;
+    }
+    if (parity == QSerialPort::EvenParity) {
+        tio.c_cflag |= PARENB;
+    } else if (parity == QSerialPort::OddParity) {
+        tio.c_cflag |= PARENB | PARODD;
+    }
+#ifdef CMSPAR
+    tio.c_cflag &= ~CMSPAR;
+    if (parity == QSerialPort::SpaceParity) {
+        tio.c_cflag |= PARENB | CMSPAR;
+    } else if (parity == QSerialPort::MarkParity) {
+        tio.c_cflag |= PARENB | CMSPAR | PARODD;
+    }
+#endif
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+    // 非规范模式下 poll 在缓冲区达到 VMIN 字节时即唤醒：收到第 1 个字节就返回，不等待字节间定时器
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    ::cfsetispeed(&tio, speed);
+    ::cfsetospeed(&tio, speed);
+    if (::tcsetattr(fd, TCSANOW, &tio) != 0) {
+        qDebug() << "Failed to open port" << portName << ", error:" << std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    ::tcflush(fd, TCIFLUSH);
+
+    // 请求驱动以低延迟方式把数据交给 tty 层（不支持的驱动忽略）
+    serial_struct ss;
+    if (::ioctl(fd, TIOCGSERIAL, &ss) == 0) {
+        ss.flags |= ASYNC_LOW_LATENCY;
+        if (::ioctl(fd, TIOCSSERIAL, &ss) != 0) {
+            qDebug() << "ASYNC_LOW_LATENCY not accepted by" << portName;
+        }
+    }
+
+    const int wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+        qDebug() << "Failed to open port" << portName << ", error:" << std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    {
+        QMutexLocker locker(&commandMutex_);
+        wakeFd_ = wakeFd;
+        directFd_ = fd;
+    }
+    startReader();
+    if (!isDirectReading()) {
+        closeDirect();
+        qDebug() << "Failed to open port" << portName << ", error: reactor unavailable";
+        return false;
+    }
+    qDebug() << "Serial port" << portName << "opened successfully (direct read"
+             << (reactor_ ? "via reactor)." : ").");
+    return true;
+#else
+    Q_UNUSED(portName);
+    Q_UNUSED(baudRate);
+    Q_UNUSED(dataBits);
+    Q_UNUSED(parity);
+    Q_UNUSED(stopBits);
+    return false;
+#endif
+}
+
+void SerialCommon::closeDirect() {
+#if defined(Q_OS_LINUX)
+    stopReader();
+    // 其他线程排队命令时持有同一把锁读取描述符（见 enqueueCommand）
+    QMutexLocker locker(&commandMutex_);
+    if (directFd_ >= 0) {
+        ::close(directFd_);
+        directFd_ = -1;
+    }
+    if (wakeFd_ >= 0) {
+        ::close(wakeFd_);
+        wakeFd_ = -1;
+    }
+#endif
+}
+
+void SerialCommon::startReader() {
+    if (isDirectReading() || directFd_ < 0) {
+        return;
+    }
+    if (reactor_) {
+        // 先置位：加入后反应器线程可能立即因设备断开把它清除
+        reactorAttached_ = true;
+        if (!reactor_->add(this, directFd_, wakeFd_)) {
+            reactorAttached_ = false;
+        }
+        return;
+    }
+    if (readerThread_) {
+        stopReader(); // 上一个读线程已自行退出，先回收
+    }
+    stopReading_ = false;
+    readerRunning_ = true;
+    readerThread_ = new ReaderThread(this);
+    readerThread_->start(QThread::TimeCriticalPriority);
+}
+
+void SerialCommon::stopReader() {
+    if (reactorAttached_) {
+        reactor_->remove(this);
+        reactorAttached_ = false;
+        return;
+    }
+    if (!readerThread_) {
+        return;
+    }
+    stopReading_ = true;
+#if defined(Q_OS_LINUX)
+    const quint64 one = 1;
+    if (::write(wakeFd_, &one, sizeof(one)) < 0) {
+        qDebug() << "Failed to wake serial reader thread:" << std::strerror(errno);
+    }
+#endif
+    readerThread_->wait();
+    delete readerThread_;
+    readerThread_ = nullptr;
+}
+
+int SerialCommon::directPollTimeoutMs() {
+    // 取派生类的空闲超时与最近的请求截止时间中较小者
+    const int idleMs = directIdleTimeoutMs();
+    const qint64 deadline = expireRequests();
+    if (deadline < 0) {
+        return idleMs;
+    }
+    const qint64 remainingNs = deadline - captureClock_.nsecsElapsed();
+    const int requestMs = static_cast<int>(std::max<qint64>(0, (remainingNs + 999999) / 1000000));
+    return idleMs < 0 ? requestMs : std::min(idleMs, requestMs);
+}
+
+void SerialCommon::directReadLoop() {
+#if defined(Q_OS_LINUX)
+    pollfd fds[2] = { { directFd_, POLLIN, 0 }, { wakeFd_, POLLIN, 0 } };
+    // 暂停期间排队的命令
+    flushCommands();
+    for (;;) {
+        // 有未写完的命令数据时同时等待可写
+        fds[0].events = directWriteBuffer_.isEmpty() ? POLLIN : (POLLIN | POLLOUT);
+        const int ready = ::poll(fds, 2, directPollTimeoutMs());
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            qDebug() << "Serial reader poll failed:" << std::strerror(errno);
+            finishAllCommands(SerialCommandResult::Failed);
+            return;
+        }
+        if (ready == 0) {
+            directIdle();
+            continue;
+        }
+        if (fds[1].revents & POLLIN) {
+            quint64 value = 0;
+            while (::read(wakeFd_, &value, sizeof(value)) > 0) {
+            }
+            if (stopReading_) {
+                return; // stopReader() 请求退出
+            }
+            flushCommands();
+        }
+        if (fds[0].revents & POLLIN) {
+            directReadReady(directFd_);
+        }
+        if ((fds[0].revents & POLLOUT) && !directWriteBuffer_.isEmpty()) {
+            writeDirectPending();
+        }
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            qDebug() << "Serial port" << serial->portName() << "disconnected or failed, reader thread stopped.";
+            finishAllCommands(SerialCommandResult::Failed);
+            return;
+        }
+    }
+#endif
+}
+
+void SerialCommon::directReadReady(int fd) {
+#if defined(Q_OS_LINUX)
+    // 读出当前全部可读数据
+    const bool exhausted = receiveChunks([fd](char *dst, qint64 max) -> qint64 {
+        return ::read(fd, dst, static_cast<size_t>(max));
+    });
+    // 数据仍在内核缓冲区，poll 会立即再次返回。读线程等待接收者归还块（归还即唤醒）；
+    // 反应器不能为一个串口阻塞其他串口。仍无可用块时丢弃内核中的数据并计入溢出，避免空转
+    if (exhausted && (reactorAttached_ || !chunkPool_->waitAvailable(kPoolWaitMs))) {
+        char scratch[4096];
+        qint64 dropped = 0;
+        qint64 n = 0;
+        while ((n = ::read(fd, scratch, sizeof(scratch))) > 0) {
+            dropped += n;
+        }
+        // 只在第一次溢出时提示，之后由 overrunBytes() 统计
+        if (dropped > 0 && overrunBytes_.fetch_add(static_cast<quint64>(dropped), std::memory_order_relaxed) == 0) {
+            qDebug() << "Serial chunk pool exhausted, dropping received data (see overrunBytes()).";
+        }
+    }
+#else
+    Q_UNUSED(fd);
+#endif
 }
@@ -19,12 +19,48 @@
 #include <QSerialPortInfo>
 #include <QIODevice>
 #include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QPair>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include "SerialChunkPool.h"
+
+class RawCapture;
+class SerialReactor;
+class QThread;
+class QTimer;
+
+// 异步命令的完成结果
+struct SerialCommandResult {
+    enum Status {
+        Written,    // 普通写入：数据已全部交给系统
+        Responded,  // 请求：收到匹配的响应
+        TimedOut,   // 请求：超时未收到响应
+        Failed,     // 写入出错
+        Cancelled   // 串口关闭时仍未完成
+    };
+    quint64 id = 0;
+    Status status = Failed;
+    QByteArray response;  // Responded 时为匹配到的那段数据
+};
+// 完成回调，在串口的 I/O 线程中调用（事件循环模式为对象所在线程，Direct 模式为读线程）
+using SerialCommandCallback = std::function<void(const SerialCommandResult &)>;
+// 响应匹配：判断收到的一段数据是否为该请求的响应
+using SerialResponseMatcher = std::function<bool(const char *data, int size)>;
 
 class SerialCommon : public QObject {
 
     Q_OBJECT
 
 public:
+    // 读取方式
+    enum class ReadMode {
+        EventLoop,  // 默认：QSerialPort::readyRead 触发 readData()，在所属线程的事件循环中处理
+        Direct      // 仅 Linux：专用读线程自行打开设备，poll 等待后直接读取并在该线程中处理（directReadReady），不经过事件循环
+    };
+
     explicit SerialCommon();
     virtual ~SerialCommon();
     bool setBaudRate(qint32 baudRate);
@@ -39,16 +75,140 @@ public:
               QSerialPort::StopBits stopBits = QSerialPort::OneStop);
     bool close();
     bool isOpen() const;
+    // 非阻塞写入：数据进入命令队列后立即返回（返回 data.size()，未打开返回 -1），不等待发送完成
     qint64 writeData(const QByteArray &data);
 
+    // 异步命令队列，可在任意线程调用。排队的命令由 I/O 线程合并为一次写入发出，不阻塞数据接收。
+    // queueWrite：写入完成（或失败）时回调；返回命令 id，未打开时返回 0。
+    quint64 queueWrite(const QByteArray &data, SerialCommandCallback done = SerialCommandCallback());
+    // queueRequest：写入后等待 match 认可的响应，收到响应、超时（timeoutMs）或失败时回调一次。
+    // 基类把收到的每个接收块交给匹配函数，派生类可改为交给它解析出的非数据消息（见 offerResponse）。
+    quint64 queueRequest(const QByteArray &data, SerialResponseMatcher match, int timeoutMs,
+                         SerialCommandCallback done);
+
+    // 设置读取方式，在 open() 之前调用；非 Linux 平台不支持 Direct，返回 false。
+    // Direct 模式下串口参数在 open() 时一次设定（原始模式，VMIN=1/VTIME=0，并尽量开启 ASYNC_LOW_LATENCY），
+    // 之后的 setBaudRate 等设置不生效；数据在读线程中处理，派生类的解析状态须只在该线程中访问。
+    bool setReadMode(ReadMode mode);
+    ReadMode readMode() const { return readMode_; }
+    // 交给反应器（SerialReactor，须已 start）服务，在 open() 之前调用，同时设为 Direct 模式；
+    // 多个串口共用反应器的一个线程，不再各自创建读线程。传 nullptr 恢复为自己的读线程。
+    bool setReactor(SerialReactor *reactor);
+
+    // 原始字节流抓取：把此后每次从串口读到的数据块连同时间戳写入 path（格式见 RawCapture.h），
+    // 用于排查解析问题或离线重新处理。切换时先暂停读取：反应器模式下从反应器移除再加入，可在任意线程
+    // （包括反应器回调中）调用；直读模式下等待读线程退出，不能在读线程的回调中调用；事件循环模式下
+    // 须在串口所属的线程中调用。close() 时自动结束抓取。
+    bool startRawCapture(const QString &path);
+    void stopRawCapture();
+    bool isRawCapturing() const;
+
+    // 接收块池（统计在用/空闲块数），块大小与上限在 open() 之前由 setChunkPool() 设定
+    const SerialChunkPool &chunkPool() const { return *chunkPool_; }
+    bool setChunkPool(int chunkBytes, int maxChunks);
+    // Direct 模式下接收块池用尽（接收者未及时释放块）而丢弃的累计字节数
+    quint64 overrunBytes() const { return overrunBytes_.load(std::memory_order_relaxed); }
+
 signals:
+    // 串口数据直接读入池中的块，接收者持有 chunk 的拷贝（只增加引用计数）即可延后处理，释放后块归还池。
+    // 同线程（直接连接）接收时整个接收路径不分配堆内存；跨线程的队列连接由 Qt 为每次投递分配一个事件。
+    void chunkReceived(const SerialChunk &chunk);
+    // 兼容旧接口：仅在有接收者连接时才拷贝出 QByteArray 发出
     void dataReceived(const QByteArray data);
 
 protected slots:
     virtual void readData();
 
 protected:
+    // Direct 模式：设备可读时在读线程中调用。默认实现把全部可读数据读入池中的块，抓取后逐块发出 chunkReceived
+    virtual void directReadReady(int fd);
+    // Direct 模式：读线程 poll 的超时（毫秒，-1 为一直等待），超时后调用 directIdle()
+    virtual int directIdleTimeoutMs() const { return -1; }
+    virtual void directIdle() {}
+    // Direct 模式的读线程是否在运行（或已加入反应器）
+    bool isDirectReading() const { return readerRunning_ || reactorAttached_; }
+
+    // 是否有等待响应的请求（I/O 线程中调用）
+    bool hasPendingRequests() const { return pendingRequests_ > 0; }
+    // 把收到的一段数据交给等待中的请求依次匹配，匹配成功的请求完成并返回 true（I/O 线程中调用）
+    bool offerResponse(const char *data, int size);
+
+    // 抓取数据块的时间戳（纳秒，单调时钟）。派生类可改用自己的时基，使抓取时间与样本时间戳一致
+    virtual qint64 captureTimestampNs() const;
+
     QSerialPort *serial; ///< 管理串口连接的QSerialPort实例指针。
+    RawCapture *rawCapture_ = nullptr; ///< 原始字节流抓取，未抓取时为空。
+    QElapsedTimer captureClock_;       ///< 默认的抓取时间戳时基。
+
+private:
+    friend class SerialReactor;
+    class ReaderThread;
+
+    // 队列中的命令
+    struct PendingCommand {
+        quint64 id = 0;
+        QByteArray data;
+        SerialResponseMatcher match;   // 为空表示普通写入
+        qint64 timeoutNs = 0;
+        qint64 deadlineNs = 0;         // 写出时确定
+        quint64 endOffset = 0;         // 写入流中该命令最后一个字节之后的位置
+        bool written = false;
+        SerialCommandCallback done;
+    };
+
+    quint64 enqueueCommand(const QByteArray &data, SerialResponseMatcher match, int timeoutMs,
+                           SerialCommandCallback done);
+    // 唤醒 I/O 线程处理命令队列（调用方持有 commandMutex_）
+    void wakeCommandFlush();
+    // I/O 线程：把排队的命令合并为一次写入
+    void flushCommands();
+    // I/O 线程：累计已写出 bytes 字节，完成已写完的普通写入
+    void commandBytesWritten(qint64 bytes);
+    // I/O 线程：让超时的请求完成，返回最近的截止时间（纳秒，无请求时为 -1）
+    qint64 expireRequests();
+    // I/O 线程：以 status 结束全部未完成的命令（含尚未写出的）
+    void finishAllCommands(SerialCommandResult::Status status);
+    // 依次调用回调（不持有任何锁，回调中可再次排队命令）
+    static void invokeCallbacks(QVector<QPair<SerialCommandCallback, SerialCommandResult>> &results);
+    void armCommandTimer();
+    void writeDirectPending();
+
+    bool openDirect(const QString &portName, qint32 baudRate, QSerialPort::DataBits dataBits,
+                    QSerialPort::Parity parity, QSerialPort::StopBits stopBits);
+    void closeDirect();
+    // 启停读线程或加入/退出反应器（抓取文件切换时也会暂停读取，避免与其并发访问 rawCapture_）
+    void startReader();
+    void stopReader();
+    void directReadLoop();
+    int directPollTimeoutMs();
+    // 循环取块并用 read(dst, max) 读入，直到读空或池用尽；返回池是否用尽
+    template<typename ReadFn>
+    bool receiveChunks(ReadFn read);
+    void deliverChunk(const SerialChunk &chunk);
+
+    ReadMode readMode_ = ReadMode::EventLoop;
+    int directFd_ = -1;                   ///< Direct 模式自行打开的设备描述符（打开/关闭时持有 commandMutex_）。
+    int wakeFd_ = -1;                     ///< 唤醒读线程退出的 eventfd（同上）。
+    QThread *readerThread_ = nullptr;     ///< 自行退出后仍保留，由 stopReader() 回收。
+    std::atomic<bool> readerRunning_ { false }; ///< 读线程在运行，设备断开或出错退出时清除。
+    SerialReactor *reactor_ = nullptr;    ///< 非空时由反应器代替读线程。
+    std::atomic<bool> reactorAttached_ { false }; ///< 已加入反应器，设备断开或出错被移出时由反应器线程清除。
+    SerialChunkPool *chunkPool_;          ///< 接收块池。
+    bool poolExhaustedLogged_ = false;    ///< 池用尽的提示只输出一次，直到恢复。
+    std::atomic<quint64> overrunBytes_ { 0 }; ///< 池用尽时丢弃的字节数。
+    std::atomic<bool> stopReading_ { false }; ///< 读线程退出请求（wakeFd_ 同时用于唤醒命令写入）。
+
+    QMutex commandMutex_;                 ///< 保护 commandQueue_、flushRequested_、lastCommandId_，以及其他线程对 directFd_/wakeFd_ 的使用。
+    QVector<PendingCommand> commandQueue_;  ///< 尚未交给 I/O 线程的命令。
+    bool flushRequested_ = false;
+    quint64 lastCommandId_ = 0;
+    // 以下仅在 I/O 线程中访问
+    QVector<PendingCommand> activeCommands_; ///< 已写出（或正在写出）但未完成的命令，按写入顺序。
+    int pendingRequests_ = 0;
+    quint64 bytesQueued_ = 0;             ///< 交给写入的累计字节数。
+    quint64 bytesWritten_ = 0;            ///< 已写出的累计字节数。
+    QByteArray directWriteBuffer_;        ///< Direct 模式下尚未写入内核的字节。
+    QTimer *commandTimer_;                ///< 事件循环模式下的请求超时定时器。
 };
 
 #endif // SERIALCOMMON_H
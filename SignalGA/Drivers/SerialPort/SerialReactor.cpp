@@ -0,0 +1,299 @@
+#include "SerialReactor.h"
+#include "SerialCommon.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+namespace {
+const int kMaxEvents = 64; // 单次 epoll_wait 取回的最大事件数
+}
+
+// 反应器线程：只执行 SerialReactor::run()
+class SerialReactor::Thread : public QThread {
+public:
+    explicit Thread(SerialReactor *owner) : owner_(owner) {}
+
+protected:
+    void run() override { owner_->run(); }
+
+private:
+    SerialReactor *owner_;
+};
+
+SerialReactor::SerialReactor()
+{
+    clock_.start();
+}
+
+SerialReactor::~SerialReactor()
+{
+    stop();
+}
+
+bool SerialReactor::start()
+{
+#if defined(Q_OS_LINUX)
+    if (thread_) {
+        return true;
+    }
+    epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    stopFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = &stopHandle_;
+    if (epollFd_ < 0 || stopFd_ < 0 || ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, stopFd_, &ev) != 0) {
+        qDebug() << "Failed to start serial reactor:" << std::strerror(errno);
+        stop();
+        return false;
+    }
+    thread_ = new Thread(this);
+    thread_->start(QThread::TimeCriticalPriority);
+    return true;
+#else
+    qDebug() << "Serial reactor is only supported on Linux.";
+    return false;
+#endif
+}
+
+void SerialReactor::stop()
+{
+#if defined(Q_OS_LINUX)
+    if (thread_) {
+        const quint64 one = 1;
+        if (::write(stopFd_, &one, sizeof(one)) < 0) {
+            qDebug() << "Failed to wake serial reactor:" << std::strerror(errno);
+        }
+        thread_->wait();
+        delete thread_;
+        thread_ = nullptr;
+    }
+    if (portCount() > 0) {
+        qDebug() << "Serial reactor stopped with" << portCount() << "ports still attached.";
+    }
+    if (epollFd_ >= 0) {
+        ::close(epollFd_);
+        epollFd_ = -1;
+    }
+    if (stopFd_ >= 0) {
+        ::close(stopFd_);
+        stopFd_ = -1;
+    }
+#endif
+}
+
+int SerialReactor::portCount() const
+{
+    QMutexLocker locker(&mutex_);
+    return ports_.size();
+}
+
+bool SerialReactor::add(SerialCommon *owner, int fd, int wakeFd)
+{
+#if defined(Q_OS_LINUX)
+    if (!thread_) {
+        qDebug() << "Serial reactor is not running.";
+        return false;
+    }
+    Port *port = new Port;
+    port->owner = owner;
+    port->fd = fd;
+    port->wakeFd = wakeFd;
+    port->device.port = port;
+    port->wake.port = port;
+    port->nextTickNs = 0; // 加入后先计算一次空闲超时
+
+    // 在反应器线程中（例如回调里切换原始抓取，先移除再加入）时本线程已持有锁
+    const bool inReactor = QThread::currentThread() == thread_;
+    if (!inReactor) {
+        mutex_.lock();
+    }
+    epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = &port->device;
+    epoll_event wakeEv {};
+    wakeEv.events = EPOLLIN;
+    wakeEv.data.ptr = &port->wake;
+    const bool ok = ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) == 0
+                    && ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd, &wakeEv) == 0;
+    if (ok) {
+        ports_.append(port);
+        // 唤醒一次，处理加入前（或暂停期间）排队的命令
+        const quint64 one = 1;
+        if (::write(wakeFd, &one, sizeof(one)) < 0) {
+            qDebug() << "Failed to wake serial reactor:" << std::strerror(errno);
+        }
+    } else {
+        qDebug() << "Failed to add serial port to reactor:" << std::strerror(errno);
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+        delete port;
+    }
+    if (!inReactor) {
+        mutex_.unlock();
+    }
+    return ok;
+#else
+    Q_UNUSED(owner);
+    Q_UNUSED(fd);
+    Q_UNUSED(wakeFd);
+    return false;
+#endif
+}
+
+void SerialReactor::remove(SerialCommon *owner)
+{
+#if defined(Q_OS_LINUX)
+    // 在反应器线程中（例如回调里关闭串口）时本线程已持有锁
+    const bool inReactor = QThread::currentThread() == thread_;
+    if (!inReactor) {
+        mutex_.lock();
+    }
+    for (int i = 0; i < ports_.size(); ++i) {
+        Port *port = ports_.at(i);
+        if (port->owner != owner) {
+            continue;
+        }
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, port->fd, nullptr);
+        ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, port->wakeFd, nullptr);
+        ports_.remove(i);
+        delete port;
+        break;
+    }
+    if (!inReactor) {
+        mutex_.unlock();
+    }
+#else
+    Q_UNUSED(owner);
+#endif
+}
+
+void SerialReactor::run()
+{
+#if defined(Q_OS_LINUX)
+    epoll_event events[kMaxEvents];
+    for (;;) {
+        int timeoutMs = -1;
+        {
+            QMutexLocker locker(&mutex_);
+            timeoutMs = waitTimeoutMs(clock_.nsecsElapsed());
+        }
+        const int n = ::epoll_wait(epollFd_, events, kMaxEvents, timeoutMs);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            qDebug() << "Serial reactor epoll_wait failed:" << std::strerror(errno);
+            return;
+        }
+
+        QMutexLocker locker(&mutex_);
+        const qint64 now = clock_.nsecsElapsed();
+        for (int i = 0; i < n; ++i) {
+            const Handle *handle = static_cast<const Handle *>(events[i].data.ptr);
+            if (handle == &stopHandle_) {
+                return; // stop() 请求退出
+            }
+            // 同一批事件中先处理的回调可能已移除后面的串口，只比较指针、不解引用
+            Port *port = nullptr;
+            for (Port *candidate : ports_) {
+                if (handle == &candidate->device || handle == &candidate->wake) {
+                    port = candidate;
+                    break;
+                }
+            }
+            if (port) {
+                service(port, handle, events[i].events, now);
+            }
+        }
+        // 到期的空闲处理（批量投递时间上界、请求超时）
+        for (int i = 0; i < ports_.size(); ++i) {
+            Port *port = ports_.at(i);
+            if (port->nextTickNs >= 0 && port->nextTickNs <= now) {
+                port->owner->directIdle();
+                if (i < ports_.size() && ports_.at(i) == port) {
+                    updatePort(port, now);
+                }
+            }
+        }
+    }
+#endif
+}
+
+void SerialReactor::service(Port *port, const Handle *handle, quint32 events, qint64 now)
+{
+#if defined(Q_OS_LINUX)
+    SerialCommon *owner = port->owner;
+    if (handle->wake) {
+        quint64 value = 0;
+        while (::read(port->wakeFd, &value, sizeof(value)) > 0) {
+        }
+        owner->flushCommands();
+    } else {
+        if (events & EPOLLIN) {
+            owner->directReadReady(port->fd);
+        }
+        if ((events & EPOLLOUT) && !owner->directWriteBuffer_.isEmpty()) {
+            owner->writeDirectPending();
+        }
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            qDebug() << "Serial port" << owner->serial->portName() << "disconnected or failed, removed from reactor.";
+            // 与读线程出错退出相同：先移出反应器（isDirectReading() 随之变为 false），再以失败结束未完成的命令
+            owner->reactorAttached_ = false;
+            remove(owner);
+            owner->finishAllCommands(SerialCommandResult::Failed);
+            return;
+        }
+    }
+    // 回调中可能已移除该串口
+    if (ports_.contains(port)) {
+        updatePort(port, now);
+    }
+#else
+    Q_UNUSED(port);
+    Q_UNUSED(handle);
+    Q_UNUSED(events);
+    Q_UNUSED(now);
+#endif
+}
+
+void SerialReactor::updatePort(Port *port, qint64 now)
+{
+#if defined(Q_OS_LINUX)
+    // 有未写完的命令数据时关注可写
+    const bool wantWrite = !port->owner->directWriteBuffer_.isEmpty();
+    if (wantWrite != port->wantWrite) {
+        epoll_event ev {};
+        ev.events = wantWrite ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        ev.data.ptr = &port->device;
+        ::epoll_ctl(epollFd_, EPOLL_CTL_MOD, port->fd, &ev);
+        port->wantWrite = wantWrite;
+    }
+    const int timeoutMs = port->owner->directPollTimeoutMs();
+    port->nextTickNs = timeoutMs < 0 ? -1 : now + timeoutMs * 1000000LL;
+#else
+    Q_UNUSED(port);
+    Q_UNUSED(now);
+#endif
+}
+
+int SerialReactor::waitTimeoutMs(qint64 now) const
+{
+    qint64 nearest = -1;
+    for (const Port *port : ports_) {
+        if (port->nextTickNs >= 0 && (nearest < 0 || port->nextTickNs < nearest)) {
+            nearest = port->nextTickNs;
+        }
+    }
+    if (nearest < 0) {
+        return -1;
+    }
+    return static_cast<int>(std::max<qint64>(0, (nearest - now + 999999) / 1000000));
+}
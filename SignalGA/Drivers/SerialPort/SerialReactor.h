@@ -0,0 +1,69 @@
+#ifndef SERIALREACTOR_H
+#define SERIALREACTOR_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QVector>
+
+class SerialCommon;
+class QThread;
+
+// SerialReactor: 用一个线程和一个 epoll 服务多个 Direct 模式串口（仅 Linux）。
+// 串口通过 SerialCommon::setReactor() 加入后不再创建自己的读线程，只占用设备描述符和一个 eventfd；
+// 线程数固定为 1，与串口数量无关。串口数量多到单线程处理不过来时，可创建多个反应器分摊。
+// 各串口的数据解析、命令写入、请求超时与空闲处理（directIdle）都在反应器线程中执行，
+// 派生类的解析状态须只在该线程中访问（与 Direct 模式的读线程相同）。
+class SerialReactor
+{
+public:
+    SerialReactor();
+    ~SerialReactor();
+    SerialReactor(const SerialReactor &) = delete;
+    SerialReactor &operator=(const SerialReactor &) = delete;
+
+    // 创建 epoll 并启动反应器线程；须在串口 open() 之前调用
+    bool start();
+    // 结束反应器线程；应先关闭已加入的串口
+    void stop();
+    bool isRunning() const { return thread_ != nullptr; }
+    // 当前服务的串口数
+    int portCount() const;
+
+private:
+    friend class SerialCommon;
+    class Thread;
+    struct Port;
+    // epoll 事件携带的标识：设备可读写、命令唤醒或反应器退出
+    struct Handle {
+        Port *port;
+        bool wake;
+    };
+    struct Port {
+        SerialCommon *owner = nullptr;
+        int fd = -1;
+        int wakeFd = -1;
+        Handle device { nullptr, false };
+        Handle wake { nullptr, true };
+        bool wantWrite = false;   // 已注册 EPOLLOUT
+        qint64 nextTickNs = 0;    // 下次调用 directIdle 的时间，-1 为不需要
+    };
+
+    // 由 SerialCommon 在打开/关闭（以及抓取切换暂停读取）时调用；可在任意线程调用，包括反应器线程中的回调
+    bool add(SerialCommon *owner, int fd, int wakeFd);
+    void remove(SerialCommon *owner);
+    void run();
+    void service(Port *port, const Handle *handle, quint32 events, qint64 now);
+    void updatePort(Port *port, qint64 now);
+    int waitTimeoutMs(qint64 now) const;
+
+    int epollFd_ = -1;
+    int stopFd_ = -1;
+    Handle stopHandle_ { nullptr, false };
+    QThread *thread_ = nullptr;
+    QElapsedTimer clock_;
+    // 保护 ports_；反应器线程在处理一批事件期间持有，remove() 返回后不会再回调该串口
+    mutable QMutex mutex_;
+    QVector<Port *> ports_;
+};
+
+#endif // SERIALREACTOR_H
@@ -0,0 +1,195 @@
+#ifndef GLOBAL_SPSCRING_H
+#define GLOBAL_SPSCRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+namespace TCM {
+
+// 缓存行大小（用于隔离生产者/消费者各自频繁写入的字段，避免伪共享）
+constexpr std::size_t kCacheLineSize = 64;
+
+// 缓冲区满时的处理策略
+enum class RingOverflowPolicy {
+    Block,      // 生产者等待消费者腾出空间
+    DropOldest  // 丢弃最旧的一条记录并计数
+};
+
+// 有界、无锁的单生产者/单消费者环形缓冲区，元素为定长记录（需可平凡拷贝）。
+// - 生产者线程只调用 push/pushBatch；消费者线程只调用 popBatch。
+// - 满时的处理由 OverflowPolicy 决定：
+//     Block      生产者等待消费者腾出空间（自旋 -> 让出 -> 短暂休眠）；close() 后不再等待，改为丢弃。
+//     DropOldest 生产者丢弃最旧的一条记录并计数，永不阻塞。
+// - 丢弃计数、写入计数均可在任意线程读取。
+//
+// 丢弃的实现：生产者通过 CAS 推进读游标来丢弃最旧记录；消费者先拷贝记录再以 CAS 提交读游标，
+// 提交失败说明期间有记录被生产者丢弃（其槽位可能已被覆盖），此时丢弃本次拷贝重新读取。
+// 被丢弃的槽位可能在消费者拷贝的同时被生产者改写，因此槽位按 8 字节字存放、逐字以 relaxed 原子操作读写
+// （x86/ARM 上即普通的读写指令），并发访问不构成数据竞争；读到的混合内容由上面的 CAS 失败丢弃。
+template <typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing 仅支持可平凡拷贝的定长记录");
+
+public:
+    using OverflowPolicy = RingOverflowPolicy;
+
+    // capacity 会向上取整为 2 的幂（至少 2）
+    explicit SpscRing(std::size_t capacity, OverflowPolicy policy = OverflowPolicy::DropOldest)
+        : m_policy(policy) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        m_capacity = cap;
+        m_mask = cap - 1;
+        m_words.reset(new std::atomic<std::uint64_t>[cap * kSlotWords]);
+        for (std::size_t i = 0; i < cap * kSlotWords; ++i) {
+            m_words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const noexcept { return m_capacity; }
+    OverflowPolicy policy() const noexcept { return m_policy; }
+
+    // 当前可读记录数（近似值，仅用于监控）
+    // 先读读游标再读写游标：两者都单调递增，先取的读游标不会超过后取的写游标，差值不会回绕
+    std::size_t size() const noexcept {
+        const std::uint64_t r = m_head.load(std::memory_order_acquire);
+        const std::uint64_t w = m_tail.load(std::memory_order_acquire);
+        return static_cast<std::size_t>(std::min<std::uint64_t>(w - r, m_capacity));
+    }
+
+    std::uint64_t pushedCount() const noexcept { return m_pushed.load(std::memory_order_relaxed); }
+    std::uint64_t droppedCount() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+
+    // 关闭后 Block 策略的生产者不再等待（满时丢弃最旧记录），用于停止流程避免死等
+    void close() noexcept { m_closed.store(true, std::memory_order_release); }
+    void reopen() noexcept { m_closed.store(false, std::memory_order_release); }
+
+    // 生产者：写入一条记录。返回 false 表示写入前丢弃了一条最旧记录。
+    bool push(const T& value) {
+        const std::uint64_t w = m_tail.load(std::memory_order_relaxed);
+        bool noDrop = true;
+        if (w - m_cachedHead >= m_capacity) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (w - m_cachedHead >= m_capacity) {
+                noDrop = makeRoom(w);
+            }
+        }
+        storeSlot(static_cast<std::size_t>(w & m_mask), value);
+        m_tail.store(w + 1, std::memory_order_release);
+        m_pushed.store(m_pushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return noDrop;
+    }
+
+    // 生产者：批量写入 n 条记录，返回其间被丢弃的旧记录数
+    std::size_t pushBatch(const T* values, std::size_t n) {
+        std::size_t drops = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!push(values[i])) ++drops;
+        }
+        return drops;
+    }
+
+    // 消费者：最多读出 maxCount 条记录到 out，返回实际条数
+    std::size_t popBatch(T* out, std::size_t maxCount) {
+        for (;;) {
+            std::uint64_t r = m_head.load(std::memory_order_acquire);
+            const std::uint64_t w = m_tail.load(std::memory_order_acquire);
+            std::size_t n = static_cast<std::size_t>(w - r);
+            if (n > maxCount) n = maxCount;
+            if (n == 0) return 0;
+
+            // 逐条拷贝（处理环绕）
+            for (std::size_t i = 0; i < n; ++i) {
+                loadSlot(static_cast<std::size_t>((r + i) & m_mask), out[i]);
+            }
+
+            if (m_head.compare_exchange_strong(r, r + n, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return n;
+            }
+            // 拷贝期间生产者丢弃了最旧记录，重新读取
+        }
+    }
+
+private:
+    // 每个槽位占用的 8 字节字数
+    static constexpr std::size_t kSlotWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    void storeSlot(std::size_t index, const T& value) noexcept {
+        std::uint64_t words[kSlotWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+        std::atomic<std::uint64_t>* slot = m_words.get() + index * kSlotWords;
+        for (std::size_t i = 0; i < kSlotWords; ++i) {
+            slot[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    void loadSlot(std::size_t index, T& out) const noexcept {
+        std::uint64_t words[kSlotWords];
+        const std::atomic<std::uint64_t>* slot = m_words.get() + index * kSlotWords;
+        for (std::size_t i = 0; i < kSlotWords; ++i) {
+            words[i] = slot[i].load(std::memory_order_relaxed);
+        }
+        std::memcpy(&out, words, sizeof(T));
+    }
+
+    // 生产者在缓冲区满时调用；返回 false 表示丢弃了一条最旧记录
+    bool makeRoom(std::uint64_t w) {
+        if (m_policy == OverflowPolicy::Block) {
+            int spins = 0;
+            while (!m_closed.load(std::memory_order_acquire)) {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (w - m_cachedHead < m_capacity) return true;
+                if (++spins < 64) {
+                    // 忙等
+                } else if (spins < 256) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+            // 已关闭：退化为丢弃最旧记录
+        }
+
+        std::uint64_t h = m_cachedHead;
+        while (w - h >= m_capacity) {
+            if (m_head.compare_exchange_weak(h, h + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                m_cachedHead = h + 1;
+                m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+            // CAS 失败时 h 已更新为最新读游标：若消费者已腾出空间则无需丢弃
+        }
+        m_cachedHead = h;
+        return true;
+    }
+
+    // 只读配置
+    OverflowPolicy m_policy;
+    std::size_t m_capacity { 0 };
+    std::uint64_t m_mask { 0 };
+    std::unique_ptr<std::atomic<std::uint64_t>[]> m_words; // 槽位存储，每条记录 kSlotWords 个字
+
+    // 消费者写入的读游标
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> m_head { 0 };
+    // 生产者写入的写游标、读游标缓存与计数
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> m_tail { 0 };
+    std::uint64_t m_cachedHead { 0 };
+    std::atomic<std::uint64_t> m_pushed { 0 };
+    std::atomic<std::uint64_t> m_dropped { 0 };
+    // 跨线程控制标志
+    alignas(kCacheLineSize) std::atomic<bool> m_closed { false };
+};
+
+} // namespace TCM
+
+#endif // GLOBAL_SPSCRING_H
@@ -8,6 +8,10 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Global
+INCLUDEPATH += Global
+HEADERS += Global/SpscRing.h
+
 # UI
 SOURCES += \
     src/main.cpp \
@@ -25,8 +29,27 @@ SOURCES += Data/AcquisitionTask/TaskThreadManager.cpp
 HEADERS += Data/AcquisitionTask/TaskThreadManager.h
 # Data/DataSaver
 INCLUDEPATH += Data/DataSaver
-SOURCES += Data/DataSaver/DataSaver.cpp
-HEADERS += Data/DataSaver/DataSaver.h
+SOURCES += Data/DataSaver/DataSaver.cpp \
+           Data/DataSaver/AsyncFileWriter.cpp \
+           Data/DataSaver/BinaryFormat.cpp \
+           Data/DataSaver/BlockCompression.cpp \
+           Data/DataSaver/Decimation.cpp \
+           Data/DataSaver/Durability.cpp \
+           Data/DataSaver/RecordReader.cpp \
+           Data/DataSaver/ShardedDataSaver.cpp \
+           Data/DataSaver/WriteBatch.cpp \
+           Data/DataSaver/IntegerCodec.cpp
+HEADERS += Data/DataSaver/DataSaver.h \
+           Data/DataSaver/AsyncFileWriter.h \
+           Data/DataSaver/BinaryFormat.h \
+           Data/DataSaver/BlockCompression.h \
+           Data/DataSaver/Decimation.h \
+           Data/DataSaver/Durability.h \
+           Data/DataSaver/RecordReader.h \
+           Data/DataSaver/ShardedDataSaver.h \
+           Data/DataSaver/WriteBatch.h \
+           Data/DataSaver/CsvFormat.h \
+           Data/DataSaver/IntegerCodec.h
 
 # Drivers/Scanner
 INCLUDEPATH += Drivers/Scanner
@@ -39,12 +62,20 @@ DEPENDPATH += Drivers/Scanner/sdk240410/64    # ScanControl.lib
 #SerialPort
 QT += serialport
 INCLUDEPATH += Drivers/SerialPort
-SOURCES += Drivers/SerialPort/SerialCommon.cpp
-HEADERS += Drivers/SerialPort/SerialCommon.h
+SOURCES += Drivers/SerialPort/SerialCommon.cpp \
+           Drivers/SerialPort/RawCapture.cpp \
+           Drivers/SerialPort/SerialChunkPool.cpp \
+           Drivers/SerialPort/SerialReactor.cpp
+HEADERS += Drivers/SerialPort/SerialCommon.h \
+           Drivers/SerialPort/RawCapture.h \
+           Drivers/SerialPort/SerialChunkPool.h \
+           Drivers/SerialPort/SerialReactor.h
 # Force sensor Based on SerialPort
 INCLUDEPATH += Drivers/ForceSensor
 SOURCES += Drivers/ForceSensor/ForceSensor.cpp
 HEADERS += Drivers/ForceSensor/ForceSensor.h
+SOURCES += Drivers/ForceSensor/ForceFrameDecoder.cpp
+HEADERS += Drivers/ForceSensor/ForceFrameDecoder.h
 
 
 
@@ -5,12 +5,31 @@ TEMPLATE = app
 
 SOURCES += \
     main.cpp \
-    ../../Data/DataSaver/DataSaver.cpp
+    ../../Data/DataSaver/DataSaver.cpp \
+    ../../Data/DataSaver/AsyncFileWriter.cpp \
+    ../../Data/DataSaver/BinaryFormat.cpp \
+    ../../Data/DataSaver/BlockCompression.cpp \
+    ../../Data/DataSaver/IntegerCodec.cpp \
+    ../../Data/DataSaver/Decimation.cpp \
+    ../../Data/DataSaver/Durability.cpp \
+    ../../Data/DataSaver/RecordReader.cpp \
+    ../../Data/DataSaver/ShardedDataSaver.cpp \
+    ../../Data/DataSaver/WriteBatch.cpp
 
 HEADERS += \
-    ../../Data/DataSaver/DataSaver.h
+    ../../Data/DataSaver/DataSaver.h \
+    ../../Data/DataSaver/AsyncFileWriter.h \
+    ../../Data/DataSaver/BinaryFormat.h \
+    ../../Data/DataSaver/BlockCompression.h \
+    ../../Data/DataSaver/IntegerCodec.h \
+    ../../Data/DataSaver/Decimation.h \
+    ../../Data/DataSaver/Durability.h \
+    ../../Data/DataSaver/RecordReader.h \
+    ../../Data/DataSaver/ShardedDataSaver.h \
+    ../../Data/DataSaver/WriteBatch.h \
+    ../../Data/DataSaver/CsvFormat.h
 
-INCLUDEPATH += ../../Data/DataSaver
+INCLUDEPATH += ../../Data/DataSaver ../../Global
 
 # 输出目录
 DESTDIR = ./build
@@ -3,8 +3,24 @@
 #include <QDir>
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <QFileInfo>
+#include <QtEndian>
 
 #include "../../Data/DataSaver/DataSaver.h"
+#include "../../Data/DataSaver/Decimation.h"
+#include "../../Data/DataSaver/Durability.h"
+#include "../../Data/DataSaver/RecordReader.h"
+#include "../../Data/DataSaver/ShardedDataSaver.h"
+
+#if defined(Q_OS_LINUX)
+#include <sys/stat.h>
+#endif
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
 
 int main(int argc, char *argv[])
 {
@@ -71,5 +87,496 @@ int main(int argc, char *argv[])
     const double seconds = usedMs / 1000.0;
     const double rate = seconds > 0 ? (written / seconds) : 0.0;
     qInfo() << "Written samples:" << written << ", seconds:" << seconds << ", avg rate:" << rate << "Hz";
+
+    // 吞吐量：不做节拍对齐，测量 CSV 文本路径每秒可写入的行数
+    {
+        const qint64 rows = 1'000'000;
+        QVector<double> drow(4);
+        QElapsedTimer t;
+        t.start();
+        for (qint64 i = 0; i < rows; ++i) {
+            row.clear();
+            const int v = static_cast<int>(i);
+            row << v << (v & 0xFF) << (v % 1000) << (v % 500) << (v % 7);
+            saver.writeInts("Throughput", "Int", row);
+        }
+        saver.flushAll();
+        const qint64 intNs = t.nsecsElapsed();
+
+        // 同样的数据改用流句柄写入
+        const DataSaver::StreamId stream = saver.openStream("Throughput", "IntStream");
+        t.restart();
+        for (qint64 i = 0; i < rows; ++i) {
+            row.clear();
+            const int v = static_cast<int>(i);
+            row << v << (v & 0xFF) << (v % 1000) << (v % 500) << (v % 7);
+            saver.writeInts(stream, row);
+        }
+        saver.flushAll();
+        const qint64 streamNs = t.nsecsElapsed();
+
+        // 批量接口：每次调用写入 1000 行的行主序矩阵
+        const int blockRows = 1000;
+        QVector<int> block(blockRows * 5);
+        const DataSaver::StreamId bulk = saver.openStream("Throughput", "IntBulk");
+        t.restart();
+        for (qint64 i0 = 0; i0 < rows; i0 += blockRows) {
+            int* p = block.data();
+            for (int k = 0; k < blockRows; ++k, p += 5) {
+                const int v = static_cast<int>(i0 + k);
+                p[0] = v; p[1] = v & 0xFF; p[2] = v % 1000; p[3] = v % 500; p[4] = v % 7;
+            }
+            saver.writeIntRows(bulk, block.constData(), blockRows, 5);
+        }
+        saver.flushAll();
+        const qint64 bulkNs = t.nsecsElapsed();
+
+        t.restart();
+        for (qint64 i = 0; i < rows; ++i) {
+            drow[0] = static_cast<double>(i);
+            drow[1] = i * 0.001;
+            drow[2] = -i * 0.5;
+            drow[3] = 1.0 / (i + 1);
+            saver.writeDoubles("Throughput", "Double", drow);
+        }
+        saver.flushAll();
+        const qint64 doubleNs = t.nsecsElapsed();
+        saver.closeAll();
+
+        qInfo() << "CSV throughput: writeInts" << rows * 1e9 / intNs << "rows/s,"
+                << "writeInts(stream)" << rows * 1e9 / streamNs << "rows/s,"
+                << "writeIntRows" << rows * 1e9 / bulkNs << "rows/s,"
+                << "writeDoubles" << rows * 1e9 / doubleNs << "rows/s";
+    }
+
+    // 二进制格式：写入同样的数据（不做节拍对齐），再转换回 CSV 对比
+    saver.setFormat(DataSaver::Format::Binary);
+    saver.setTimestampEpochUs(QDateTime::currentMSecsSinceEpoch() * 1000);
+    QDir("test/DataSaverTest/out/HighRate").remove("IntBin.bin");
+    saver.ensureBinary("HighRate", "IntBin", {
+        { "ts", BinaryFormat::ColumnType::Int32, 0.0 },
+        { "v1", BinaryFormat::ColumnType::Int32, 0.0 },
+        { "v2", BinaryFormat::ColumnType::Int32, 0.0 },
+        { "v3", BinaryFormat::ColumnType::Int32, 0.0 },
+        { "v4", BinaryFormat::ColumnType::Int32, 0.0 }
+    });
+    QElapsedTimer binTimer;
+    binTimer.start();
+    for (qint64 i = 0; i < totalSamples; ++i) {
+        row.clear();
+        const int t = static_cast<int>(i);
+        row << t << (t & 0xFF) << (t % 1000) << (t % 500) << (t % 7);
+        saver.writeInts("HighRate", "IntBin", row);
+    }
+    saver.close("HighRate", "IntBin");
+    const qint64 binMs = binTimer.elapsed();
+
+    const QString binPath = "test/DataSaverTest/out/HighRate/IntBin.bin";
+    const QString convertedPath = "test/DataSaverTest/out/HighRate/IntBin.csv";
+    QString error;
+    if (!BinaryFormat::convertToCsv(binPath, convertedPath, 6, &error)) {
+        qWarning() << "Convert failed:" << error;
+        return 1;
+    }
+    qInfo() << "Binary:" << totalSamples << "samples in" << binMs << "ms,"
+            << QFileInfo(binPath).size() << "bytes (CSV" << QFileInfo(convertedPath).size() << "bytes)";
+
+    // 回读：按时间戳区间查询，二进制与转换后的 CSV 结果应一致（ts 即样本序号）
+    const qint64 from = totalSamples / 2;
+    const qint64 to = from + 9999;
+    for (const QString& path : { binPath, convertedPath }) {
+        RecordReader reader;
+        QElapsedTimer openTimer;
+        openTimer.start();
+        if (!reader.open(path, "ts", 1024, &error)) {
+            qWarning() << "Open failed:" << error;
+            return 1;
+        }
+        const qint64 openUs = openTimer.nsecsElapsed() / 1000;
+        QElapsedTimer queryTimer;
+        queryTimer.start();
+        const RecordReader::Range range = reader.find(from, to);
+        const qint64 queryUs = queryTimer.nsecsElapsed() / 1000;
+        bool ok = range.firstRow == from && range.rows() == to - from + 1;
+        if (ok && reader.format() == RecordReader::Format::Binary) {
+            ok = BinaryFormat::getInt(reader.record(range.firstRow), BinaryFormat::ColumnType::Int32) == from;
+        } else if (ok) {
+            ok = QByteArray(reader.data() + range.begin, 16).startsWith(QByteArray::number(from) + ',');
+        }
+        qInfo() << "Reader:" << path << reader.rowCount() << "rows, open" << openUs << "us, query"
+                << queryUs << "us," << range.rows() << "rows" << (ok ? "OK" : "MISMATCH");
+        if (!ok) return 1;
+    }
+
+    // 压缩的二进制流按列打包：5kHz 时间戳 + 24 位原始计数（缓慢变化 + 噪声），
+    // 解压结果应与未压缩文件逐字节一致，并给出每条记录占用的字节数
+    {
+        const int rows = 1'000'000;
+        QDir packedDir("test/DataSaverTest/out/Packed");
+        if (packedDir.exists()) packedDir.removeRecursively();
+        const QVector<BinaryFormat::Column> columns {
+            { "ts_us", BinaryFormat::ColumnType::Int64, 0.0 },
+            { "raw", BinaryFormat::ColumnType::Int32, 2.5e-6 }
+        };
+        std::mt19937 rng(7);
+        std::normal_distribution<double> noise(0.0, 8.0);
+        std::uniform_int_distribution<int> jitter(-3, 3);
+        std::uniform_int_distribution<int> pick(0, 9);
+        QVector<double> block(2000); // 整型列按 double 写入，数值范围内精确
+        qint64 ts = 0;
+        for (bool compressed : { false, true }) {
+            saver.setCompression(compressed);
+            const DataSaver::StreamId id = saver.openBinaryStream("Packed", "Force", columns);
+            rng.seed(7);
+            ts = 0;
+            for (int i0 = 0; i0 < rows; i0 += 1000) {
+                for (int k = 0; k < 1000; ++k) {
+                    ts += 200 + (pick(rng) == 0 ? jitter(rng) : 0);
+                    block[2 * k] = static_cast<double>(ts);
+                    block[2 * k + 1] = std::round(3'000'000 + 20000 * std::sin((i0 + k) * 2e-4) + noise(rng));
+                }
+                saver.writeDoubleRows(id, block.constData(), 1000, 2);
+            }
+            saver.close(id);
+        }
+        saver.setCompression(false);
+
+        const QString plainPath = packedDir.filePath("Force.bin");
+        const QString packedPath = plainPath + ".sgz";
+        const QString restoredPath = packedDir.filePath("Restored.bin");
+        bool ok = BlockCompression::decompressFile(packedPath, restoredPath, &error);
+        QFile plain(plainPath);
+        QFile restored(restoredPath);
+        ok = ok && plain.open(QIODevice::ReadOnly) && restored.open(QIODevice::ReadOnly) && plain.readAll() == restored.readAll();
+        const double packedBytes = QFileInfo(packedPath).size();
+        qInfo() << "Packed:" << rows << "records," << QFileInfo(plainPath).size() << "->" << packedBytes << "bytes,"
+                << packedBytes / rows << "bytes/record, ratio" << QFileInfo(plainPath).size() / packedBytes
+                << (ok ? "OK" : "MISMATCH") << error;
+        if (!ok) return 1;
+
+        // 恢复：末尾追加一个不完整的打包块（异常中断），recoverFile 只截掉这一段，之前的打包块全部保留
+        const QString tornPath = packedDir.filePath("Torn.bin.sgz");
+        QByteArray tail(BlockCompression::BLOCK_HEADER_SIZE + 10, '\0');
+        qToLittleEndian<quint32>(4096, tail.data());
+        qToLittleEndian<quint32>(1000 | BlockCompression::PACKED_BLOCK_FLAG, tail.data() + 4);
+        QFile torn(tornPath);
+        ok = QFile::copy(packedPath, tornPath) && torn.open(QIODevice::Append) && torn.write(tail) == tail.size();
+        torn.close();
+        qint64 removed = 0;
+        ok = ok && Durability::recoverFile(tornPath, &removed, &error) && removed == tail.size()
+            && QFileInfo(tornPath).size() == QFileInfo(packedPath).size()
+            && BlockCompression::decompressFile(tornPath, restoredPath, &error);
+        restored.close();
+        ok = ok && plain.seek(0) && restored.open(QIODevice::ReadOnly) && plain.readAll() == restored.readAll();
+        qInfo() << "Packed recover: removed" << removed << "of" << tail.size() << "torn bytes" << (ok ? "OK" : "MISMATCH") << error;
+        if (!ok) return 1;
+    }
+
+    // 落盘检查点与恢复：每写一批做一次组提交，关闭时最后一个检查点应覆盖整个文件；
+    // 末尾追加不完整的数据（模拟断电），recoverFile 只截掉这一段
+    {
+        QDir durableDir("test/DataSaverTest/out/Durable");
+        if (durableDir.exists()) durableDir.removeRecursively();
+        struct Case {
+            const char* group;
+            DataSaver::Format format;
+            bool compressed;
+            const char* file;
+        };
+        const Case cases[] = {
+            { "Csv", DataSaver::Format::Csv, false, "Csv.csv" },
+            { "Bin", DataSaver::Format::Binary, false, "Bin.bin" },
+            { "Sgz", DataSaver::Format::Binary, true, "Sgz.bin.sgz" }
+        };
+        QVector<double> block(2000);
+        bool ok = true;
+        saver.setDurability(1000);
+        for (const Case& c : cases) {
+            saver.setFormat(c.format);
+            saver.setCompression(c.compressed);
+            const DataSaver::StreamId id = c.format == DataSaver::Format::Csv
+                ? saver.openStream("Durable", c.group, {"ts", "v"})
+                : saver.openBinaryStream("Durable", c.group, {
+                      { "ts", BinaryFormat::ColumnType::Int64, 0.0 },
+                      { "v", BinaryFormat::ColumnType::Float64, 0.0 }
+                  });
+            for (int part = 0; part < 3; ++part) {
+                for (int k = 0; k < 1000; ++k) {
+                    block[2 * k] = part * 1000 + k;
+                    block[2 * k + 1] = std::sin((part * 1000 + k) * 0.01);
+                }
+                saver.writeDoubleRows(id, block.constData(), 1000, 2);
+                saver.syncAll();
+            }
+            saver.close(id);
+
+            const QString path = durableDir.filePath(c.file);
+            const qint64 size = QFileInfo(path).size();
+            QByteArray tail;
+            if (c.compressed) {
+                tail.fill('\0', BlockCompression::BLOCK_HEADER_SIZE + 10);
+                qToLittleEndian<quint32>(4096, tail.data());
+                qToLittleEndian<quint32>(1000, tail.data() + 4);
+            } else if (c.format == DataSaver::Format::Binary) {
+                tail.fill('\x55', 7); // 不足一条记录（16 字节）
+            } else {
+                tail = "3000,0.14";    // 没有换行的半行
+            }
+            QFile file(path);
+            const bool appended = file.open(QIODevice::Append) && file.write(tail) == tail.size();
+            file.close();
+            qint64 removed = 0;
+            const bool caseOk = size > 0 && Durability::lastCheckpoint(path) == size && appended
+                && Durability::recoverFile(path, &removed, &error) && removed == tail.size()
+                && QFileInfo(path).size() == size;
+            qInfo() << "Durable:" << c.file << size << "bytes, checkpoint" << Durability::lastCheckpoint(path)
+                    << ", removed" << removed << "of" << tail.size() << "torn bytes" << (caseOk ? "OK" : "MISMATCH") << error;
+            ok = ok && caseOk;
+        }
+        saver.setDurability(0);
+        saver.setCompression(false);
+        saver.setFormat(DataSaver::Format::Binary);
+        if (!ok) return 1;
+    }
+
+    // 打开文件数上限：5 个流轮流写入、最多同时打开 2 个，每次写入都挂起最久未用的流（异步模式下收尾在写盘线程排队），
+    // 再次写入时重新打开并追加；关闭后再打开一遍续写。每个文件应与依次写入的全部行逐字节一致，压缩文件解压后比较
+    {
+        QDir lruDir("test/DataSaverTest/out/Lru");
+        if (lruDir.exists()) lruDir.removeRecursively();
+        const int streams = 5;
+        const int rounds = 40;
+        const int rowsPerWrite = 50;
+        bool ok = true;
+        saver.setFormat(DataSaver::Format::Csv);
+        saver.setAsyncWrite(true);
+        saver.setBufferLimitBytes(4 * 1024);
+        saver.setMaxOpenFiles(2);
+        for (bool compressed : { false, true }) {
+            saver.setCompression(compressed);
+            const QString prefix = compressed ? "Z" : "P";
+            QVector<QByteArray> expected(streams, QByteArray("seq,stream\n"));
+            int seq = 0;
+            for (int pass = 0; pass < 2; ++pass) {
+                QVector<DataSaver::StreamId> ids;
+                for (int s = 0; s < streams; ++s) {
+                    ids.append(saver.openStream("Lru", prefix + QString::number(s), {"seq", "stream"}));
+                }
+                for (int r = 0; r < rounds; ++r) {
+                    for (int s = 0; s < streams; ++s) {
+                        for (int k = 0; k < rowsPerWrite; ++k, ++seq) {
+                            saver.writeInts(ids[s], { seq, s });
+                            expected[s].append(QByteArray::number(seq) + ',' + QByteArray::number(s) + '\n');
+                        }
+                        ok = ok && saver.openFileCount() <= 2;
+                    }
+                }
+                for (DataSaver::StreamId id : ids) saver.close(id);
+            }
+            for (int s = 0; s < streams; ++s) {
+                QString path = lruDir.filePath(prefix + QString::number(s) + ".csv");
+                if (compressed) {
+                    ok = ok && BlockCompression::decompressFile(path + ".sgz", path, &error);
+                }
+                QFile file(path);
+                ok = ok && file.open(QIODevice::ReadOnly) && file.readAll() == expected[s];
+            }
+        }
+        qInfo() << "Max open files:" << streams << "streams x 2 passes," << rounds * streams * 2 << "evictions per format"
+                << (ok ? "OK" : "MISMATCH") << error;
+        saver.setMaxOpenFiles(0);
+        saver.setCompression(false);
+        saver.setBufferLimitBytes(256 * 1024);
+        saver.setFormat(DataSaver::Format::Binary);
+        if (!ok) return 1;
+    }
+
+    // 分段：按字节数换段（异步模式，旧段在写盘线程收尾），每段以 <group>.NNNNNN.csv 命名、开头重复表头，
+    // 预分配的空间在收尾时截掉；<group>.segments.csv 每段一行，字节数与段文件一致，去掉表头后拼接即全部数据
+    {
+        QDir segDir("test/DataSaverTest/out/Seg");
+        if (segDir.exists()) segDir.removeRecursively();
+        const int rows = 20000;
+        const qint64 preallocateBytes = 1 << 20;
+        const QByteArray header("seq,v\n");
+        saver.setFormat(DataSaver::Format::Csv);
+        saver.setAsyncWrite(true);
+        saver.setBufferLimitBytes(4 * 1024);
+        saver.setSegmentLimits(32 * 1024);
+        saver.setSegmentPreallocateBytes(preallocateBytes);
+        const DataSaver::StreamId id = saver.openStream("Seg", "Log", {"seq", "v"});
+        QByteArray expected;
+        for (int i = 0; i < rows; ++i) {
+            saver.writeInts(id, { i, i % 97 });
+            expected.append(QByteArray::number(i) + ',' + QByteArray::number(i % 97) + '\n');
+        }
+        saver.close(id);
+        saver.setSegmentLimits(0);
+        saver.setSegmentPreallocateBytes(0);
+        saver.setBufferLimitBytes(256 * 1024);
+        saver.setFormat(DataSaver::Format::Binary);
+
+        const QStringList files = segDir.entryList(QStringList() << "Log.??????.csv", QDir::Files, QDir::Name);
+        QFile index(segDir.filePath("Log.segments.csv"));
+        bool ok = files.size() >= 3 && index.open(QIODevice::ReadOnly)
+            && index.readLine() == "segment,file,start_us,end_us,bytes\n";
+        QByteArray data;
+        qint64 lastEndUs = 0;
+        for (int n = 0; ok && n < files.size(); ++n) {
+            const QString name = QStringLiteral("Log.%1.csv").arg(QString::number(n).rightJustified(6, '0'));
+            QFile file(segDir.filePath(name));
+            ok = files.value(n) == name && file.open(QIODevice::ReadOnly);
+            const QByteArray content = ok ? file.readAll() : QByteArray();
+            ok = ok && content.startsWith(header);
+            if (ok) data.append(content.mid(header.size()));
+#if defined(Q_OS_LINUX)
+            // 截掉预分配后占用的磁盘空间不超过数据本身（按 4KB 块取整）
+            struct stat st;
+            ok = ok && ::stat(QFile::encodeName(file.fileName()).constData(), &st) == 0
+                && qint64(st.st_blocks) * 512 <= (content.size() + 4095) / 4096 * 4096 + 4096
+                && qint64(st.st_blocks) * 512 < preallocateBytes;
+#endif
+            const QList<QByteArray> fields = index.readLine().trimmed().split(',');
+            ok = ok && fields.size() == 5 && fields[0].toInt() == n && fields[1] == name.toUtf8()
+                && fields[2].toLongLong() >= lastEndUs && fields[3].toLongLong() >= fields[2].toLongLong()
+                && fields[4].toLongLong() == content.size();
+            lastEndUs = fields.value(3).toLongLong();
+        }
+        ok = ok && index.atEnd() && data == expected;
+        qInfo() << "Segments:" << files.size() << "files," << expected.size() << "bytes" << (ok ? "OK" : "MISMATCH");
+        if (!ok) return 1;
+    }
+
+    // 降采样金字塔：按 ch 分区，每级记录数、count 与 min/max/mean 须与原始行一致；
+    // 列定义不一致时拒绝追加到已有级别文件，且只报告一次
+    {
+        const int rowsPerChannel = 1003; // 不是倍数的整数倍：最后一条为不满一组的尾部
+        const QVector<int> factors { 4, 16 };
+        QDir decimDir("test/DataSaverTest/out/Decim");
+        if (decimDir.exists()) decimDir.removeRecursively();
+        auto value = [](int ch, int i) { return ch * 1000 + std::sin(i * 0.37) * 100 + (i % 7); };
+
+        saver.setDecimation(factors, "ch");
+        const DataSaver::StreamId id = saver.openBinaryStream("Decim", "Sig", {
+            { "ch", BinaryFormat::ColumnType::Int32, 0.0 },
+            { "v", BinaryFormat::ColumnType::Float64, 0.0 }
+        });
+        QVector<double> pair(2);
+        for (int i = 0; i < rowsPerChannel; ++i) {
+            for (int ch = 1; ch <= 2; ++ch) {
+                pair[0] = ch;
+                pair[1] = value(ch, i);
+                saver.writeDoubleRows(id, pair.constData(), 1, 2);
+            }
+        }
+        saver.close(id);
+        saver.setDecimation({});
+
+        bool ok = true;
+        for (int ch = 1; ch <= 2 && ok; ++ch) {
+            for (int f : factors) {
+                QFile file(decimDir.filePath(QStringLiteral("Sig.ch%1.x%2.bin").arg(ch).arg(f)));
+                BinaryFormat::Header header;
+                ok = file.open(QIODevice::ReadOnly) && BinaryFormat::readHeader(file, header, &error);
+                const QByteArray records = ok ? file.readAll() : QByteArray();
+                const int recordSize = header.recordSize();
+                const int expected = (rowsPerChannel + f - 1) / f;
+                ok = ok && recordSize == 4 + 6 * 8 && records.size() == expected * recordSize;
+                for (int r = 0; ok && r < expected; ++r) {
+                    const char* rec = records.constData() + r * recordSize;
+                    const int first = r * f;
+                    const int last = qMin(rowsPerChannel, first + f);
+                    double mn = value(ch, first), mx = mn, sum = 0;
+                    for (int i = first; i < last; ++i) {
+                        mn = qMin(mn, value(ch, i));
+                        mx = qMax(mx, value(ch, i));
+                        sum += value(ch, i);
+                    }
+                    // 列：count, ch_min, ch_max, ch_mean, v_min, v_max, v_mean
+                    ok = BinaryFormat::getInt(rec, BinaryFormat::ColumnType::Int32) == last - first
+                        && BinaryFormat::getDouble(rec + 4, BinaryFormat::ColumnType::Float64) == ch
+                        && BinaryFormat::getDouble(rec + 28, BinaryFormat::ColumnType::Float64) == mn
+                        && BinaryFormat::getDouble(rec + 36, BinaryFormat::ColumnType::Float64) == mx
+                        && std::fabs(BinaryFormat::getDouble(rec + 44, BinaryFormat::ColumnType::Float64) - sum / (last - first)) < 1e-9;
+                }
+                if (!ok) qWarning() << "Decimation mismatch:" << file.fileName() << error;
+            }
+        }
+
+        // 同名文件、不同列名：打开失败只报告一次，之后该分区的行被跳过，已有文件不变
+        const qint64 before = QFileInfo(decimDir.filePath("Sig.ch1.x4.bin")).size();
+        {
+            Decimation::Writer writer(decimDir.filePath("Sig"), "Sig.bin", factors, { "ch", "w" }, "ch");
+            const double row[2] = { 1, 0.5 };
+            ok = ok && !writer.add(row) && !writer.errorString().isEmpty() && writer.add(row) && writer.close();
+        }
+        ok = ok && QFileInfo(decimDir.filePath("Sig.ch1.x4.bin")).size() == before;
+        qInfo() << "Decimation:" << rowsPerChannel << "rows x 2 channels, factors" << factors << (ok ? "OK" : "MISMATCH");
+        if (!ok) return 1;
+    }
+
+    // 多生产者：4 个线程各写自己的流并共同写一个流，每个流内同一生产者的序号应连续递增
+    {
+        const int producers = 4;
+        const int rowsPerProducer = 256 * 1024;
+        const int batch = 64;
+        ShardedDataSaver sharded(2);
+        QObject::connect(&sharded, &ShardedDataSaver::errorOccurred, [](const QString& m){ qWarning() << "Error:" << m; });
+        sharded.configure([](DataSaver& d) {
+            d.setBaseDir("test/DataSaverTest/out");
+            d.setBufferLimitBytes(256 * 1024);
+        });
+        QDir multiDir("test/DataSaverTest/out/Multi");
+        if (multiDir.exists()) multiDir.removeRecursively();
+        sharded.start();
+        QVector<ShardedDataSaver::StreamId> own;
+        for (int p = 0; p < producers; ++p) {
+            own.append(sharded.openStream("Multi", QStringLiteral("P%1").arg(p), {"seq", "producer"}));
+        }
+        const ShardedDataSaver::StreamId shared = sharded.openStream("Multi", "Shared", {"seq", "producer"});
+
+        QElapsedTimer multiTimer;
+        multiTimer.start();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p]() {
+                ShardedDataSaver::Producer* producer = sharded.createProducer();
+                QVector<int> rows(batch * 2);
+                for (int i = 0; i < rowsPerProducer; i += batch) {
+                    for (int k = 0; k < batch; ++k) {
+                        rows[2 * k] = i + k;
+                        rows[2 * k + 1] = p;
+                    }
+                    producer->writeIntRows(own[p], rows.constData(), batch, 2);
+                    producer->writeIntRows(shared, rows.constData(), batch, 2);
+                }
+            });
+        }
+        for (std::thread& t : threads) t.join();
+        // 行数 × 列数超出单条消息上限（int 乘法会溢出）：应直接拒绝，不读取数据
+        const bool rejected = !sharded.createProducer()->writeIntRows(shared, nullptr, std::numeric_limits<int>::max(), 4);
+        sharded.stop();
+        const qint64 multiMs = multiTimer.elapsed();
+
+        bool ok = rejected;
+        for (int p = 0; p <= producers && ok; ++p) {
+            const QString name = p < producers ? QStringLiteral("P%1.csv").arg(p) : QStringLiteral("Shared.csv");
+            QFile file(multiDir.filePath(name));
+            ok = file.open(QIODevice::ReadOnly);
+            file.readLine(); // 表头
+            QVector<int> next(producers, 0);
+            qint64 lines = 0;
+            while (ok && !file.atEnd()) {
+                const QList<QByteArray> fields = file.readLine().trimmed().split(',');
+                const int producer = fields.value(1).toInt();
+                ok = producer >= 0 && producer < producers && fields.value(0).toInt() == next[producer]++;
+                ++lines;
+            }
+            ok = ok && lines == qint64(rowsPerProducer) * (p < producers ? 1 : producers);
+        }
+        qInfo() << "Sharded:" << producers << "producers," << qint64(rowsPerProducer) * producers * 2 << "rows in"
+                << multiMs << "ms" << (ok ? "OK" : "MISMATCH");
+        if (!ok) return 1;
+    }
     return 0;
 }
@@ -0,0 +1,128 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QVector>
+#include <cstdio>
+#include <random>
+
+#include "../../Drivers/ForceSensor/ForceFrameDecoder.h"
+
+using namespace ForceFrameDecoder;
+
+// 批量解码各实现的一致性测试与基准：Scalar / SSE2 / AVX2 对同一输入（含各种损坏帧）
+// 返回的有效帧数、通道索引与原始值须与逐帧 decodeFrame 完全相同。
+// forceBackend 只在这里切换，测试期间没有其他线程在解码。
+
+// 生成 frames 个背靠背的单帧，通道标识依次轮换；corrupt 为真时随机损坏其中一帧的某个字节
+static QByteArray makeStream(std::mt19937& rng, const QByteArray& ids, int frames, bool corrupt)
+{
+    QByteArray s;
+    s.reserve(frames * FRAME_SIZE);
+    char frame[FRAME_SIZE + 1];
+    for (int i = 0; i < frames; ++i) {
+        std::snprintf(frame, sizeof(frame), "%06x0%c\r\n", static_cast<unsigned>(rng() & 0xFFFFFF), ids.at(i % ids.size()));
+        // 大小写十六进制都应接受
+        if (rng() % 4 == 0) {
+            for (int k = 0; k < HEX_DIGITS; ++k) {
+                if (frame[k] >= 'a') frame[k] = static_cast<char>(frame[k] - 'a' + 'A');
+            }
+        }
+        s.append(frame, FRAME_SIZE);
+    }
+    if (corrupt && frames > 0) {
+        // 非法十六进制、非 '0' 填充、未知通道标识、错误的结束符
+        static const char bad[] = { 'g', 'G', ' ', 'x', '1', 'z', '\n', '\r', '\0', '\x80' };
+        const int at = static_cast<int>(rng() % static_cast<unsigned>(frames)) * FRAME_SIZE
+                     + static_cast<int>(rng() % FRAME_SIZE);
+        char c = bad[rng() % sizeof(bad)];
+        if (c == s.at(at)) c = '\x7f';
+        s[at] = c;
+    }
+    return s;
+}
+
+// 逐帧参考实现
+static int decodeReference(const char* p, int maxFrames, const ChannelMap& map, std::uint8_t* channels, int* raws)
+{
+    for (int i = 0; i < maxFrames; ++i) {
+        int channel = 0;
+        if (!decodeFrame(p + i * FRAME_SIZE, map, channel, raws[i])) {
+            return i;
+        }
+        channels[i] = static_cast<std::uint8_t>(channel);
+    }
+    return maxFrames;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const Backend defaultBackend = activeBackend();
+    QVector<Backend> backends;
+    for (Backend b : { Backend::Scalar, Backend::Sse2, Backend::Avx2 }) {
+        forceBackend(b);
+        if (activeBackend() == b) {
+            backends.append(b);
+        } else {
+            qInfo() << backendName(b) << "not supported on this CPU, skipped";
+        }
+    }
+
+    std::mt19937 rng(20240607);
+    const QByteArray idSets[] = { QByteArray("bd"), QByteArray("abcdefgh"), QByteArray("0123456789ABCDEF") };
+    const int maxFrames = 300; // 覆盖 AVX2 的 16 帧块、SSE2 的余数与纯标量尾部
+    QVector<std::uint8_t> refChannels(maxFrames), channels(maxFrames);
+    QVector<int> refRaws(maxFrames), raws(maxFrames);
+    int streams = 0;
+    for (const QByteArray& ids : idSets) {
+        ChannelMap map;
+        if (!map.assign(ids.constData(), ids.size())) {
+            qWarning() << "ChannelMap rejected" << ids;
+            return 1;
+        }
+        for (int trial = 0; trial < 20000; ++trial) {
+            const int frames = 1 + static_cast<int>(rng() % maxFrames);
+            const QByteArray s = makeStream(rng, ids, frames, trial % 4 != 0);
+            const int expected = decodeReference(s.constData(), frames, map, refChannels.data(), refRaws.data());
+            for (Backend b : backends) {
+                forceBackend(b);
+                const int n = decodeFrames(s.constData(), frames, map, channels.data(), raws.data());
+                bool ok = n == expected;
+                for (int i = 0; ok && i < n; ++i) {
+                    ok = channels[i] == refChannels[i] && raws[i] == refRaws[i];
+                }
+                if (!ok) {
+                    qWarning() << backendName(b) << "MISMATCH: channels" << ids << "frames" << frames
+                               << "valid" << n << "expected" << expected;
+                    return 1;
+                }
+            }
+            ++streams;
+        }
+    }
+    qInfo() << "Equivalence:" << streams << "streams," << backends.size() << "backends OK";
+
+    // 吞吐：8 通道、无损坏的长数据流
+    {
+        const int frames = 1 << 20;
+        const QByteArray ids("abcdefgh");
+        ChannelMap map;
+        map.assign(ids.constData(), ids.size());
+        const QByteArray s = makeStream(rng, ids, frames, false);
+        QVector<std::uint8_t> bulkChannels(frames);
+        QVector<int> bulkRaws(frames);
+        for (Backend b : backends) {
+            forceBackend(b);
+            QElapsedTimer timer;
+            timer.start();
+            const int n = decodeFrames(s.constData(), frames, map, bulkChannels.data(), bulkRaws.data());
+            const qint64 ns = timer.nsecsElapsed();
+            qInfo().noquote() << backendName(b) << "frames:" << n << "Mframes/s:" << frames * 1e3 / qMax<qint64>(ns, 1);
+            if (n != frames) return 1;
+        }
+    }
+
+    forceBackend(defaultBackend);
+    return 0;
+}
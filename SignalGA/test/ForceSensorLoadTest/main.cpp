@@ -0,0 +1,180 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "ForceSensor.h"
+#include "ForceSensorSimulator.h"
+#include "../TestOptions.h"
+
+// 端到端负载测试：模拟器（pty） -> ForceSensor（独立线程） -> 样本环形缓冲区 -> 本线程取出
+// 用法：ForceSensorLoadTest [key=value]...
+//   rate=5000 seconds=5 corrupt=0 gaps=0 gapms=50 block=0 interval=1000 ring=65536 drainms=5 direct=0
+//   direct=1 时 ForceSensor 使用 Direct 读取模式（专用读线程），可与默认的事件循环模式对比延迟
+// 模拟器两通道均为 Counter 波形（原始值 = 包序号），据此统计丢包并计算延迟：
+//   解析延迟 = 样本时间戳 - 排期发送时刻；投递延迟 = 本线程取到样本的时刻 - 排期发送时刻
+// 未注入损坏/断流且没有 pty 溢出和环形缓冲区丢弃时，若仍有丢包则返回 1。
+
+static qint64 percentile(std::vector<qint64>& values, double p)
+{
+    if (values.empty()) {
+        return 0;
+    }
+    const size_t k = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(k), values.end());
+    return values[k];
+}
+
+static void printLatency(const char* name, std::vector<qint64>& values)
+{
+    qInfo().noquote() << name << "us  p50:" << percentile(values, 0.5) / 1000
+                      << "p99:" << percentile(values, 0.99) / 1000
+                      << "p99.9:" << percentile(values, 0.999) / 1000
+                      << "max:" << percentile(values, 1.0) / 1000;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QHash<QString, double> options {
+        { QStringLiteral("rate"), 5000 }, { QStringLiteral("seconds"), 5 }, { QStringLiteral("corrupt"), 0 },
+        { QStringLiteral("gaps"), 0 }, { QStringLiteral("gapms"), 50 }, { QStringLiteral("block"), 0 },
+        { QStringLiteral("interval"), 1000 }, { QStringLiteral("ring"), 1 << 16 }, { QStringLiteral("drainms"), 5 },
+        { QStringLiteral("direct"), 0 }
+    };
+    if (!parseTestOptions(app.arguments(), options)) {
+        return 2;
+    }
+    const int rate = static_cast<int>(options.value(QStringLiteral("rate")));
+    const int seconds = static_cast<int>(options.value(QStringLiteral("seconds")));
+    const int drainMs = static_cast<int>(options.value(QStringLiteral("drainms")));
+
+    ForceSensorSimulator sim;
+    if (!sim.setRateHz(rate)) {
+        return 2;
+    }
+    sim.setWaveform(1, ForceSensorSimulator::Waveform::Counter, 0.0, 0.0, 0);
+    sim.setWaveform(2, ForceSensorSimulator::Waveform::Counter, 0.0, 0.0, 0);
+    sim.setCorruptionRate(options.value(QStringLiteral("corrupt")));
+    sim.setGaps(options.value(QStringLiteral("gaps")), static_cast<int>(options.value(QStringLiteral("gapms"))));
+    sim.setBlockOnFull(options.value(QStringLiteral("block")) != 0);
+    sim.setWriteIntervalUs(static_cast<int>(options.value(QStringLiteral("interval"))));
+    if (!sim.open()) {
+        return 1;
+    }
+
+    // 传感器线程：与 TaskThreadManager 相同的接法
+    ForceSampleRing ring(static_cast<std::size_t>(options.value(QStringLiteral("ring"))), TCM::RingOverflowPolicy::DropOldest);
+    QThread sensorThread;
+    ForceSensor* sensor = new ForceSensor(sim.portName(), 1.0, 1.0);
+    sensor->setSampleRing(&ring);
+    if (options.value(QStringLiteral("direct")) != 0 && !sensor->setReadMode(SerialCommon::ReadMode::Direct)) {
+        delete sensor;
+        return 2;
+    }
+    sensor->moveToThread(&sensorThread);
+    std::atomic<int> connected { 0 }; // 0 等待，1 成功，-1 失败
+    const QString port = sim.portName();
+    QObject::connect(&sensorThread, &QThread::started, sensor, [sensor, port, &connected]() {
+        connected = sensor->connect(port, 921600, QSerialPort::Data8, QSerialPort::NoParity, QSerialPort::OneStop) ? 1 : -1;
+    });
+    QObject::connect(&sensorThread, &QThread::finished, sensor, [sensor]() {
+        sensor->disConnect();
+    });
+    sensorThread.start();
+    while (connected.load() == 0) {
+        QThread::msleep(1);
+    }
+    if (connected.load() < 0) {
+        sensorThread.quit();
+        sensorThread.wait();
+        delete sensor;
+        return 1;
+    }
+
+    // 传感器时间戳（QElapsedTimer 微秒）换算到模拟器时基的偏移
+    const qint64 clockOffsetNs = ForceSensorSimulator::nowNs() - sensor->currentTimestampUs() * 1000;
+    sim.start();
+
+    const quint64 expected = static_cast<quint64>(rate) * static_cast<quint64>(seconds);
+    std::vector<qint64> parseLatency;
+    std::vector<qint64> deliverLatency;
+    parseLatency.reserve(expected);
+    deliverLatency.reserve(expected);
+    std::unique_ptr<ForceSample[]> buffer(new ForceSample[4096]);
+    quint64 received[2] = { 0, 0 };
+    quint64 nextSeq = 0;      // 通道 1 期望的下一个序号
+    quint64 missing = 0;
+    quint64 reordered = 0;
+
+    auto drain = [&]() {
+        for (;;) {
+            const std::size_t n = ring.popBatch(buffer.get(), 4096);
+            const qint64 now = ForceSensorSimulator::nowNs();
+            for (std::size_t i = 0; i < n; ++i) {
+                const ForceSample& s = buffer[i];
+                ++received[s.channel - 1];
+                if (s.channel != 1) {
+                    continue;
+                }
+                // 24 位序号相对上一个序号展开为 64 位，向后跳（差值超过半个周期）视为乱序
+                const int raw = static_cast<int>(s.absoluteForce);
+                const int delta = (raw - static_cast<int>(nextSeq & 0xFFFFFF)) & 0xFFFFFF;
+                if (delta >= 0x800000) {
+                    ++reordered;
+                    continue;
+                }
+                const quint64 seq = nextSeq + static_cast<quint64>(delta);
+                missing += seq - nextSeq;
+                nextSeq = seq + 1;
+                const qint64 due = sim.packetDueNs(seq);
+                parseLatency.push_back(s.timestampUs * 1000 + clockOffsetNs - due);
+                deliverLatency.push_back(now - due);
+            }
+            if (n < 4096) {
+                break;
+            }
+        }
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < seconds * 1000LL) {
+        drain();
+        QThread::msleep(static_cast<unsigned long>(drainMs));
+    }
+    sim.stopAndWait();
+    QThread::msleep(100); // 等待在途数据被解析
+    sensorThread.quit();
+    sensorThread.wait();
+    ring.close();
+    drain();
+    const double elapsedS = timer.nsecsElapsed() / 1e9;
+    delete sensor;
+
+    const ForceSensorSimulator::Stats st = sim.stats();
+    const quint64 ringDropped = ring.droppedCount();
+    qInfo().noquote() << "rate:" << rate << "Hz seconds:" << seconds << "port:" << sim.portName()
+                      << "read mode:" << (options.value(QStringLiteral("direct")) != 0 ? "direct" : "event loop");
+    qInfo().noquote() << "simulator packets:" << st.packets << "sent:" << st.sent << "corrupted:" << st.corrupted
+                      << "skipped:" << st.skipped << "overrun:" << st.overrun << "max lag ms:" << st.maxLagNs / 1e6;
+    qInfo().noquote() << "received ch1:" << received[0] << "ch2:" << received[1]
+                      << "missing ch1:" << missing << "reordered:" << reordered << "ring dropped:" << ringDropped
+                      << "samples/s:" << (received[0] + received[1]) / elapsedS;
+    printLatency("parse latency", parseLatency);
+    printLatency("deliver latency", deliverLatency);
+
+    const bool clean = st.corrupted == 0 && st.skipped == 0 && st.overrun == 0 && ringDropped == 0;
+    if (clean && (missing != 0 || reordered != 0 || received[0] != st.sent)) {
+        qWarning() << "unexpected loss without injected faults";
+        return 1;
+    }
+    qInfo() << "ForceSensorLoadTest OK";
+    return 0;
+}
@@ -0,0 +1,16 @@
+QT += core
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp \
+    ../../Data/DataSaver/IntegerCodec.cpp
+
+HEADERS += \
+    ../../Data/DataSaver/IntegerCodec.h
+
+INCLUDEPATH += ../../Data/DataSaver
+
+# 输出目录
+DESTDIR = ./build
@@ -0,0 +1,120 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QVector>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "../../Data/DataSaver/IntegerCodec.h"
+
+// 整数编码往返测试与基准：5kHz 时间戳（200us 间隔 + 抖动）与 24 位原始力值（随机游走）
+template <typename T>
+static bool roundTrip(const char* name, const QVector<T>& values, IntegerCodec::Mode mode, int repeat)
+{
+    const int count = values.size();
+    QByteArray encoded;
+    encoded.resize(static_cast<int>(IntegerCodec::maxEncodedSize(count)));
+    QVector<T> decoded(count);
+
+    int bytes = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < repeat; ++r) {
+        bytes = IntegerCodec::encode(values.constData(), count, mode, encoded.data());
+    }
+    const qint64 encNs = timer.nsecsElapsed();
+
+    int consumed = 0;
+    timer.restart();
+    for (int r = 0; r < repeat; ++r) {
+        consumed = IntegerCodec::decode(encoded.constData(), bytes, count, mode, decoded.data());
+    }
+    const qint64 decNs = timer.nsecsElapsed();
+
+    if (consumed != bytes || decoded != values) {
+        qWarning() << name << "round trip FAILED";
+        return false;
+    }
+    // 吞吐按原始（未编码）字节计
+    const double rawBytes = double(count) * sizeof(T) * repeat;
+    qInfo().noquote() << name
+                      << "samples:" << count
+                      << "bytes/sample:" << double(bytes) / count
+                      << "ratio vs raw:" << double(count) * sizeof(T) / bytes
+                      << "encode GB/s:" << rawBytes / encNs
+                      << "decode GB/s:" << rawBytes / decNs;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const int count = 5'000'000; // 1000 秒 @ 5kHz
+    const int repeat = 5;
+    std::mt19937 rng(12345);
+
+    // 时间戳：名义 200us，偶有 ±3us 抖动
+    QVector<qint64> ts(count);
+    std::uniform_int_distribution<int> jitter(-3, 3);
+    std::uniform_int_distribution<int> pick(0, 9);
+    qint64 t = 1'000'000;
+    for (int i = 0; i < count; ++i) {
+        t += 200 + (pick(rng) == 0 ? jitter(rng) : 0);
+        ts[i] = t;
+    }
+
+    // 原始力值：24 位有符号，随机游走（相邻差值在几百以内）
+    QVector<qint32> raw(count);
+    std::normal_distribution<double> step(0.0, 60.0);
+    double v = 3'000'000;
+    for (int i = 0; i < count; ++i) {
+        v += step(rng);
+        if (v > 8'388'607) v = 8'388'607;
+        if (v < -8'388'608) v = -8'388'608;
+        raw[i] = static_cast<qint32>(v);
+    }
+
+    // 静止时的原始力值：零点附近只有几个计数的噪声，按位打包时每值只占几位
+    QVector<qint32> quiet(count);
+    std::normal_distribution<double> noise(0.0, 3.0);
+    for (int i = 0; i < count; ++i) {
+        quiet[i] = 120'000 + static_cast<qint32>(std::lround(noise(rng)));
+    }
+
+    // 边界值：保证任意输入都能精确还原
+    QVector<qint64> extremes { 0, -1, 1, std::numeric_limits<qint64>::max(), std::numeric_limits<qint64>::min(),
+                               42, std::numeric_limits<qint64>::min(), std::numeric_limits<qint64>::max() };
+
+    bool ok = true;
+    ok &= roundTrip("ts_us  delta-of-delta", ts, IntegerCodec::Mode::DeltaOfDelta, repeat);
+    ok &= roundTrip("ts_us  delta         ", ts, IntegerCodec::Mode::Delta, repeat);
+    ok &= roundTrip("ts_us  dod bitpacked ", ts, IntegerCodec::Mode::DeltaOfDeltaBitPacked, repeat);
+    ok &= roundTrip("raw    delta         ", raw, IntegerCodec::Mode::Delta, repeat);
+    ok &= roundTrip("raw    delta bitpacked", raw, IntegerCodec::Mode::DeltaBitPacked, repeat);
+    ok &= roundTrip("quiet  delta         ", quiet, IntegerCodec::Mode::Delta, repeat);
+    ok &= roundTrip("quiet  delta bitpacked", quiet, IntegerCodec::Mode::DeltaBitPacked, repeat);
+    ok &= roundTrip("extremes delta       ", extremes, IntegerCodec::Mode::Delta, 1);
+    ok &= roundTrip("extremes dod         ", extremes, IntegerCodec::Mode::DeltaOfDelta, 1);
+    ok &= roundTrip("extremes bitpacked   ", extremes, IntegerCodec::Mode::DeltaBitPacked, 1);
+    ok &= roundTrip("extremes dod bitpacked", extremes, IntegerCodec::Mode::DeltaOfDeltaBitPacked, 1);
+
+    // 截断的数据必须被拒绝
+    QByteArray encoded;
+    const int bytes = IntegerCodec::encode(raw.constData(), 1000, IntegerCodec::Mode::Delta, encoded);
+    QVector<qint32> out(1000);
+    if (IntegerCodec::decode(encoded.constData(), bytes - 1, 1000, IntegerCodec::Mode::Delta, out.data()) != -1) {
+        qWarning() << "truncated input not rejected";
+        ok = false;
+    }
+    encoded.clear();
+    const int packedBytes = IntegerCodec::encode(raw.constData(), 1000, IntegerCodec::Mode::DeltaBitPacked, encoded);
+    if (IntegerCodec::decode(encoded.constData(), packedBytes - 1, 1000, IntegerCodec::Mode::DeltaBitPacked, out.data()) != -1) {
+        qWarning() << "truncated bit-packed input not rejected";
+        ok = false;
+    }
+
+    qInfo() << (ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QVector>
+#include <cstdio>
+#include <random>
+
+#include "RawCapture.h"
+#include "ForceSensor.h"
+#include "ForceFrameDecoder.h"
+
+// 原始字节流抓取/回放测试与解析基准
+// 用法：RawReplayTest [抓取文件]
+//   不带参数：生成合成的双通道数据流（随机切块，夹杂错位数据），写入抓取文件后读回校验，
+//            再回放到 ForceSensor 校验样本，并重复回放测量解析吞吐
+//   带参数：回放指定的抓取文件（例如现场 setRawCapturePath 录下的数据），输出样本数与吞吐
+
+struct ReplayStats {
+    quint64 samples = 0;
+    long long firstTsUs = -1;
+    long long lastTsUs = -1;
+    bool monotonic = true;
+    double lastForce[2] = { 0.0, 0.0 };
+};
+
+static quint64 replay(ForceSensor& sensor, RawCaptureReader& reader, ReplayStats& stats, qint64* elapsedNs)
+{
+    reader.rewind();
+    QElapsedTimer timer;
+    timer.start();
+    const quint64 chunks = sensor.replayCapture(reader);
+    *elapsedNs = timer.nsecsElapsed();
+    return chunks;
+}
+
+static int replayFile(const QString& path)
+{
+    RawCaptureReader reader;
+    if (!reader.open(path)) {
+        return 1;
+    }
+    ForceSensor sensor(QString(), 1.0, 1.0);
+    ReplayStats stats;
+    QObject::connect(&sensor, &ForceSensor::forceBatchReady, [&stats](const QVector<ForceSample>& batch) {
+        stats.samples += static_cast<quint64>(batch.size());
+    });
+    qint64 ns = 0;
+    const quint64 chunks = replay(sensor, reader, stats, &ns);
+    const double bytes = static_cast<double>(reader.payloadBytes());
+    qInfo().noquote() << path << "chunks:" << chunks << "bytes:" << bytes << "samples:" << stats.samples
+                      << "truncated:" << reader.isTruncated()
+                      << "MB/s:" << bytes / 1e6 / (ns / 1e9) << "Msamples/s:" << stats.samples / 1e6 / (ns / 1e9);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    if (argc > 1) {
+        return replayFile(QString::fromLocal8Bit(argv[1]));
+    }
+
+    // 合成数据：双通道交替，每 997 帧插入一段错位数据
+    const int frames = 2'000'000;
+    QByteArray stream;
+    stream.reserve(frames * ForceFrameDecoder::FRAME_SIZE + frames / 997 * 8);
+    char frame[ForceFrameDecoder::FRAME_SIZE + 1];
+    for (int i = 0; i < frames; ++i) {
+        const int raw = (0x100000 + i * 7) & 0xFFFFFF;
+        std::snprintf(frame, sizeof(frame), "%06x0%c\r\n", raw, (i & 1) ? 'd' : 'b');
+        stream.append(frame, ForceFrameDecoder::FRAME_SIZE);
+        if (i % 997 == 996) {
+            stream.append("x1\r\n", 4);
+        }
+    }
+
+    // 随机切块写入抓取文件，模拟串口每次读到的长度；时间戳按 921600 波特率下的传输时间递增
+    const QString path = QDir::tempPath() + QStringLiteral("/RawReplayTest.sgraw");
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<int> chunkSize(1, 4096);
+    QVector<qint64> chunkTs;
+    {
+        RawCapture capture;
+        if (!capture.open(path, 1'700'000'000'000'000LL)) {
+            return 1;
+        }
+        int pos = 0;
+        qint64 tsNs = 0;
+        while (pos < stream.size()) {
+            const int n = std::min(chunkSize(rng), stream.size() - pos);
+            tsNs += static_cast<qint64>(n) * 10 * 1'000'000'000LL / 921600;
+            capture.append(tsNs, stream.constData() + pos, n);
+            chunkTs.append(tsNs);
+            pos += n;
+            if (chunkTs.size() % 16 == 0) {
+                capture.commit();
+            }
+        }
+        capture.close();
+        if (capture.chunkCount() != static_cast<quint64>(chunkTs.size())
+            || capture.byteCount() != static_cast<quint64>(stream.size())) {
+            qWarning() << "capture counters FAILED";
+            return 1;
+        }
+    }
+
+    // 读回校验：拼接后的负载与时间戳与写入一致
+    RawCaptureReader reader;
+    if (!reader.open(path) || reader.epochUs() != 1'700'000'000'000'000LL) {
+        qWarning() << "reader open FAILED";
+        return 1;
+    }
+    {
+        QByteArray joined;
+        joined.reserve(stream.size());
+        RawCaptureReader::Chunk chunk;
+        int index = 0;
+        bool tsOk = true;
+        while (reader.next(chunk)) {
+            tsOk = tsOk && index < chunkTs.size() && chunk.timestampNs == chunkTs[index];
+            joined.append(chunk.data, chunk.size);
+            ++index;
+        }
+        if (joined != stream || !tsOk || index != chunkTs.size() || reader.isTruncated()) {
+            qWarning() << "read back FAILED";
+            return 1;
+        }
+    }
+
+    // 回放校验：样本数、时间戳单调、末尾力值
+    ForceSensor sensor(QString(), 0.5, 0.25);
+    ReplayStats stats;
+    QObject::connect(&sensor, &ForceSensor::forceBatchReady, [&stats](const QVector<ForceSample>& batch) {
+        for (const ForceSample& s : batch) {
+            if (stats.lastTsUs > s.timestampUs) {
+                stats.monotonic = false;
+            }
+            if (stats.firstTsUs < 0) {
+                stats.firstTsUs = s.timestampUs;
+            }
+            stats.lastTsUs = s.timestampUs;
+            stats.lastForce[s.channel - 1] = s.absoluteForce;
+        }
+        stats.samples += static_cast<quint64>(batch.size());
+    });
+    qint64 ns = 0;
+    replay(sensor, reader, stats, &ns);
+    const double expectLast1 = ((0x100000 + (frames - 2) * 7) & 0xFFFFFF) * 0.5;
+    const double expectLast2 = ((0x100000 + (frames - 1) * 7) & 0xFFFFFF) * 0.25;
+    if (stats.samples != static_cast<quint64>(frames) || !stats.monotonic
+        || stats.firstTsUs < 0 || stats.lastTsUs != chunkTs.last() / 1000
+        || stats.lastForce[0] != expectLast1 || stats.lastForce[1] != expectLast2) {
+        qWarning() << "replay FAILED samples:" << stats.samples << "monotonic:" << stats.monotonic;
+        return 1;
+    }
+
+    // 基准：重复回放（解析器状态延续，不影响吞吐）
+    const int repeat = 5;
+    qint64 best = 0;
+    for (int r = 0; r < repeat; ++r) {
+        replay(sensor, reader, stats, &ns);
+        if (best == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    qInfo().noquote() << "replay" << ForceFrameDecoder::backendName(ForceFrameDecoder::activeBackend())
+                      << "chunks:" << chunkTs.size() << "bytes:" << stream.size() << "frames:" << frames
+                      << "MB/s:" << stream.size() / 1e6 / (best / 1e9)
+                      << "Mframes/s:" << frames / 1e6 / (best / 1e9);
+
+    reader.close();
+    QFile::remove(path);
+    qInfo() << "RawReplayTest OK";
+    return 0;
+}
@@ -0,0 +1,30 @@
+QT += core serialport
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp \
+    ../../Drivers/SerialPort/SerialCommon.cpp \
+    ../../Drivers/SerialPort/RawCapture.cpp \
+    ../../Drivers/SerialPort/SerialChunkPool.cpp \
+    ../../Drivers/SerialPort/SerialReactor.cpp \
+    ../../Drivers/ForceSensor/ForceSensor.cpp \
+    ../../Drivers/ForceSensor/ForceFrameDecoder.cpp \
+    ../../Drivers/ForceSensor/ForceSensorSimulator.cpp
+
+HEADERS += \
+    ../../Drivers/SerialPort/SerialCommon.h \
+    ../../Drivers/SerialPort/RawCapture.h \
+    ../../Drivers/SerialPort/SerialChunkPool.h \
+    ../../Drivers/SerialPort/SerialReactor.h \
+    ../../Drivers/ForceSensor/ForceSensor.h \
+    ../../Drivers/ForceSensor/ForceFrameDecoder.h \
+    ../../Drivers/ForceSensor/ForceSensorSimulator.h \
+    ../../Global/SpscRing.h \
+    ../TestOptions.h
+
+INCLUDEPATH += ../../Drivers/SerialPort ../../Drivers/ForceSensor ../../Global
+
+# 输出目录
+DESTDIR = ./build
@@ -0,0 +1,155 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QThread>
+#include <memory>
+#include <vector>
+
+#include "ForceSensor.h"
+#include "ForceSensorSimulator.h"
+#include "SerialReactor.h"
+#include "../TestOptions.h"
+
+// 多传感器反应器测试：N 个模拟器（pty） -> N 个 ForceSensor 共用一个 SerialReactor -> 各自的样本环形缓冲区 -> 本线程取出
+// 用法：SerialReactorTest [key=value]...
+//   sensors=8 rate=5000 seconds=5 interval=1000 ring=65536 drainms=5
+// 检查：加入传感器前后进程线程数不变（每个传感器只占用描述符）；各传感器按 Counter 序号统计丢包，
+// 未发生 pty 溢出和环形缓冲区丢弃时若仍有丢包则返回 1。
+
+static int threadCount()
+{
+    return QDir(QStringLiteral("/proc/self/task")).entryList(QDir::Dirs | QDir::NoDotAndDotDot).size();
+}
+
+struct Device {
+    std::unique_ptr<ForceSensorSimulator> sim;
+    std::unique_ptr<ForceSampleRing> ring;
+    std::unique_ptr<ForceSensor> sensor;
+    quint64 received = 0;
+    quint64 nextSeq = 0;    // 通道 1 期望的下一个序号
+    quint64 missing = 0;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QHash<QString, double> options {
+        { QStringLiteral("sensors"), 8 }, { QStringLiteral("rate"), 5000 }, { QStringLiteral("seconds"), 5 },
+        { QStringLiteral("interval"), 1000 }, { QStringLiteral("ring"), 1 << 16 }, { QStringLiteral("drainms"), 5 }
+    };
+    if (!parseTestOptions(app.arguments(), options)) {
+        return 2;
+    }
+    const int sensors = static_cast<int>(options.value(QStringLiteral("sensors")));
+    const int rate = static_cast<int>(options.value(QStringLiteral("rate")));
+    const int seconds = static_cast<int>(options.value(QStringLiteral("seconds")));
+    const int drainMs = static_cast<int>(options.value(QStringLiteral("drainms")));
+
+    SerialReactor reactor;
+    if (!reactor.start()) {
+        return 1;
+    }
+
+    std::vector<Device> devices(static_cast<size_t>(sensors));
+    for (Device &d : devices) {
+        d.sim.reset(new ForceSensorSimulator);
+        if (!d.sim->setRateHz(rate)) {
+            return 2;
+        }
+        d.sim->setWaveform(1, ForceSensorSimulator::Waveform::Counter, 0.0, 0.0, 0);
+        d.sim->setWaveform(2, ForceSensorSimulator::Waveform::Counter, 0.0, 0.0, 0);
+        d.sim->setWriteIntervalUs(static_cast<int>(options.value(QStringLiteral("interval"))));
+        if (!d.sim->open()) {
+            return 1;
+        }
+    }
+
+    // 传感器全部加入同一个反应器，不创建任何线程
+    const int threadsBefore = threadCount();
+    for (Device &d : devices) {
+        d.ring.reset(new ForceSampleRing(static_cast<std::size_t>(options.value(QStringLiteral("ring"))),
+                                         TCM::RingOverflowPolicy::DropOldest));
+        d.sensor.reset(new ForceSensor(d.sim->portName(), 1.0, 1.0));
+        d.sensor->setSampleRing(d.ring.get());
+        if (!d.sensor->setReactor(&reactor)
+            || !d.sensor->connect(d.sim->portName(), 921600, QSerialPort::Data8, QSerialPort::NoParity, QSerialPort::OneStop)) {
+            return 1;
+        }
+    }
+    const int threadsAfter = threadCount();
+    for (Device &d : devices) {
+        d.sim->start();
+    }
+
+    std::unique_ptr<ForceSample[]> buffer(new ForceSample[4096]);
+    auto drain = [&]() {
+        for (Device &d : devices) {
+            for (;;) {
+                const std::size_t n = d.ring->popBatch(buffer.get(), 4096);
+                for (std::size_t i = 0; i < n; ++i) {
+                    const ForceSample &s = buffer[i];
+                    if (s.channel != 1) {
+                        continue;
+                    }
+                    ++d.received;
+                    // 24 位序号相对上一个序号展开
+                    const int raw = static_cast<int>(s.absoluteForce);
+                    const int delta = (raw - static_cast<int>(d.nextSeq & 0xFFFFFF)) & 0xFFFFFF;
+                    d.missing += static_cast<quint64>(delta);
+                    d.nextSeq += static_cast<quint64>(delta) + 1;
+                }
+                if (n < 4096) {
+                    break;
+                }
+            }
+        }
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < seconds * 1000LL) {
+        drain();
+        QThread::msleep(static_cast<unsigned long>(drainMs));
+    }
+    for (Device &d : devices) {
+        d.sim->stopAndWait();
+    }
+    QThread::msleep(100); // 等待在途数据被解析
+    for (Device &d : devices) {
+        d.sensor->disConnect();
+    }
+    drain();
+    const double elapsedS = timer.nsecsElapsed() / 1e9;
+    const int portsLeft = reactor.portCount();
+    reactor.stop();
+
+    bool lost = false;
+    quint64 total = 0;
+    for (int i = 0; i < sensors; ++i) {
+        Device &d = devices[static_cast<size_t>(i)];
+        const ForceSensorSimulator::Stats st = d.sim->stats();
+        const quint64 dropped = d.ring->droppedCount();
+        total += d.received;
+        qInfo().noquote() << "sensor" << i << "sent:" << st.sent << "received:" << d.received
+                          << "missing:" << d.missing << "overrun:" << st.overrun << "ring dropped:" << dropped;
+        if (st.overrun == 0 && dropped == 0 && (d.missing != 0 || d.received != st.sent)) {
+            lost = true;
+        }
+    }
+    qInfo().noquote() << "sensors:" << sensors << "rate:" << rate << "Hz threads before/after connect:"
+                      << threadsBefore << "/" << threadsAfter << "samples/s (ch1):" << total / elapsedS;
+
+    if (threadsAfter != threadsBefore || portsLeft != 0) {
+        qWarning() << "reactor created threads or leaked ports";
+        return 1;
+    }
+    if (lost) {
+        qWarning() << "unexpected loss without injected faults";
+        return 1;
+    }
+    qInfo() << "SerialReactorTest OK";
+    return 0;
+}
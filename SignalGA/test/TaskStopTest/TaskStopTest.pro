@@ -0,0 +1,53 @@
+QT += core serialport
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp \
+    ../../Data/AcquisitionTask/TaskThreadManager.cpp \
+    ../../Data/DataSaver/DataSaver.cpp \
+    ../../Data/DataSaver/AsyncFileWriter.cpp \
+    ../../Data/DataSaver/BinaryFormat.cpp \
+    ../../Data/DataSaver/BlockCompression.cpp \
+    ../../Data/DataSaver/IntegerCodec.cpp \
+    ../../Data/DataSaver/Decimation.cpp \
+    ../../Data/DataSaver/Durability.cpp \
+    ../../Data/DataSaver/RecordReader.cpp \
+    ../../Data/DataSaver/ShardedDataSaver.cpp \
+    ../../Data/DataSaver/WriteBatch.cpp \
+    ../../Drivers/SerialPort/SerialCommon.cpp \
+    ../../Drivers/SerialPort/RawCapture.cpp \
+    ../../Drivers/SerialPort/SerialChunkPool.cpp \
+    ../../Drivers/SerialPort/SerialReactor.cpp \
+    ../../Drivers/ForceSensor/ForceSensor.cpp \
+    ../../Drivers/ForceSensor/ForceFrameDecoder.cpp \
+    ../../Drivers/ForceSensor/ForceSensorSimulator.cpp
+
+HEADERS += \
+    ../../Data/AcquisitionTask/TaskThreadManager.h \
+    ../../Data/DataSaver/DataSaver.h \
+    ../../Data/DataSaver/AsyncFileWriter.h \
+    ../../Data/DataSaver/BinaryFormat.h \
+    ../../Data/DataSaver/BlockCompression.h \
+    ../../Data/DataSaver/IntegerCodec.h \
+    ../../Data/DataSaver/Decimation.h \
+    ../../Data/DataSaver/Durability.h \
+    ../../Data/DataSaver/RecordReader.h \
+    ../../Data/DataSaver/ShardedDataSaver.h \
+    ../../Data/DataSaver/WriteBatch.h \
+    ../../Data/DataSaver/CsvFormat.h \
+    ../../Drivers/SerialPort/SerialCommon.h \
+    ../../Drivers/SerialPort/RawCapture.h \
+    ../../Drivers/SerialPort/SerialChunkPool.h \
+    ../../Drivers/SerialPort/SerialReactor.h \
+    ../../Drivers/ForceSensor/ForceSensor.h \
+    ../../Drivers/ForceSensor/ForceFrameDecoder.h \
+    ../../Drivers/ForceSensor/ForceSensorSimulator.h \
+    ../../Global/SpscRing.h \
+    ../TestOptions.h
+
+INCLUDEPATH += ../../Data/AcquisitionTask ../../Data/DataSaver ../../Drivers/SerialPort ../../Drivers/ForceSensor ../../Global
+
+# 输出目录
+DESTDIR = ./build
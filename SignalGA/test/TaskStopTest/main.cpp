@@ -0,0 +1,92 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QThread>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+
+#include "TaskThreadManager.h"
+#include "ForceSensorSimulator.h"
+#include "SerialReactor.h"
+#include "../TestOptions.h"
+
+// 停止流程测试：Block 策略 + 很小的样本环形缓冲区，本线程不处理事件（取出定时器不运行），
+// 缓冲区很快被写满、生产者在 push 中等待；随后调用 stop()，必须在限定时间内返回。
+// 用法：TaskStopTest [key=value]...
+//   mode=0 rate=20000 ring=256 fillms=300 timeoutms=3000
+//   mode：0 = 传感器线程（事件循环读取），1 = 传感器线程 + 低延迟读取，2 = 共用 SerialReactor
+// stop() 超时（死锁）时直接以 1 退出。
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QHash<QString, double> options {
+        { QStringLiteral("mode"), 0 }, { QStringLiteral("rate"), 20000 }, { QStringLiteral("ring"), 256 },
+        { QStringLiteral("fillms"), 300 }, { QStringLiteral("timeoutms"), 3000 }
+    };
+    if (!parseTestOptions(app.arguments(), options)) {
+        return 2;
+    }
+    const int mode = static_cast<int>(options.value(QStringLiteral("mode")));
+    const int timeoutMs = static_cast<int>(options.value(QStringLiteral("timeoutms")));
+
+    ForceSensorSimulator sim;
+    if (!sim.setRateHz(static_cast<int>(options.value(QStringLiteral("rate")))) || !sim.open()) {
+        return 1;
+    }
+
+    SerialReactor reactor;
+    TaskThreadManager manager;
+    manager.setDataSaveEnabled(false);
+    manager.setForceSensorPort(sim.portName());
+    manager.setSampleRingCapacity(static_cast<int>(options.value(QStringLiteral("ring"))));
+    manager.setSampleOverflowPolicy(TCM::RingOverflowPolicy::Block);
+    if (mode == 1) {
+        manager.setLowLatencyReadEnabled(true);
+    } else if (mode == 2) {
+        if (!reactor.start()) {
+            return 1;
+        }
+        manager.setSerialReactor(&reactor);
+    }
+
+    manager.start();
+    sim.start();
+    // 不处理事件：存储侧定时器不会取出样本，缓冲区写满后生产者一直等待
+    QThread::msleep(static_cast<unsigned long>(options.value(QStringLiteral("fillms"))));
+    const quint64 droppedBeforeStop = manager.droppedSampleCount();
+
+    // 看门狗：stop() 死锁时结束进程
+    std::atomic<bool> stopped { false };
+    std::thread watchdog([&stopped, timeoutMs]() {
+        QElapsedTimer timer;
+        timer.start();
+        while (!stopped.load() && timer.elapsed() < timeoutMs) {
+            QThread::msleep(10);
+        }
+        if (!stopped.load()) {
+            qWarning() << "stop() did not return within" << timeoutMs << "ms (deadlock)";
+            std::_Exit(1);
+        }
+    });
+    QElapsedTimer timer;
+    timer.start();
+    manager.stop();
+    const qint64 stopMs = timer.elapsed();
+    stopped.store(true);
+    watchdog.join();
+    sim.stopAndWait();
+    reactor.stop();
+
+    qInfo().noquote() << "mode:" << mode << "stop ms:" << stopMs << "sent:" << sim.stats().sent
+                      << "dropped before stop:" << droppedBeforeStop << "after:" << manager.droppedSampleCount();
+    if (droppedBeforeStop != 0) {
+        qWarning() << "Block policy dropped samples before stop";
+        return 1;
+    }
+    qInfo() << "TaskStopTest OK";
+    return 0;
+}
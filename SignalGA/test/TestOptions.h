@@ -0,0 +1,24 @@
+#ifndef TEST_TESTOPTIONS_H
+#define TEST_TESTOPTIONS_H
+
+#include <QDebug>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+// 测试程序的 key=value 命令行参数：options 预先给出全部参数名及默认值，args 中的参数按名覆盖（args[0] 为程序名）。
+// 参数名未知或缺少 '=' 时打印该参数并返回 false
+inline bool parseTestOptions(const QStringList &args, QHash<QString, double> &options)
+{
+    for (int i = 1; i < args.size(); ++i) {
+        const int eq = args.at(i).indexOf('=');
+        if (eq <= 0 || !options.contains(args.at(i).left(eq))) {
+            qWarning() << "未知参数:" << args.at(i);
+            return false;
+        }
+        options[args.at(i).left(eq)] = args.at(i).mid(eq + 1).toDouble();
+    }
+    return true;
+}
+
+#endif // TEST_TESTOPTIONS_H
@@ -0,0 +1,23 @@
+QT += core
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp \
+    ../../Data/DataSaver/BinaryFormat.cpp \
+    ../../Data/DataSaver/BlockCompression.cpp \
+    ../../Data/DataSaver/IntegerCodec.cpp \
+    ../../Data/DataSaver/Durability.cpp
+
+HEADERS += \
+    ../../Data/DataSaver/BinaryFormat.h \
+    ../../Data/DataSaver/BlockCompression.h \
+    ../../Data/DataSaver/IntegerCodec.h \
+    ../../Data/DataSaver/Durability.h \
+    ../../Data/DataSaver/CsvFormat.h
+
+INCLUDEPATH += ../../Data/DataSaver
+
+# 输出目录
+DESTDIR = ./build
@@ -0,0 +1,76 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+
+#include "../../Data/DataSaver/BinaryFormat.h"
+#include "../../Data/DataSaver/BlockCompression.h"
+#include "../../Data/DataSaver/Durability.h"
+
+// 将 DataSaver 二进制记录文件转换为 CSV
+// 用法：BinToCsv <input.bin|input.bin.sgz|input.csv.sgz> [output.csv] [precision]
+// 未指定输出路径时与输入同名，扩展名改为 .csv；压缩文件（.sgz）先解压
+// BinToCsv --recover <file>...：异常断电后截掉各文件末尾不完整的行/记录/块（只检查最后一个检查点之后的数据）
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const QStringList args = app.arguments();
+    if (args.size() > 1 && args.at(1) == QStringLiteral("--recover")) {
+        int failed = 0;
+        for (int i = 2; i < args.size(); ++i) {
+            qint64 removed = 0;
+            QString error;
+            if (!Durability::recoverFile(args.at(i), &removed, &error)) {
+                qWarning() << "恢复失败:" << error;
+                ++failed;
+            } else {
+                qInfo() << "已检查:" << args.at(i) << "截掉" << removed << "字节";
+            }
+        }
+        return failed ? 1 : 0;
+    }
+    if (args.size() < 2) {
+        qWarning() << "用法: BinToCsv <input.bin> [output.csv] [precision] | BinToCsv --recover <file>...";
+        return 2;
+    }
+
+    const QString input = args.at(1);
+    const QString compressedSuffix = QStringLiteral(".") + QString::fromLatin1(BlockCompression::FILE_SUFFIX);
+    const bool compressed = input.endsWith(compressedSuffix);
+    // 去掉 .sgz 后的文件名决定内容是 CSV 还是二进制记录
+    const QString inner = compressed ? input.left(input.size() - compressedSuffix.size()) : input;
+    QString output = args.size() > 2 ? args.at(2) : QString();
+    if (output.isEmpty()) {
+        const QFileInfo info(inner);
+        output = info.path() + "/" + info.completeBaseName() + ".csv";
+    }
+    const int precision = args.size() > 3 ? args.at(3).toInt() : 6;
+
+    QString error;
+    if (compressed && inner.endsWith(QStringLiteral(".csv"))) {
+        if (!BlockCompression::decompressFile(input, output, &error)) {
+            qWarning() << "解压失败:" << error;
+            return 1;
+        }
+    } else {
+        QString binary = input;
+        if (compressed) {
+            binary = output + QStringLiteral(".bin.tmp");
+            if (!BlockCompression::decompressFile(input, binary, &error)) {
+                qWarning() << "解压失败:" << error;
+                QFile::remove(binary);
+                return 1;
+            }
+        }
+        const bool ok = BinaryFormat::convertToCsv(binary, output, precision, &error);
+        if (compressed) QFile::remove(binary);
+        if (!ok) {
+            qWarning() << "转换失败:" << error;
+            return 1;
+        }
+    }
+    qInfo() << "已转换:" << input << "->" << output;
+    return 0;
+}
@@ -0,0 +1,17 @@
+QT += core
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TEMPLATE = app
+
+SOURCES += \
+    main.cpp \
+    ../../Drivers/ForceSensor/ForceSensorSimulator.cpp
+
+HEADERS += \
+    ../../Drivers/ForceSensor/ForceSensorSimulator.h \
+    ../../Drivers/ForceSensor/ForceFrameDecoder.h
+
+INCLUDEPATH += ../../Drivers/ForceSensor
+
+# 输出目录
+DESTDIR = ./build
@@ -0,0 +1,97 @@
+#include <QCoreApplication>
+#include <QDebug>
+#include <QHash>
+#include <QStringList>
+#include <QTimer>
+
+#include "../../Drivers/ForceSensor/ForceSensorSimulator.h"
+
+// 力传感器模拟器：创建伪终端并持续发送协议数据，程序或 TaskThreadManager 把串口名设为输出的 pty 路径即可连接
+// 用法：ForceSensorSim [key=value]...
+//   rate=5000       数据包速率（Hz，1 ~ 50000）
+//   ids=bd          通道标识，每个字符一个通道（例如 8 通道放大器 ids=abcdefgh）
+//   channels=N      只发送前 N 个通道（默认为标识个数）
+//   wave=sine       波形：constant | sine | square | triangle | counter（各通道相同）
+//   amplitude=200000 frequency=1 offset=4194304    波形参数（原始值单位 / Hz）
+//   noise=0         高斯噪声标准差
+//   corrupt=0       每包损坏概率（0 ~ 1）
+//   gaps=0 gapms=50 平均每秒断流次数与每次时长
+//   interval=1000   合并写入间隔（微秒）
+//   block=0         1 = pty 缓冲区满时等待，0 = 像实物一样丢弃
+//   seconds=0       运行时长，0 为一直运行
+//   seed=1          随机数种子
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QHash<QString, QString> options;
+    const QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        const int eq = args.at(i).indexOf('=');
+        if (eq <= 0) {
+            qWarning() << "参数格式应为 key=value:" << args.at(i);
+            return 2;
+        }
+        options.insert(args.at(i).left(eq), args.at(i).mid(eq + 1));
+    }
+    auto number = [&options](const char *key, double fallback) {
+        const QString value = options.value(QString::fromLatin1(key));
+        return value.isEmpty() ? fallback : value.toDouble();
+    };
+
+    const QHash<QString, ForceSensorSimulator::Waveform> waveforms {
+        { QStringLiteral("constant"), ForceSensorSimulator::Waveform::Constant },
+        { QStringLiteral("sine"), ForceSensorSimulator::Waveform::Sine },
+        { QStringLiteral("square"), ForceSensorSimulator::Waveform::Square },
+        { QStringLiteral("triangle"), ForceSensorSimulator::Waveform::Triangle },
+        { QStringLiteral("counter"), ForceSensorSimulator::Waveform::Counter }
+    };
+    const QString wave = options.value(QStringLiteral("wave"), QStringLiteral("sine"));
+    if (!waveforms.contains(wave)) {
+        qWarning() << "未知波形:" << wave;
+        return 2;
+    }
+
+    ForceSensorSimulator sim;
+    const QByteArray ids = options.value(QStringLiteral("ids"), QStringLiteral("bd")).toLatin1();
+    if (!sim.setRateHz(static_cast<int>(number("rate", 5000)))
+        || !sim.setChannelIds(ids)
+        || !sim.setChannels(static_cast<int>(number("channels", ids.size())))) {
+        return 2;
+    }
+    const double amplitude = number("amplitude", 200000);
+    const double frequency = number("frequency", 1.0);
+    const int offset = static_cast<int>(number("offset", 0x400000));
+    // 第 n 个通道的频率为 frequency / n，便于区分
+    for (int c = 1; c <= ids.size(); ++c) {
+        sim.setWaveform(c, waveforms.value(wave), amplitude, frequency / c, offset);
+    }
+    sim.setNoise(number("noise", 0.0));
+    sim.setCorruptionRate(number("corrupt", 0.0));
+    sim.setGaps(number("gaps", 0.0), static_cast<int>(number("gapms", 50)));
+    sim.setWriteIntervalUs(static_cast<int>(number("interval", 1000)));
+    sim.setBlockOnFull(number("block", 0) != 0);
+    sim.setSeed(static_cast<quint32>(number("seed", 1)));
+    if (!sim.open()) {
+        return 1;
+    }
+    qInfo().noquote() << "PTY:" << sim.portName();
+    sim.start();
+
+    // 每秒输出一次统计
+    QTimer report;
+    QObject::connect(&report, &QTimer::timeout, [&sim]() {
+        const ForceSensorSimulator::Stats s = sim.stats();
+        qInfo().noquote() << "packets:" << s.packets << "sent:" << s.sent << "corrupted:" << s.corrupted
+                          << "skipped:" << s.skipped << "overrun:" << s.overrun
+                          << "max lag ms:" << s.maxLagNs / 1e6;
+    });
+    report.start(1000);
+    const int seconds = static_cast<int>(number("seconds", 0));
+    if (seconds > 0) {
+        QTimer::singleShot(seconds * 1000, &app, &QCoreApplication::quit);
+    }
+    const int rc = app.exec();
+    sim.close();
+    return rc;
+}